@@ -8,32 +8,76 @@ macro( KDSOAP_GENERATE_WSDL _sources )
     set(KDWSDL2CPP KDSoap::kdwsdl2cpp)
   endif()
   set(_KSWSDL2CPP_OPTION)
+  # Set KSWSDL2CPP_INCREMENTAL to skip kdwsdl2cpp when its inputs didn't change, and to keep
+  # the generated files whose content is the same, so that they don't get recompiled.
+  # The rules then produce the <file>.stamp files, which are updated on every run, and
+  # the generated files are byproducts: this needs CMake 3.2.
+  set(_KSWSDL2CPP_INCREMENTAL FALSE)
+  if(KSWSDL2CPP_INCREMENTAL)
+     if(CMAKE_VERSION VERSION_LESS 3.2)
+        message(WARNING "KSWSDL2CPP_INCREMENTAL needs CMake 3.2, ignoring it")
+     else()
+        set(_KSWSDL2CPP_INCREMENTAL TRUE)
+        list(APPEND _KSWSDL2CPP_OPTION -incremental)
+     endif()
+  endif()
   if(KSWSDL2CPP_OPTION)
-     set(_KSWSDL2CPP_OPTION ${KSWSDL2CPP_OPTION})
+     list(APPEND _KSWSDL2CPP_OPTION ${KSWSDL2CPP_OPTION})
+  endif()
+  # Set KSWSDL2CPP_SPLIT to the number of .cpp files to generate per WSDL file,
+  # so that big services can be compiled in parallel.
+  set(_KSWSDL2CPP_SPLIT 1)
+  if(KSWSDL2CPP_SPLIT)
+     set(_KSWSDL2CPP_SPLIT ${KSWSDL2CPP_SPLIT})
   endif()
   foreach (_source_FILE ${ARGN})
     get_filename_component(_tmp_FILE ${_source_FILE} ABSOLUTE)
     get_filename_component(_basename ${_tmp_FILE} NAME_WE)
     set(_header_wsdl_FILE ${CMAKE_CURRENT_BINARY_DIR}/wsdl_${_basename}.h)
     set(_source_wsdl_FILE ${CMAKE_CURRENT_BINARY_DIR}/wsdl_${_basename}.cpp)
-    add_custom_command(OUTPUT ${_header_wsdl_FILE}
-       COMMAND ${KDWSDL2CPP}
-       ARGS ${_KSWSDL2CPP_OPTION} ${_tmp_FILE} -o ${_header_wsdl_FILE}
-       MAIN_DEPENDENCY ${_tmp_FILE}
-       DEPENDS ${_tmp_FILE} ${KDWSDL2CPP} )
+    set(_source_wsdl_FILES ${_source_wsdl_FILE})
+    set(_split_OPTION)
+    if(_KSWSDL2CPP_SPLIT GREATER 1)
+       set(_split_OPTION -split ${_KSWSDL2CPP_SPLIT})
+       foreach(_index RANGE 2 ${_KSWSDL2CPP_SPLIT})
+          list(APPEND _source_wsdl_FILES ${CMAKE_CURRENT_BINARY_DIR}/wsdl_${_basename}_${_index}.cpp)
+       endforeach()
+    endif()
+    if(_KSWSDL2CPP_INCREMENTAL)
+      add_custom_command(OUTPUT ${_header_wsdl_FILE}.stamp
+         BYPRODUCTS ${_header_wsdl_FILE}
+         COMMAND ${KDWSDL2CPP}
+         ARGS ${_KSWSDL2CPP_OPTION} ${_tmp_FILE} -o ${_header_wsdl_FILE}
+         MAIN_DEPENDENCY ${_tmp_FILE}
+         DEPENDS ${_tmp_FILE} ${KDWSDL2CPP} )
 
-    add_custom_command(OUTPUT ${_source_wsdl_FILE}
-       COMMAND ${KDWSDL2CPP}
-       ARGS ${_KSWSDL2CPP_OPTION} -impl ${_header_wsdl_FILE} ${_tmp_FILE} -o ${_source_wsdl_FILE}
-       MAIN_DEPENDENCY ${_tmp_FILE} ${_header_wsdl_FILE}
-       DEPENDS ${_tmp_FILE} ${KDWSDL2CPP} )
+      add_custom_command(OUTPUT ${_source_wsdl_FILE}.stamp
+         BYPRODUCTS ${_source_wsdl_FILES}
+         COMMAND ${KDWSDL2CPP}
+         ARGS ${_KSWSDL2CPP_OPTION} ${_split_OPTION} -impl ${_header_wsdl_FILE} ${_tmp_FILE} -o ${_source_wsdl_FILE}
+         MAIN_DEPENDENCY ${_tmp_FILE}
+         DEPENDS ${_tmp_FILE} ${_header_wsdl_FILE}.stamp ${KDWSDL2CPP} )
+      list(APPEND ${_sources} ${_header_wsdl_FILE}.stamp ${_source_wsdl_FILE}.stamp)
+    else()
+      add_custom_command(OUTPUT ${_header_wsdl_FILE}
+         COMMAND ${KDWSDL2CPP}
+         ARGS ${_KSWSDL2CPP_OPTION} ${_tmp_FILE} -o ${_header_wsdl_FILE}
+         MAIN_DEPENDENCY ${_tmp_FILE}
+         DEPENDS ${_tmp_FILE} ${KDWSDL2CPP} )
+
+      add_custom_command(OUTPUT ${_source_wsdl_FILES}
+         COMMAND ${KDWSDL2CPP}
+         ARGS ${_KSWSDL2CPP_OPTION} ${_split_OPTION} -impl ${_header_wsdl_FILE} ${_tmp_FILE} -o ${_source_wsdl_FILE}
+         MAIN_DEPENDENCY ${_tmp_FILE} ${_header_wsdl_FILE}
+         DEPENDS ${_tmp_FILE} ${KDWSDL2CPP} )
+    endif()
 
     if (Qt5Core_FOUND)
        qt5_wrap_cpp(_sources_MOCS ${_header_wsdl_FILE})
     else()
        qt4_wrap_cpp(_sources_MOCS ${_header_wsdl_FILE})
     endif()
-    list(APPEND ${_sources} ${_header_wsdl_FILE} ${_source_wsdl_FILE} ${_sources_MOCS})
+    list(APPEND ${_sources} ${_header_wsdl_FILE} ${_source_wsdl_FILES} ${_sources_MOCS})
   endforeach ()
 endmacro()
 
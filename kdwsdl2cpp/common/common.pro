@@ -6,7 +6,8 @@ SOURCES = \
    messagehandler.cpp \
    nsmanager.cpp \
    parsercontext.cpp \
-   qname.cpp
+   qname.cpp \
+   xmlelementreader.cpp
 
 HEADERS = fileprovider.h
 
@@ -22,9 +22,17 @@
 #include "fileprovider.h"
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QEventLoop>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPair>
 #include <QUrl>
+#include <QXmlStreamReader>
 #include <QDebug>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -35,6 +43,128 @@
 #include <unistd.h>
 #endif
 
+typedef QList<QUrl> UrlList;
+Q_GLOBAL_STATIC(UrlList, s_providedUrls)
+
+static void addProvidedUrl( const QUrl &url )
+{
+  if ( !s_providedUrls()->contains( url ) )
+    s_providedUrls()->append( url );
+}
+
+struct FileProviderConfig
+{
+  FileProviderConfig() : offline( false ) {}
+
+  QString cacheDirectory;
+  bool offline;
+  QMap<QString, QUrl> catalogEntries;
+  QList<QPair<QString, QString> > catalogRewrites;
+  // Cached files whose content was already checked, by URL: each one is only hashed once per run
+  QHash<QString, QString> verifiedFiles;
+};
+Q_GLOBAL_STATIC(FileProviderConfig, s_config)
+
+static QByteArray sha1( const QByteArray &data )
+{
+  return QCryptographicHash::hash( data, QCryptographicHash::Sha1 ).toHex();
+}
+
+// Applies the catalog to url: an exact entry wins, then the longest rewrite prefix
+static QUrl catalogUrl( const QUrl &url )
+{
+  const FileProviderConfig *config = s_config();
+  const QString urlString = url.toString();
+  const QMap<QString, QUrl>::const_iterator it = config->catalogEntries.constFind( urlString );
+  if ( it != config->catalogEntries.constEnd() )
+    return it.value();
+
+  int bestLength = 0;
+  QString rewritten;
+  for ( int i = 0; i < config->catalogRewrites.count(); ++i ) {
+    const QPair<QString, QString> &rewrite = config->catalogRewrites.at( i );
+    if ( rewrite.first.length() > bestLength && urlString.startsWith( rewrite.first ) ) {
+      bestLength = rewrite.first.length();
+      rewritten = rewrite.second + urlString.mid( bestLength );
+    }
+  }
+  return bestLength ? QUrl( rewritten ) : url;
+}
+
+static QString cacheIndexFile( const QUrl &url )
+{
+  return s_config()->cacheDirectory + QLatin1String( "/urls/" ) + QString::fromLatin1( sha1( url.toEncoded() ) );
+}
+
+static QString cacheDataFile( const QByteArray &contentHash )
+{
+  return s_config()->cacheDirectory + QLatin1String( "/data/" ) + QString::fromLatin1( contentHash );
+}
+
+static QString cachedFile( const QUrl &url )
+{
+  FileProviderConfig *config = s_config();
+  if ( config->cacheDirectory.isEmpty() )
+    return QString();
+
+  const QString urlString = url.toString();
+  const QHash<QString, QString>::const_iterator it = config->verifiedFiles.constFind( urlString );
+  if ( it != config->verifiedFiles.constEnd() )
+    return it.value();
+
+  QFile index( cacheIndexFile( url ) );
+  if ( !index.open( QIODevice::ReadOnly ) )
+    return QString();
+  const QByteArray contentHash = index.readAll().trimmed();
+
+  // Don't trust a truncated or modified copy, download the file again instead
+  const QString fileName = cacheDataFile( contentHash );
+  QFile data( fileName );
+  if ( contentHash.isEmpty() || !data.open( QIODevice::ReadOnly ) || sha1( data.readAll() ) != contentHash )
+    return QString();
+  config->verifiedFiles.insert( urlString, fileName );
+  return fileName;
+}
+
+// Writes through a temporary file, so that a concurrent kdwsdl2cpp never sees a partial file
+static bool writeFileAtomically( const QString &fileName, const QByteArray &data )
+{
+  QTemporaryFile tmpFile( fileName + QLatin1String( ".XXXXXX" ) );
+  if ( !tmpFile.open() || tmpFile.write( data ) != data.size() )
+    return false;
+  tmpFile.close();
+  QFile::remove( fileName );
+  if ( !QFile::rename( tmpFile.fileName(), fileName ) )
+    return false;
+  tmpFile.setAutoRemove( false );
+  return true;
+}
+
+static void storeInCache( const QUrl &url, const QByteArray &data )
+{
+  const QString cacheDirectory = s_config()->cacheDirectory;
+  if ( cacheDirectory.isEmpty() )
+    return;
+
+  QDir dir;
+  if ( !dir.mkpath( cacheDirectory + QLatin1String( "/data" ) ) || !dir.mkpath( cacheDirectory + QLatin1String( "/urls" ) ) ) {
+    qWarning( "Unable to create the cache directory '%s'", qPrintable( cacheDirectory ) );
+    return;
+  }
+
+  const QByteArray contentHash = sha1( data );
+  const QString dataFile = cacheDataFile( contentHash );
+  const bool existed = QFile::exists( dataFile );
+  if ( ( !existed && !writeFileAtomically( dataFile, data ) ) ||
+       !writeFileAtomically( cacheIndexFile( url ), contentHash ) ) {
+    qWarning( "Unable to store '%s' in the cache directory '%s'", url.toEncoded().constData(), qPrintable( cacheDirectory ) );
+    return;
+  }
+  // A copy which was already there gets checked by cachedFile(), like any other
+  if ( !existed )
+    s_config()->verifiedFiles.insert( url.toString(), dataFile );
+}
+
 FileProvider::FileProvider()
   : QObject( 0 )
 {
@@ -48,19 +178,23 @@ void FileProvider::cleanUp()
   }
 }
 
-bool FileProvider::get( const QUrl &url, QString &target )
+bool FileProvider::get( const QUrl &requestedUrl, QString &target )
 {
   if ( !mFileName.isEmpty() ) {
     cleanUp();
   }
 
-  if (url.scheme() == QLatin1String("file")) {
-      target = url.toLocalFile();
+  const QString fileName = localFile( requestedUrl );
+  if ( !fileName.isEmpty() ) {
+      target = fileName;
+      addProvidedUrl( requestedUrl );
       return true;
   }
-  if (url.scheme() == QLatin1String("qrc")) {
-      target = QLatin1String(":") + url.path();
-      return true;
+
+  const QUrl url = catalogUrl( requestedUrl );
+  if ( s_config()->offline ) {
+      qWarning("Not downloading '%s' in offline mode: it is neither in the catalog nor in the cache", url.toEncoded().constData());
+      return false;
   }
 
   if ( target.isEmpty() ) {
@@ -98,7 +232,76 @@ bool FileProvider::get( const QUrl &url, QString &target )
   file.write( data );
   file.close();
 
+  storeInCache( url, data );
+  addProvidedUrl( requestedUrl );
+  return true;
+}
+
+QList<QUrl> FileProvider::providedUrls()
+{
+  return *s_providedUrls();
+}
+
+void FileProvider::setCacheDirectory( const QString &directory )
+{
+  s_config()->cacheDirectory = directory.isEmpty() ? QString() : QDir( directory ).absolutePath();
+  s_config()->verifiedFiles.clear();
+}
+
+void FileProvider::setOfflineMode( bool offline )
+{
+  s_config()->offline = offline;
+}
+
+bool FileProvider::loadCatalog( const QString &fileName )
+{
+  QFile file( fileName );
+  if ( !file.open( QIODevice::ReadOnly ) ) {
+    qWarning( "Unable to open the catalog '%s'", qPrintable( fileName ) );
+    return false;
+  }
+
+  // Relative locations are relative to the catalog
+  const QUrl baseUrl = QUrl::fromLocalFile( QFileInfo( fileName ).absoluteFilePath() );
+  FileProviderConfig *config = s_config();
+
+  QXmlStreamReader reader( &file );
+  while ( !reader.atEnd() ) {
+    if ( reader.readNext() != QXmlStreamReader::StartElement )
+      continue;
+
+    const QXmlStreamAttributes attributes = reader.attributes();
+    const QStringRef name = reader.name();
+    if ( name == QLatin1String( "uri" ) ) {
+      config->catalogEntries.insert( attributes.value( QLatin1String( "name" ) ).toString(),
+                                     baseUrl.resolved( QUrl( attributes.value( QLatin1String( "uri" ) ).toString() ) ) );
+    } else if ( name == QLatin1String( "system" ) ) {
+      config->catalogEntries.insert( attributes.value( QLatin1String( "systemId" ) ).toString(),
+                                     baseUrl.resolved( QUrl( attributes.value( QLatin1String( "uri" ) ).toString() ) ) );
+    } else if ( name == QLatin1String( "rewriteURI" ) || name == QLatin1String( "rewriteSystem" ) ) {
+      const QString startString = attributes.value( name == QLatin1String( "rewriteURI" ) ? QLatin1String( "uriStartString" )
+                                                                                           : QLatin1String( "systemIdStartString" ) ).toString();
+      const QUrl prefix = baseUrl.resolved( QUrl( attributes.value( QLatin1String( "rewritePrefix" ) ).toString() ) );
+      config->catalogRewrites.append( qMakePair( startString, prefix.toString() ) );
+    }
+  }
+
+  if ( reader.hasError() ) {
+    qWarning( "Error parsing the catalog '%s' at line %d: %s", qPrintable( fileName ),
+              int( reader.lineNumber() ), qPrintable( reader.errorString() ) );
+    return false;
+  }
   return true;
 }
 
+QString FileProvider::localFile( const QUrl &requestedUrl )
+{
+  const QUrl url = catalogUrl( requestedUrl );
+  if ( url.scheme() == QLatin1String( "file" ) )
+    return url.toLocalFile();
+  if ( url.scheme() == QLatin1String( "qrc" ) )
+    return QLatin1String( ":" ) + url.path();
+  return cachedFile( url );
+}
+
 #include "moc_fileprovider.cpp"
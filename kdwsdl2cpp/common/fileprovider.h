@@ -22,6 +22,7 @@
 #ifndef FILEPROVIDER_H
 #define FILEPROVIDER_H
 
+#include <QList>
 #include <QObject>
 
 #include <kode_export.h>
@@ -40,6 +41,41 @@ class KXMLCOMMON_EXPORT FileProvider : QObject
     bool get( const QUrl &url, QString &target );
     void cleanUp();
 
+    /**
+      Returns the URLs of all the files provided by get() so far,
+      in the order in which they were first requested.
+     */
+    static QList<QUrl> providedUrls();
+
+    /**
+      Sets the directory where downloaded files are cached. The cache is
+      content-addressed: <dir>/data/<sha1 of the content> holds the files,
+      <dir>/urls/<sha1 of the url> the hash of the content downloaded from a URL.
+      A cached copy is checked against its hash the first time it is used, then trusted.
+      An empty directory (the default) disables the cache.
+     */
+    static void setCacheDirectory( const QString &directory );
+
+    /**
+      In offline mode, get() fails for the URLs which are neither local files,
+      nor mapped to one by the catalog, nor in the cache, instead of downloading them.
+     */
+    static void setOfflineMode( bool offline );
+
+    /**
+      Loads an OASIS XML catalog, whose uri, system, rewriteURI and rewriteSystem
+      entries map URLs to other (usually local) locations.
+      Returns false if the file can't be read or parsed.
+     */
+    static bool loadCatalog( const QString &fileName );
+
+    /**
+      Returns the file which get() provides for @p url without downloading
+      anything: a local file, possibly found through the catalog, or a cached copy.
+      Returns an empty string if @p url would have to be downloaded.
+     */
+    static QString localFile( const QUrl &url );
+
   private:
     QString mFileName;
 };
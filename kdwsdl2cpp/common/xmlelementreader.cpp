@@ -0,0 +1,151 @@
+/*
+    This file is part of KDE Schema Parser
+
+    Copyright (c) 2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "xmlelementreader.h"
+
+#include <QDomText>
+#include <QIODevice>
+
+XmlElementReader::XmlElementReader( QIODevice *device )
+  : mReader( device ), mDocument( QLatin1String("kwsdl") ),
+    mElementLineNumber( -1 ), mElementColumnNumber( -1 )
+{
+}
+
+bool XmlElementReader::readNextStartElement()
+{
+  if ( !mReader.readNextStartElement() ) {
+    mElement = QDomElement();
+    mElementLineNumber = mElementColumnNumber = -1;
+    return false;
+  }
+
+  mElement = createElement();
+  // The end of the start tag, where the reader is now
+  mElementLineNumber = int( mReader.lineNumber() );
+  mElementColumnNumber = int( mReader.columnNumber() );
+  return true;
+}
+
+QDomElement XmlElementReader::element() const
+{
+  return mElement;
+}
+
+QDomElement XmlElementReader::readElement()
+{
+  const QDomElement root = mElement;
+  QDomElement parent = root;
+  while ( !mReader.atEnd() ) {
+    switch ( mReader.readNext() ) {
+      case QXmlStreamReader::StartElement: {
+        const QDomElement child = createElement();
+        parent.appendChild( child );
+        parent = child;
+        break;
+      }
+      case QXmlStreamReader::EndElement:
+        if ( parent == root )
+          return root;
+        parent = parent.parentNode().toElement();
+        break;
+      case QXmlStreamReader::Characters:
+        if ( !mReader.isWhitespace() ) {
+          // Merge text split by a comment or CDATA section, like QDom's text() would see it
+          QDomText text = parent.lastChild().toText();
+          if ( text.isNull() )
+            parent.appendChild( mDocument.createTextNode( mReader.text().toString() ) );
+          else
+            text.appendData( mReader.text().toString() );
+        }
+        break;
+      default: // comments, processing instructions, DTD: not needed by the parsers
+        break;
+    }
+  }
+
+  return root;
+}
+
+void XmlElementReader::skipCurrentElement()
+{
+  mReader.skipCurrentElement();
+}
+
+bool XmlElementReader::hasError() const
+{
+  return mReader.hasError();
+}
+
+QString XmlElementReader::errorString() const
+{
+  return mReader.errorString();
+}
+
+int XmlElementReader::lineNumber() const
+{
+  return mReader.lineNumber();
+}
+
+int XmlElementReader::columnNumber() const
+{
+  return mReader.columnNumber();
+}
+
+int XmlElementReader::elementLineNumber() const
+{
+  return mElementLineNumber;
+}
+
+int XmlElementReader::elementColumnNumber() const
+{
+  return mElementColumnNumber;
+}
+
+QDomElement XmlElementReader::createElement()
+{
+  // The elements are not attached to the document, so that they are deleted
+  // as soon as the parsers stop referencing them.
+  QDomElement element = mDocument.createElementNS( mReader.namespaceUri().toString(),
+                                                   mReader.qualifiedName().toString() );
+
+  // NSManager::enterChild looks for the xmlns attributes, like in a document
+  // loaded with the namespace-prefixes feature.
+  const QXmlStreamNamespaceDeclarations declarations = mReader.namespaceDeclarations();
+  for ( int i = 0; i < declarations.count(); ++i ) {
+    const QXmlStreamNamespaceDeclaration &declaration = declarations.at( i );
+    if ( declaration.prefix().isEmpty() )
+      element.setAttribute( QLatin1String("xmlns"), declaration.namespaceUri().toString() );
+    else
+      element.setAttribute( QLatin1String("xmlns:") + declaration.prefix().toString(), declaration.namespaceUri().toString() );
+  }
+
+  const QXmlStreamAttributes attributes = mReader.attributes();
+  for ( int i = 0; i < attributes.count(); ++i ) {
+    const QXmlStreamAttribute &attribute = attributes.at( i );
+    if ( attribute.namespaceUri().isEmpty() )
+      element.setAttribute( attribute.qualifiedName().toString(), attribute.value().toString() );
+    else
+      element.setAttributeNS( attribute.namespaceUri().toString(), attribute.qualifiedName().toString(), attribute.value().toString() );
+  }
+
+  return element;
+}
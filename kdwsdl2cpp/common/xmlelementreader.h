@@ -0,0 +1,96 @@
+/*
+    This file is part of KDE Schema Parser
+
+    Copyright (c) 2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef XMLELEMENTREADER_H
+#define XMLELEMENTREADER_H
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QXmlStreamReader>
+
+#include <kode_export.h>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/**
+  Streaming front-end for the WSDL and XSD parsers.
+
+  Instead of loading a whole document into a QDomDocument, the parsers walk
+  the container elements (definitions, types, schema) with readNextStartElement()
+  and only turn the individual top-level definitions into small DOM trees with
+  readElement(). Each of these trees can be released as soon as the model
+  object has been built from it, so memory usage is bounded by the largest
+  single definition rather than by the size of the document.
+ */
+class KXMLCOMMON_EXPORT XmlElementReader
+{
+  public:
+    explicit XmlElementReader( QIODevice *device );
+
+    /**
+      Moves to the next child element of the current element (to the document
+      element, on the first call). Returns false when the end of the current
+      element has been reached, or on error.
+     */
+    bool readNextStartElement();
+
+    /**
+      Returns the current element, with its attributes and namespace
+      declarations, but without any children.
+     */
+    QDomElement element() const;
+
+    /**
+      Reads the current element and all of its children into a DOM tree.
+      Comments, processing instructions and whitespace-only text are dropped.
+     */
+    QDomElement readElement();
+
+    /**
+      Skips the current element and all of its children.
+     */
+    void skipCurrentElement();
+
+    bool hasError() const;
+    QString errorString() const;
+    int lineNumber() const;
+    int columnNumber() const;
+
+    /**
+      Returns the position of the current element in the document, for messages:
+      the elements built by this reader don't have one.
+     */
+    int elementLineNumber() const;
+    int elementColumnNumber() const;
+
+  private:
+    QDomElement createElement();
+
+    QXmlStreamReader mReader;
+    QDomDocument mDocument;
+    QDomElement mElement;
+    int mElementLineNumber;
+    int mElementColumnNumber;
+};
+
+#endif
@@ -95,6 +95,7 @@ class Function::FunctionPrivate
     QStringList mInitializers;
     QString mBody;
     QString mDocs;
+    QString mPreprocessorCondition;
     Function::VirtualMode mVirtualMode;
 };
 
@@ -272,6 +273,16 @@ QString Function::docs() const
   return d->mDocs;
 }
 
+void Function::setPreprocessorCondition( const QString &macro )
+{
+  d->mPreprocessorCondition = macro;
+}
+
+QString Function::preprocessorCondition() const
+{
+  return d->mPreprocessorCondition;
+}
+
 bool Function::hasArguments() const
 {
   return !d->mArguments.isEmpty();
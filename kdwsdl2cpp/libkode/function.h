@@ -230,6 +230,17 @@ class KODE_EXPORT Function
      */
     QString docs() const;
 
+    /**
+     * Sets the preprocessor @param macro which must be defined
+     * for the function to be declared and implemented, e.g. Q_COMPILER_RVALUE_REFS.
+     */
+    void setPreprocessorCondition( const QString &macro );
+
+    /**
+     * Returns the preprocessor macro which must be defined for the function to be available.
+     */
+    QString preprocessorCondition() const;
+
   private:
     class FunctionPrivate;
     FunctionPrivate *d;
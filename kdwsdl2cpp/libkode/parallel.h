@@ -0,0 +1,91 @@
+/*
+    This file is part of KDE.
+
+    Copyright (c) 2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+#ifndef KODE_PARALLEL_H
+#define KODE_PARALLEL_H
+
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+namespace KODE {
+
+template <typename Result, typename Function>
+class ParallelMapTask : public QRunnable
+{
+  public:
+    ParallelMapTask( Result *results, const Function &function, int begin, int end, QSemaphore *done )
+      : mResults( results ), mFunction( function ), mBegin( begin ), mEnd( end ), mDone( done )
+    {
+    }
+
+    void run()
+    {
+      for ( int i = mBegin; i < mEnd; ++i )
+        mResults[ i ] = mFunction( i );
+      mDone->release();
+    }
+
+  private:
+    Result *mResults;
+    Function mFunction;
+    int mBegin;
+    int mEnd;
+    QSemaphore *mDone;
+};
+
+/**
+ * Returns function( i ) for every i in [0, count), computed on the
+ * global thread pool. The results are stored by index, so they come out
+ * in the same order as with a sequential loop, whatever the number of
+ * threads; with a maximum thread count of 1 it is a plain loop.
+ *
+ * @p function is copied into each worker thread, and must only read
+ * shared data.
+ */
+template <typename Result, typename Function>
+QVector<Result> parallelMap( int count, const Function &function )
+{
+  QVector<Result> results( count );
+  QThreadPool *pool = QThreadPool::globalInstance();
+  if ( pool->maxThreadCount() <= 1 || count < 2 ) {
+    for ( int i = 0; i < count; ++i )
+      results[ i ] = function( i );
+    return results;
+  }
+
+  // A few chunks per thread, so that a chunk of expensive items doesn't leave the other threads idle
+  const int chunks = qMin( count, pool->maxThreadCount() * 4 );
+  Result *data = results.data();
+  QSemaphore done;
+  for ( int chunk = 0; chunk < chunks; ++chunk ) {
+    const int begin = qint64( count ) * chunk / chunks;
+    const int end = qint64( count ) * ( chunk + 1 ) / chunks;
+    pool->start( new ParallelMapTask<Result, Function>( data, function, begin, end, &done ) );
+  }
+  done.acquire( chunks );
+
+  return results;
+}
+
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include <QtCore/QFileInfo>
 #include <QDebug>
 
+#include "parallel.h"
 #include "printer.h"
 
 using namespace KODE;
@@ -38,6 +39,8 @@ class Printer::Private
       mCreationWarning( false ),
       mLabelsDefineIndent( true ),
       mIndentLabels( true ),
+      mImplementationFileCount( 1 ),
+      mSkipUnchangedFiles( false ),
       mGenerator( "libkode" )
     {
     }
@@ -50,12 +53,37 @@ class Printer::Private
                              const QString &className,
                              int access );
     QString formatType( const QString& type ) const;
+    void writeFile( const QString &fileName, const QString &text );
+
+    // Functors for parallelMap(): the classes are printed on all cores,
+    // and the output is assembled in the original class order.
+    class ClassHeaderPrinter
+    {
+      public:
+        ClassHeaderPrinter( Private *d, const Class::List &classes ) : d( d ), mClasses( classes ) {}
+        QString operator()( int i ) const { return d->classHeader( mClasses.at( i ), false ); }
+      private:
+        Private *d;
+        const Class::List mClasses;
+    };
+
+    class ClassImplementationPrinter
+    {
+      public:
+        ClassImplementationPrinter( Private *d, const Class::List &classes ) : d( d ), mClasses( classes ) {}
+        QString operator()( int i ) const { return d->classImplementation( mClasses.at( i ) ); }
+      private:
+        Private *d;
+        const Class::List mClasses;
+    };
 
     Printer *mParent;
     Style mStyle;
     bool mCreationWarning;
     bool mLabelsDefineIndent;
     bool mIndentLabels;
+    int mImplementationFileCount;
+    bool mSkipUnchangedFiles;
     QString mGenerator;
     QString mOutputDirectory;
     QString mSourceFile;
@@ -84,6 +112,37 @@ QString Printer::Private::formatType( const QString& type ) const
   return s;
 }
 
+void Printer::Private::writeFile( const QString &fileName, const QString &text )
+{
+  QString filename = fileName;
+
+  if ( !mOutputDirectory.isEmpty() )
+    filename.prepend( mOutputDirectory + '/' );
+
+  QByteArray data;
+  {
+    QTextStream stream( &data, QIODevice::WriteOnly );
+    stream << text;
+  }
+
+  QFile file( filename );
+
+  // Keep the timestamp of files which didn't change, so that they don't get recompiled
+  if ( mSkipUnchangedFiles && file.open( QIODevice::ReadOnly ) ) {
+    const bool unchanged = ( file.readAll() == data );
+    file.close();
+    if ( unchanged )
+      return;
+  }
+
+  if ( !file.open( QIODevice::WriteOnly ) ) {
+    qWarning( "Can't open '%s' for writing.", qPrintable( filename ) );
+    return;
+  }
+
+  file.write( data );
+}
+
 QString Printer::Private::classHeader( const Class &classObject, bool publicMembers, bool nestedClass )
 {
   Code code;
@@ -208,6 +267,15 @@ QString Printer::Private::classHeader( const Class &classObject, bool publicMemb
     op.addArgument( "const " + classObject.name() + '&' );
     Function::List list;
     list << cc << op;
+    if ( classObject.useSharedData() ) {
+      Function mc( classObject.name() );
+      mc.addArgument( classObject.name() + "&&" );
+      mc.setPreprocessorCondition( "Q_COMPILER_RVALUE_REFS" );
+      Function mop( "operator=", classObject.name() + '&' );
+      mop.addArgument( classObject.name() + "&&" );
+      mop.setPreprocessorCondition( "Q_COMPILER_RVALUE_REFS" );
+      list << mc << mop;
+    }
     addFunctionHeaders( code, list, classObject.name(), Function::Public );
   }
 
@@ -346,6 +414,8 @@ QString Printer::Private::classImplementation( const Class &classObject, bool ne
     if ( f.virtualMode() == Function::PureVirtual && f.body().isEmpty() )
       continue;
 
+    if ( !f.preprocessorCondition().isEmpty() )
+      code.addBlock( "#ifdef " + f.preprocessorCondition(), 0 );
     code += mParent->functionSignature( f, functionClassName, true );
 
     QStringList inits = f.initializers();
@@ -384,6 +454,8 @@ QString Printer::Private::classImplementation( const Class &classObject, bool ne
       code.unindent();
     }
     code += '}';
+    if ( !f.preprocessorCondition().isEmpty() )
+      code.addBlock( "#endif", 0 );
     code.newLine();
   }
 
@@ -449,6 +521,52 @@ QString Printer::Private::classImplementation( const Class &classObject, bool ne
     code.addBlock( op.body(), Code::defaultIndentation() );
     code += '}';
     code.newLine();
+
+    if ( classObject.useSharedData() ) {
+      // print move constructor and move assignment operator.
+      // Like with Qt's implicitly shared classes, the moved-from object stays valid:
+      // empty after a move construction, holding the previous value after a move assignment.
+      code.addBlock( "#ifdef Q_COMPILER_RVALUE_REFS", 0 );
+      Function mc( classObject.name() );
+      mc.addArgument( functionClassName + "&& other" );
+      code += mParent->functionSignature( mc, functionClassName, true );
+      list.clear();
+      for ( int i = 0; i < baseClasses.count(); ++i ) {
+        list.append( baseClasses[ i ].name() + "( static_cast<" + baseClasses[ i ].name() + " &&>( other ) )" );
+      }
+      if ( !list.isEmpty() ) {
+        code.indent();
+        code += ": " + list.join( ", " );
+        code.unindent();
+      }
+      code += '{';
+      code.indent();
+      // other gets an empty private shared by all the moved-from objects, which detach from it when modified:
+      // moving doesn't allocate anything
+      code += "static const QSharedDataPointer<PrivateDPtr> s_emptyPrivate(new PrivateDPtr);";
+      code += classObject.dPointerName() + " = s_emptyPrivate;";
+      code += classObject.dPointerName() + ".swap( other." + classObject.dPointerName() + " );";
+      code.unindent();
+      code += '}';
+      code.newLine();
+
+      Function mop( "operator=", functionClassName + "& " );
+      mop.addArgument( functionClassName + "&& other" );
+      body.clear();
+      body += classObject.dPointerName() + ".swap( other." + classObject.dPointerName() + " );";
+      for ( int i = 0; i < baseClasses.count(); ++i ) {
+        body += QLatin1String("* static_cast<") + baseClasses[i].name() + QLatin1String(" *>(this) = static_cast<") + baseClasses[i].name() + QLatin1String(" &&>(other);");
+      }
+      body += "return *this;";
+      mop.setBody( body );
+
+      code += mParent->functionSignature( mop, functionClassName, true );
+      code += '{';
+      code.addBlock( mop.body(), Code::defaultIndentation() );
+      code += '}';
+      code.addBlock( "#endif", 0 );
+      code.newLine();
+    }
   }
 
   // Generate nested class functions
@@ -486,7 +604,11 @@ void Printer::Private::addFunctionHeaders( Code& code,
         code.unindent();
         code += " */";
       }
+      if ( !(*it).preprocessorCondition().isEmpty() )
+        code.addBlock( "#ifdef " + (*it).preprocessorCondition(), 0 );
       code += mParent->functionSignature( *it, className, false ) + ';';
+      if ( !(*it).preprocessorCondition().isEmpty() )
+        code.addBlock( "#endif", 0 );
       if ( mLabelsDefineIndent )
         code.unindent();
       needNewLine = true;
@@ -553,6 +675,16 @@ void Printer::setSourceFile( const QString &sourceFile )
   d->mSourceFile = sourceFile;
 }
 
+void Printer::setImplementationFileCount( int count )
+{
+  d->mImplementationFileCount = qMax( 1, count );
+}
+
+void Printer::setSkipUnchangedFiles( bool skip )
+{
+  d->mSkipUnchangedFiles = skip;
+}
+
 void Printer::setLabelsDefineIndent( bool b )
 {
   d->mLabelsDefineIndent = b;
@@ -771,8 +903,10 @@ void Printer::printHeader( const File &file )
   }
 
   // Create content
-  for ( it = classes.constBegin(); it != classes.constEnd(); ++it ) {
-    out.addBlock( d->classHeader( *it, false ) );
+  const QVector<QString> classHeaders =
+    parallelMap<QString>( classes.count(), Private::ClassHeaderPrinter( d, classes ) );
+  for ( int i = 0; i < classHeaders.count(); ++i ) {
+    out.addBlock( classHeaders.at( i ) );
     out.newLine();
   }
 
@@ -786,27 +920,56 @@ void Printer::printHeader( const File &file )
 
 
   // Print to file
-  QString filename = file.filenameHeader();
-
-  if ( !d->mOutputDirectory.isEmpty() )
-    filename.prepend( d->mOutputDirectory + '/' );
+  d->writeFile( file.filenameHeader(), out.text() );
+}
 
-//  KSaveFile::simpleBackupFile( filename, QString(), ".backup" );
+void Printer::printImplementation( const File &file, bool createHeaderInclude )
+{
+  const Class::List classes = file.classes();
+  const QVector<QString> classImplementations =
+    parallelMap<QString>( classes.count(), Private::ClassImplementationPrinter( d, classes ) );
+
+  // Cut the list of classes so that each file gets about the same amount of code.
+  // Every file is written, even if it ends up empty, so that build systems can rely on them.
+  qint64 totalSize = 0;
+  for ( int i = 0; i < classImplementations.count(); ++i )
+    totalSize += classImplementations.at( i ).size();
+
+  int begin = 0;
+  qint64 printedSize = 0;
+  for ( int index = 0; index < d->mImplementationFileCount; ++index ) {
+    int end = begin;
+    if ( index == d->mImplementationFileCount - 1 ) {
+      end = classes.count();
+    } else {
+      const qint64 targetSize = totalSize * ( index + 1 ) / d->mImplementationFileCount;
+      while ( end < classes.count() && printedSize < targetSize )
+        printedSize += classImplementations.at( end++ ).size();
+    }
 
-  QFile header( filename );
-  if ( !header.open( QIODevice::WriteOnly ) ) {
-    qWarning( "Can't open '%s' for writing.", qPrintable( filename ) );
-    return;
+    printImplementationFile( file, implementationFilename( file.filenameImplementation(), index ),
+                             createHeaderInclude, index == 0,
+                             classes.mid( begin, end - begin ), classImplementations.mid( begin, end - begin ) );
+    begin = end;
   }
+}
 
-  QTextStream h( &header );
-
-  h << out.text();
-
-  header.close();
+QString Printer::implementationFilename( const QString &filename, int index )
+{
+  if ( index == 0 )
+    return filename;
+
+  const int dot = filename.lastIndexOf( QLatin1Char( '.' ) );
+  const int slash = filename.lastIndexOf( QLatin1Char( '/' ) );
+  const QString suffix = QLatin1Char( '_' ) + QString::number( index + 1 );
+  if ( dot <= slash )
+    return filename + suffix;
+  return filename.left( dot ) + suffix + filename.mid( dot );
 }
 
-void Printer::printImplementation( const File &file, bool createHeaderInclude )
+void Printer::printImplementationFile( const File &file, const QString &fileName, bool createHeaderInclude,
+                                       bool printFileContents, const Class::List &classes,
+                                       const QVector<QString> &classImplementations )
 {
   Code out;
 
@@ -833,15 +996,16 @@ void Printer::printImplementation( const File &file, bool createHeaderInclude )
 
   // Create class includes
   QStringList processed;
-  Class::List classes = file.classes();
+  QSet<QString> processedSet;
   Class::List::ConstIterator it;
   for ( it = classes.constBegin(); it != classes.constEnd(); ++it ) {
     QStringList includes = (*it).includes();
     QStringList::ConstIterator it2;
     for ( it2 = includes.constBegin(); it2 != includes.constEnd(); ++it2 ) {
-      if ( !processed.contains( *it2 ) ) {
+      if ( !processedSet.contains( *it2 ) ) {
         out += "#include <" + *it2 + '>';
         processed.append( *it2 );
+        processedSet.insert( *it2 );
       }
     }
   }
@@ -854,65 +1018,68 @@ void Printer::printImplementation( const File &file, bool createHeaderInclude )
     out.newLine();
   }
 
-  // 'extern "C"' declarations
-  const QStringList externCDeclarations = file.externCDeclarations();
-  if ( !externCDeclarations.isEmpty() ) {
-    out += "extern \"C\" {";
-    QStringList::ConstIterator it;
-    for ( it = externCDeclarations.constBegin(); it != externCDeclarations.constEnd();
-         ++it ) {
-      out += *it + ';';
+  // The file-level code goes into the first file only
+  if ( printFileContents ) {
+    // 'extern "C"' declarations
+    const QStringList externCDeclarations = file.externCDeclarations();
+    if ( !externCDeclarations.isEmpty() ) {
+      out += "extern \"C\" {";
+      QStringList::ConstIterator it;
+      for ( it = externCDeclarations.constBegin(); it != externCDeclarations.constEnd();
+           ++it ) {
+        out += *it + ';';
+      }
+      out += '}';
+      out.newLine();
     }
-    out += '}';
-    out.newLine();
-  }
 
-  // File variables
-  Variable::List vars = file.fileVariables();
-  Variable::List::ConstIterator itV;
-  for ( itV = vars.constBegin(); itV != vars.constEnd(); ++itV ) {
-    Variable v = *itV;
-    QString str;
-    if ( v.isStatic() )
-      str += "static ";
-    str += v.type() + ' ' + v.name() + ';';
-    out += str;
-  }
+    // File variables
+    Variable::List vars = file.fileVariables();
+    Variable::List::ConstIterator itV;
+    for ( itV = vars.constBegin(); itV != vars.constEnd(); ++itV ) {
+      Variable v = *itV;
+      QString str;
+      if ( v.isStatic() )
+        str += "static ";
+      str += v.type() + ' ' + v.name() + ';';
+      out += str;
+    }
 
-  if ( !vars.isEmpty() )
-    out.newLine();
+    if ( !vars.isEmpty() )
+      out.newLine();
 
-  // File code
-  if ( !file.fileCode().isEmpty() ) {
-    out += file.fileCode();
-    out.newLine();
-  }
+    // File code
+    if ( !file.fileCode().isEmpty() ) {
+      out += file.fileCode();
+      out.newLine();
+    }
 
-  // File functions
-  Function::List funcs = file.fileFunctions();
-  Function::List::ConstIterator itF;
-  for ( itF = funcs.constBegin(); itF != funcs.constEnd(); ++itF ) {
-    Function f = *itF;
-    out += functionSignature( f );
-    out += '{';
-    out.addBlock( f.body(), Code::defaultIndentation() );
-    out += '}';
-    out.newLine();
+    // File functions
+    Function::List funcs = file.fileFunctions();
+    Function::List::ConstIterator itF;
+    for ( itF = funcs.constBegin(); itF != funcs.constEnd(); ++itF ) {
+      Function f = *itF;
+      out += functionSignature( f );
+      out += '{';
+      out.addBlock( f.body(), Code::defaultIndentation() );
+      out += '}';
+      out.newLine();
+    }
   }
 
   // Classes
 #ifdef KDAB_DELETED
   bool containsQObject = false;
 #endif
-  for ( it = classes.constBegin(); it != classes.constEnd(); ++it ) {
+  for ( int i = 0; i < classImplementations.count(); ++i ) {
 #ifdef KDAB_DELETED
-    if ( (*it).isQObject() )
+    if ( classes.at( i ).isQObject() )
       containsQObject = true;
 #endif
 
-    QString str = d->classImplementation( *it );
+    const QString &str = classImplementations.at( i );
     if ( !str.isEmpty() )
-      out += d->classImplementation( *it );
+      out += str;
   }
 
   if ( !file.nameSpace().isEmpty() ) {
@@ -929,22 +1096,7 @@ void Printer::printImplementation( const File &file, bool createHeaderInclude )
 #endif
 
   // Print to file
-  QString filename = file.filenameImplementation();
-
-  if ( !d->mOutputDirectory.isEmpty() )
-    filename.prepend( d->mOutputDirectory + '/' );
-
-  QFile implementation( filename );
-  if ( !implementation.open( QIODevice::WriteOnly ) ) {
-    qWarning( "Can't open '%s' for writing.", qPrintable( filename ) );
-    return;
-  }
-
-  QTextStream h( &implementation );
-
-  h << out.text();
-
-  implementation.close();
+  d->writeFile( fileName, out.text() );
 }
 
 #if 0 // TODO: port to cmake
@@ -25,6 +25,8 @@
 #include "file.h"
 #include "style.h"
 
+#include <QtCore/QVector>
+
 #include <kode_export.h>
 
 namespace KODE {
@@ -117,6 +119,28 @@ class KODE_EXPORT Printer
      */
     void printImplementation( const File &file, bool createHeaderInclude = true );
 
+    /**
+     * Sets the number of files printImplementation() spreads the classes over,
+     * so that they can be compiled in parallel. The first file is
+     * File::filenameImplementation(), the others are named after it,
+     * see implementationFilename(). The default is 1.
+     */
+    void setImplementationFileCount( int count );
+
+    /**
+     * Returns the name of the implementation file number @param index
+     * (starting from 0) for the implementation file @param filename:
+     * "foo.cpp" for index 0, then "foo_2.cpp", "foo_3.cpp" etc.
+     */
+    static QString implementationFilename( const QString &filename, int index );
+
+    /**
+     * Sets whether files whose content would not change are left untouched,
+     * instead of being written again. This keeps their modification time,
+     * so that incremental builds don't recompile them. The default is false.
+     */
+    void setSkipUnchangedFiles( bool skip );
+
     /**
      * Prints a automake file as defined by @param autoMakefile.
      */
@@ -149,8 +173,11 @@ class KODE_EXPORT Printer
      */
     virtual QString licenseHeader( const File &file ) const;
 
-
   private:
+    void printImplementationFile( const File &file, const QString &fileName, bool createHeaderInclude,
+                                  bool printFileContents, const Class::List &classes,
+                                  const QVector<QString> &classImplementations );
+
     class Private;
     Private *d;
 };
@@ -24,7 +24,6 @@
 #include <QDir>
 #include <QFile>
 #include <QUrl>
-#include <QXmlSimpleReader>
 #include <QtDebug>
 #include <QtCore/QLatin1String>
 
@@ -32,6 +31,7 @@
 #include <common/messagehandler.h>
 #include <common/nsmanager.h>
 #include <common/parsercontext.h>
+#include <common/xmlelementreader.h>
 #include "parser.h"
 
 static const QString XMLSchemaURI(QLatin1String("http://www.w3.org/2001/XMLSchema"));
@@ -170,8 +170,9 @@ void Parser::init(ParserContext *context)
     d->mImportedSchemas.append(NSManager::soapEncNamespaces());
 }
 
-bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
+bool Parser::parseSchemaTag(ParserContext *context, XmlElementReader &reader)
 {
+    const QDomElement root = reader.element();
     QName name(root.tagName());
     if (name.localName() != QLatin1String("schema")) {
         qDebug() << "ERROR localName=" << name.localName();
@@ -197,8 +198,9 @@ bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
 
 // mTypesTable.setTargetNamespace( mNameSpace );
 
-    QDomElement element = root.firstChildElement();
-    while (!element.isNull()) {
+    // Each global definition is loaded on its own, and released once parsed
+    while (reader.readNextStartElement()) {
+        const QDomElement element = reader.readElement();
         NSManager namespaceManager(context, element);
         const QName name(element.tagName());
         if (debugParsing()) {
@@ -223,18 +225,16 @@ bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
         } else if (name.localName() == QLatin1String("annotation")) {
             d->mAnnotations = parseAnnotation(context, element);
         } else if (name.localName() == QLatin1String("include")) {
-            parseInclude(context, element);
+            parseInclude(context, element, reader.elementLineNumber(), reader.elementColumnNumber());
         } else {
-            qWarning() << "Unsupported schema element" << name.localName();
+            qWarning() << "Unsupported schema element" << name.localName() << "at" << reader.elementLineNumber() << reader.elementColumnNumber();
         }
-
-        element = element.nextSiblingElement();
     }
 
     d->mImportedSchemas.append(d->mNameSpace);
     d->mNameSpace = oldNamespace;
 
-    return true;
+    return !reader.hasError();
 }
 
 void Parser::parseImport(ParserContext *context, const QDomElement &element)
@@ -269,7 +269,7 @@ void Parser::parseImport(ParserContext *context, const QDomElement &element)
     importSchema(context, location);
 }
 
-void Parser::parseInclude(ParserContext *context, const QDomElement &element)
+void Parser::parseInclude(ParserContext *context, const QDomElement &element, int line, int column)
 {
     QString location = element.attribute(QLatin1String("schemaLocation"));
 
@@ -283,7 +283,7 @@ void Parser::parseInclude(ParserContext *context, const QDomElement &element)
 
         includeSchema(context, location);
     } else {
-        context->messageHandler()->warning(QString::fromLatin1("include tag found at (%1, %2) contains no schemaLocation tag.").arg(element.lineNumber(), element.columnNumber()));
+        context->messageHandler()->warning(QString::fromLatin1("include tag found at (%1, %2) contains no schemaLocation tag.").arg(line).arg(column));
     }
 }
 
@@ -1086,26 +1086,19 @@ void Parser::importSchema(ParserContext *context, const QString &location)
             return;
         }
 
-        QXmlInputSource source(&file);
-        QXmlSimpleReader reader;
-        reader.setFeature(QLatin1String("http://xml.org/sax/features/namespace-prefixes"), true);
-
-        QDomDocument doc(QLatin1String("kwsdl"));
-        QString errorMsg;
-        int errorLine, errorColumn;
-        bool ok = doc.setContent(&source, &reader, &errorMsg, &errorLine, &errorColumn);
-        if (!ok) {
-            qDebug("Error[%d:%d] %s", errorLine, errorColumn, qPrintable(errorMsg));
+        XmlElementReader reader(&file);
+        if (!reader.readNextStartElement()) {
+            qDebug("Error[%d:%d] %s", reader.lineNumber(), reader.columnNumber(), qPrintable(reader.errorString()));
             return;
         }
 
-        QDomElement node = doc.documentElement();
+        QDomElement node = reader.element();
 
         NSManager namespaceManager(context, node);
 
         const QName tagName(node.tagName());
         if (tagName.localName() == QLatin1String("schema")) {
-            importOrIncludeSchema(context, node, schemaLocation);
+            importOrIncludeSchema(context, reader, schemaLocation);
         } else {
             qDebug("No schema tag found in schema file %s", schemaLocation.toEncoded().constData());
         }
@@ -1133,20 +1126,13 @@ void Parser::includeSchema(ParserContext *context, const QString &location)
             return;
         }
 
-        QXmlInputSource source(&file);
-        QXmlSimpleReader reader;
-        reader.setFeature(QLatin1String("http://xml.org/sax/features/namespace-prefixes"), true);
-
-        QDomDocument doc(QLatin1String("kwsdl"));
-        QString errorMsg;
-        int errorLine, errorColumn;
-        bool ok = doc.setContent(&source, &reader, &errorMsg, &errorLine, &errorColumn);
-        if (!ok) {
-            qDebug("Error[%d:%d] %s", errorLine, errorColumn, qPrintable(errorMsg));
+        XmlElementReader reader(&file);
+        if (!reader.readNextStartElement()) {
+            qDebug("Error[%d:%d] %s", reader.lineNumber(), reader.columnNumber(), qPrintable(reader.errorString()));
             return;
         }
 
-        QDomElement node = doc.documentElement();
+        QDomElement node = reader.element();
         NSManager namespaceManager(context, node);
         const QName tagName(node.tagName());
         if (tagName.localName() == QLatin1String("schema")) {
@@ -1157,7 +1143,7 @@ void Parser::includeSchema(ParserContext *context, const QString &location)
                     return;
                 }
             }
-            importOrIncludeSchema(context, node, schemaLocation);
+            importOrIncludeSchema(context, reader, schemaLocation);
         } else {
             qDebug("No schema tag found in schema file %s", schemaLocation.toEncoded().constData());
         }
@@ -1168,12 +1154,15 @@ void Parser::includeSchema(ParserContext *context, const QString &location)
     }
 }
 
-bool Parser::importOrIncludeSchema(ParserContext *context, const QDomElement &element, const QUrl &schemaLocation)
+bool Parser::importOrIncludeSchema(ParserContext *context, XmlElementReader &reader, const QUrl &schemaLocation)
 {
     const QUrl oldBaseUrl = context->documentBaseUrl();
     context->setDocumentBaseUrlFromFileUrl(schemaLocation);
 
-    const bool ret = parseSchemaTag(context, element);
+    const bool ret = parseSchemaTag(context, reader);
+    if (reader.hasError()) {
+        qDebug("Error[%d:%d] %s", reader.lineNumber(), reader.columnNumber(), qPrintable(reader.errorString()));
+    }
 
     context->setDocumentBaseUrl(oldBaseUrl);
 
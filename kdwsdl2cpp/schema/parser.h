@@ -34,6 +34,7 @@
 
 class QUrl;
 class ParserContext;
+class XmlElementReader;
 
 namespace XSD
 {
@@ -53,7 +54,8 @@ public:
 
     Annotation::List annotations() const;
 
-    bool parseSchemaTag(ParserContext *context, const QDomElement &element);
+    // Reads the <schema> element the reader is positioned on
+    bool parseSchemaTag(ParserContext *context, XmlElementReader &reader);
 
     QString targetNamespace() const;
 
@@ -74,8 +76,9 @@ private:
      * of the current document. Use <import> if you want to refer to a external namespace.
      * @param context Current parser context.
      * @param element DOM element to parse.
+     * @param line, column Position of the element in the document, for messages.
      */
-    void parseInclude(ParserContext *context, const QDomElement &element);
+    void parseInclude(ParserContext *context, const QDomElement &element, int line, int column);
     void addGlobalElement(const Element &);
     void addGlobalAttribute(const Attribute &);
     AttributeGroup parseAttributeGroup(ParserContext *context, const QDomElement &, const QString &nameSpace);
@@ -113,7 +116,7 @@ private:
      */
     void includeSchema(ParserContext *context, const QString &location);
 
-    bool importOrIncludeSchema(ParserContext *context, const QDomElement &element, const QUrl &schemaLocation);
+    bool importOrIncludeSchema(ParserContext *context, XmlElementReader &reader, const QUrl &schemaLocation);
 
     Element findElement(const QName &name) const;
     Group findGroup(const QName &name) const;
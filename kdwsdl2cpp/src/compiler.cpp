@@ -26,10 +26,13 @@
 #include <common/fileprovider.h>
 #include <common/messagehandler.h>
 #include <common/parsercontext.h>
+#include <common/xmlelementreader.h>
+#include <libkode/printer.h>
 
 #include "converter.h"
 #include "creator.h"
 #include "settings.h"
+#include "stampfile.h"
 
 #include "compiler.h"
 
@@ -40,8 +43,35 @@ Compiler::Compiler()
 {
 }
 
+// The files written by Creator::create()
+static QStringList outputFiles()
+{
+    const QString outputFile = Settings::self()->outputDirectory() + QLatin1Char('/') + Settings::self()->outputFileName();
+    if (!Settings::self()->generateImplementation()) {
+        return QStringList() << outputFile;
+    }
+    QStringList files;
+    for (int i = 0; i < Settings::self()->implementationFileCount(); ++i) {
+        files << KODE::Printer::implementationFilename(outputFile, i);
+    }
+    return files;
+}
+
+static QString stampFileName()
+{
+    return Settings::self()->outputDirectory() + QLatin1Char('/') + Settings::self()->outputFileName() + QLatin1String(".stamp");
+}
+
 void Compiler::run()
 {
+    const StampFile stampFile(stampFileName());
+    if (Settings::self()->incremental() && stampFile.isUpToDate(outputFiles())) {
+        qDebug("%s is up to date", qPrintable(Settings::self()->outputFileName()));
+        stampFile.touch();
+        QCoreApplication::exit(0);
+        return;
+    }
+
     download();
 }
 
@@ -60,20 +90,15 @@ void Compiler::download()
         }
 
         //qDebug() << "parsing" << fileName;
-        QXmlInputSource source(&file);
-        QXmlSimpleReader reader;
-        reader.setFeature(QLatin1String("http://xml.org/sax/features/namespace-prefixes"), true);
-
-        QString errorMsg;
-        int errorLine, errorCol;
-        QDomDocument doc;
-        if (!doc.setContent(&source, &reader, &errorMsg, &errorLine, &errorCol)) {
-            qDebug("%s at (%d,%d)", qPrintable(errorMsg), errorLine, errorCol);
+        XmlElementReader reader(&file);
+        if (!reader.readNextStartElement()) {
+            qDebug("%s at (%d,%d)", qPrintable(reader.errorString()), reader.lineNumber(), reader.columnNumber());
+            provider.cleanUp();
             QCoreApplication::exit(2);
             return;
         }
 
-        parse(doc.documentElement());
+        parse(reader);
 
         provider.cleanUp();
     } else {
@@ -84,7 +109,7 @@ void Compiler::download()
     }
 }
 
-void Compiler::parse(const QDomElement &element)
+void Compiler::parse(XmlElementReader &reader)
 {
     NSManager namespaceManager;
 
@@ -99,7 +124,12 @@ void Compiler::parse(const QDomElement &element)
 
     Definitions definitions;
     definitions.setWantedService(Settings::self()->wantedService());
-    if (definitions.loadXML(&context, element)) {
+    const bool ok = definitions.loadXML(&context, reader);
+    // The document is parsed while it is being read, so a syntax error can show up late
+    if (reader.hasError()) {
+        qDebug("%s at (%d,%d)", qPrintable(reader.errorString()), reader.lineNumber(), reader.columnNumber());
+        QCoreApplication::exit(2);
+    } else if (ok) {
 
         definitions.fixUpDefinitions(/*&context, element*/);
 
@@ -117,6 +147,9 @@ void Compiler::parse(const QDomElement &element)
         } else {
             KWSDL::Creator creator;
             creator.create(converter.classes());
+            if (Settings::self()->incremental()) {
+                StampFile(stampFileName()).write();
+            }
             QCoreApplication::exit(0);
         }
     } else {
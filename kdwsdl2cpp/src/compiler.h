@@ -20,9 +20,10 @@
 #ifndef KWSDL_COMPILER_H
 #define KWSDL_COMPILER_H
 
-#include <QDomElement>
 #include <QObject>
 
+class XmlElementReader;
+
 namespace KWSDL
 {
 
@@ -38,7 +39,7 @@ public slots:
 
 private slots:
     void download();
-    void parse(const QDomElement &);
+    void parse(XmlElementReader &reader);
 };
 
 }
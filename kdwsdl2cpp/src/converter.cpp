@@ -1,6 +1,7 @@
 #include "settings.h"
 #include "elementargumentserializer.h"
 #include "converter.h"
+#include <libkode/parallel.h>
 #include <libkode/style.h>
 #include <QDebug>
 
@@ -374,20 +375,62 @@ bool Converter::convert()
     return convertClientService();
 }
 
+// Converts the i-th type of the schema (simple types first, then complex types)
+// into its own class list. The types and the type map are read-only by then,
+// so convertTypes() runs this on all cores.
+class Converter::TypeConversion
+{
+public:
+    TypeConversion(const Converter *converter, const XSD::SimpleType::List &simpleTypes, const XSD::ComplexType::List &complexTypes)
+        : mConverter(converter), mSimpleTypes(simpleTypes), mComplexTypes(complexTypes)
+    {
+    }
+
+    KODE::Class::List operator()(int i) const
+    {
+        KODE::Class::List classes;
+        if (i < mSimpleTypes.count()) {
+            mConverter->convertSimpleType(&mSimpleTypes.at(i), mSimpleTypes, classes);
+        } else {
+            mConverter->convertComplexType(&mComplexTypes.at(i - mSimpleTypes.count()), classes);
+        }
+        return classes;
+    }
+
+private:
+    const Converter *mConverter;
+    const XSD::SimpleType::List mSimpleTypes;
+    const XSD::ComplexType::List mComplexTypes;
+};
+
 void Converter::convertTypes()
 {
     const XSD::Types types = mWSDL.definitions().type().types();
 
-    XSD::SimpleType::List simpleTypes = types.simpleTypes();
+    const XSD::SimpleType::List simpleTypes = types.simpleTypes();
     qDebug() << "Converting" << simpleTypes.count() << "simple types";
-    for (int i = 0; i < simpleTypes.count(); ++i) {
-        convertSimpleType(&(simpleTypes[ i ]), simpleTypes);
-    }
-
-    XSD::ComplexType::List complexTypes = types.complexTypes();
+    const XSD::ComplexType::List complexTypes = types.complexTypes();
     qDebug() << "Converting" << complexTypes.count() << "complex types";
-    for (int i = 0; i < complexTypes.count(); ++i) {
-        convertComplexType(&(complexTypes[ i ]));
+
+    const QVector<KODE::Class::List> results =
+        KODE::parallelMap<KODE::Class::List>(simpleTypes.count() + complexTypes.count(),
+                                             TypeConversion(this, simpleTypes, complexTypes));
+
+    // Merge in type order, so that the output doesn't depend on the number of threads.
+    // Same check as KODE::ClassList::addClass, without its linear search.
+    QSet<QString> classNames;
+    Q_FOREACH (const KODE::Class &cl, mClasses) {
+        classNames.insert(cl.qualifiedName());
+    }
+    for (int i = 0; i < results.count(); ++i) {
+        Q_FOREACH (const KODE::Class &cl, results.at(i)) {
+            const QString qn = cl.qualifiedName();
+            if (classNames.contains(qn)) {
+                qWarning() << "ERROR: Already having a class called" << qn;
+            }
+            classNames.insert(qn);
+            mClasses.append(cl);
+        }
     }
 }
 
@@ -52,15 +52,16 @@ public:
     static QString shortenFilename(const QString &path);
 
 private:
+    class TypeConversion;
 
     void cleanupUnusedTypes();
     void convertTypes();
 
-    void convertComplexType(const XSD::ComplexType *);
-    void createComplexTypeSerializer(KODE::Class &, const XSD::ComplexType *);
+    void convertComplexType(const XSD::ComplexType *, KODE::Class::List &classes) const;
+    void createComplexTypeSerializer(KODE::Class &, const XSD::ComplexType *) const;
 
-    void convertSimpleType(const XSD::SimpleType *, const XSD::SimpleType::List &simpleTypeList);
-    void createSimpleTypeSerializer(KODE::Class &, const XSD::SimpleType *, const XSD::SimpleType::List &simpleTypeList);
+    void convertSimpleType(const XSD::SimpleType *, const XSD::SimpleType::List &simpleTypeList, KODE::Class::List &classes) const;
+    void createSimpleTypeSerializer(KODE::Class &, const XSD::SimpleType *, const XSD::SimpleType::List &simpleTypeList) const;
 
     // Client Stub
     bool convertClientService();
@@ -71,16 +72,17 @@ private:
     void clientAddArguments(KODE::Function &callFunc, const Message &message, KODE::Class &newClass, const Operation &operation, const Binding &binding);
     bool clientAddAction(KODE::Code &code, const Binding &binding, const QString &operationName);
     void clientGenerateMessage(KODE::Code &code, const Binding &binding, const Message &message, const Operation &operation, bool varsAreMembers = false);
-    void addMessageArgument(KODE::Code &code, const SoapBinding::Style &bindingStyle, const Part &part, const QString &localVariableName, const QByteArray &messageName, bool varIsMember = false);
+    void addMessageArgument(KODE::Code &code, const SoapBinding::Style &bindingStyle, const Part &part, const QString &localVariableName, const QByteArray &messageName, bool varIsMember = false, bool useElementWriter = false);
     void createHeader(const SoapBinding::Header &header, KODE::Class &newClass);
     void addJobResultMember(KODE::Class &jobClass, const Part &part, const QString &varName, const QStringList &inputGetters);
     KODE::Code serializePart(const Part &part, const QString &localVariableName, const QString &varName, bool append);
     KODE::Code demarshalVarHelper(const QName &type, const QName &elementType, const QString &variableName, const QString &qtTypeName, const QString &soapValueVarName, bool optional) const;
     KODE::Code demarshalVar(const QName &type, const QName &elementType, const QString &variableName, const QString &typeName, const QString &soapValueVarName, bool optional, bool usePointer) const;
     KODE::Code demarshalArrayVar(const QName &type, const QString &variableName, const QString &qtTypeName, bool optional) const;
+    KODE::Code demarshalStreamVar(const QName &type, const QString &variableName, const QString &qtTypeName, const QString &textValue, bool optional, bool isList) const;
     void addVariableInitializer(KODE::MemberVariable &variable) const;
-    QString generateMemberVariable(const QString &rawName, const QString &typeName, const QString &inputTypeName, KODE::Class &newClass, XSD::Attribute::AttributeUse, bool usePointer, bool polymorphic);
-    QString listTypeFor(const QString &itemTypeName, KODE::Class &newClass);
+    QString generateMemberVariable(const QString &rawName, const QString &typeName, const QString &inputTypeName, KODE::Class &newClass, XSD::Attribute::AttributeUse, bool usePointer, bool polymorphic) const;
+    QString listTypeFor(const QString &itemTypeName, KODE::Class &newClass) const;
     KODE::Code deserializeRetVal(const KWSDL::Part &part, const QString &replyMsgName, const QString &qtRetType, const QString &varName) const;
     QName elementNameForPart(const Part &part, bool *qualified, bool *nillable) const;
     bool isQualifiedPart(const Part &part) const;
@@ -88,7 +90,7 @@ private:
     // Server Stub
     void convertServerService();
     void generateServerMethod(KODE::Code &code, const Binding &binding, const Operation &operation,
-                              KODE::Class &newClass, bool first);
+                              KODE::Class &newClass);
     void generateDelayedReponseMethod(const QString &methodName, const QString &retInputType,
                                       const Part &retPart, KODE::Class &newClass, const Binding &binding, const Message &outputMessage);
 
@@ -113,6 +113,13 @@ bool Converter::convertClientService()
             newClass.addInclude(QLatin1String("KDSoapClient/KDSoapValue.h"), QLatin1String("KDSoapValue"));
             newClass.addInclude(QLatin1String("KDSoapClient/KDSoapPendingCallWatcher.h"), QLatin1String("KDSoapPendingCallWatcher"));
             newClass.addInclude(QLatin1String("KDSoapClient/KDSoapNamespaceManager.h"));
+            newClass.addInclude(QLatin1String("KDSoapClient/KDSoapBinaryCodec.h"));
+            if (Settings::self()->generateStreamDeserializers()) {
+                newClass.addInclude(QLatin1String("KDSoapClient/KDSoapElementReader.h"));
+            }
+            if (Settings::self()->generateStreamSerializers()) {
+                newClass.addInclude(QLatin1String("KDSoapClient/KDSoapElementWriter.h"));
+            }
 
             // Variables (which will go into the d pointer)
             KODE::MemberVariable clientInterfaceVar(QLatin1String("m_clientInterface"), QLatin1String("KDSoapClientInterface*"));
@@ -319,6 +326,7 @@ bool Converter::convertClientService()
                 KODE::Class jobClass(KODE::Style::className(operation.name()) + QLatin1String("Job"), jobsNamespace);
                 jobClass.addInclude(QString(), fullyQualified(newClass));
                 jobClass.addHeaderInclude(QLatin1String("KDSoapClient/KDSoapJob.h"));
+                jobClass.addInclude(QLatin1String("KDSoapClient/KDSoapBinaryCodec.h"));
                 if (!Settings::self()->exportDeclaration().isEmpty()) {
                     jobClass.setExportDeclaration(Settings::self()->exportDeclaration());
                 }
@@ -527,12 +535,23 @@ QName Converter::elementNameForPart(const Part &part, bool *qualified, bool *nil
     }
 }
 
-void Converter::addMessageArgument(KODE::Code &code, const SoapBinding::Style &bindingStyle, const Part &part, const QString &localVariableName, const QByteArray &messageName, bool varIsMember)
+void Converter::addMessageArgument(KODE::Code &code, const SoapBinding::Style &bindingStyle, const Part &part, const QString &localVariableName, const QByteArray &messageName, bool varIsMember, bool useElementWriter)
 {
     const QString partname = varIsMember ? QLatin1Char('m') + upperlize(localVariableName) : mNameMapper.escape(lowerlize(localVariableName));
     // In document style, the "part" is directly added as arguments
     // See http://www.ibm.com/developerworks/webservices/library/ws-whichwsdl/
     if (bindingStyle == SoapBinding::DocumentStyle) {
+        if (useElementWriter && mTypeMap.isComplexType(part.type(), part.element()) && !mTypeMap.isPolymorphic(part.type(), part.element())) {
+            // The message only holds the element name, the contents are written by the generated writeXmlContents()
+            bool qualified, nillable;
+            const QName elemName = elementNameForPart(part, &qualified, &nillable);
+            const QString messageVar = QString::fromLatin1(messageName);
+            const QString argType = mTypeMap.localType(part.type(), part.element());
+            code += messageVar + QLatin1String(" = KDSoapValue(QString::fromLatin1(\"") + elemName.localName() + QLatin1String("\"), QVariant());") + COMMENT;
+            code += messageVar + QLatin1String(".setNamespaceUri(") + namespaceString(elemName.nameSpace()) + QLatin1String(");");
+            code += messageVar + QLatin1String(".setElementWriter(new KDSoapTypedElementWriter<") + argType + QLatin1String(">(") + partname + QLatin1String("));") + COMMENT;
+            return;
+        }
         code.addBlock(serializePart(part, partname, messageName, false));
     } else {
         const QString argType = mTypeMap.localType(part.type(), part.element());
@@ -563,9 +582,17 @@ void Converter::clientGenerateMessage(KODE::Code &code, const Binding &binding,
 
     bool isBuiltin = false;
 
-    Q_FOREACH (const Part &part, selectedParts(binding, message, operation, true /*input*/)) {
+    // With -stream-serializers, a document/literal complex argument is written straight to the request
+    const Part::List parts = selectedParts(binding, message, operation, true /*input*/);
+    bool useElementWriter = false;
+    if (Settings::self()->generateStreamSerializers() && parts.count() == 1 && binding.type() == Binding::SOAPBinding) {
+        const SoapBinding::Operation op = binding.soapBinding().operations().value(operation.name());
+        useElementWriter = op.input().use() != SoapBinding::EncodedUse;
+    }
+
+    Q_FOREACH (const Part &part, parts) {
         isBuiltin = isBuiltin || mTypeMap.isBuiltinType(part.type(), part.element());
-        addMessageArgument(code, soapStyle(binding), part, part.name(), "message", varsAreMembers);
+        addMessageArgument(code, soapStyle(binding), part, part.name(), "message", varsAreMembers, useElementWriter);
     }
 
     if (soapStyle(binding) == SoapBinding::DocumentStyle && message.parts().size() > 1 && isBuiltin) {
@@ -611,17 +638,31 @@ bool Converter::convertClientCall(const Operation &operation, const Binding &bin
     KODE::Code code;
     const bool hasAction = clientAddAction(code, binding, operation.name());
     clientGenerateMessage(code, binding, inputMessage, operation);
+
+    // Return value(s) :
+    const Part::List outParts = selectedParts(binding, outputMessage, operation, false /*output*/);
+    const int numReturnValues = outParts.count();
+
+    // With -stream-deserializers, a document-style complex return value is read straight from the reply
+    bool readRetValFromStream = false;
+    if (Settings::self()->generateStreamDeserializers() && numReturnValues == 1 && soapStyle(binding) == SoapBinding::DocumentStyle) {
+        const Part retPart = outParts.first();
+        readRetValFromStream = mTypeMap.isComplexType(retPart.type(), retPart.element()) && !mTypeMap.isPolymorphic(retPart.type(), retPart.element());
+    }
+
     QString callLine = QLatin1String("d_ptr->m_lastReply = clientInterface()->call(QLatin1String(\"") + operation.name() + QLatin1String("\"), message");
-    if (hasAction) {
+    if (readRetValFromStream) {
+        const QString retType = mTypeMap.localType(outParts.first().type(), outParts.first().element());
+        code += retType + QLatin1String(" ret;"); // local var
+        code += QLatin1String("KDSoapTypedElementReader<") + retType + QLatin1String("> bodyReader(&ret);") + COMMENT;
+        callLine += hasAction ? QLatin1String(", action") : QLatin1String(", QString()");
+        callLine += QLatin1String(", KDSoapHeaders(), &bodyReader");
+    } else if (hasAction) {
         callLine += QLatin1String(", action");
     }
     callLine += QLatin1String(");");
     code += callLine;
 
-    // Return value(s) :
-    const Part::List outParts = selectedParts(binding, outputMessage, operation, false /*output*/);
-    const int numReturnValues = outParts.count();
-
     if (numReturnValues == 1) {
         const Part retPart = outParts.first();
         const QString retType = mTypeMap.localType(retPart.type(), retPart.element());
@@ -640,7 +681,9 @@ bool Converter::convertClientCall(const Operation &operation, const Binding &bin
         // WARNING: if you change the logic below, also adapt the result parsing for async calls
 
         if (retType != QLatin1String("void")) {
-            if (soapStyle(binding) == SoapBinding::DocumentStyle /*no wrapper*/) {
+            if (readRetValFromStream) {
+                code += QLatin1String("return ret;") + COMMENT; // already read by bodyReader
+            } else if (soapStyle(binding) == SoapBinding::DocumentStyle /*no wrapper*/) {
                 code += retType + QLatin1String(" ret;"); // local var
                 code.addBlock(deserializeRetVal(retPart, QLatin1String("d_ptr->m_lastReply"), retType, QLatin1String("ret")));
                 code += QLatin1String("return ret;") + COMMENT;
@@ -49,7 +49,7 @@ static QString pointerStorageType(const QString &typeName)
     return "QSharedPointer<" + typeName + '>';
 }
 
-void Converter::convertComplexType(const XSD::ComplexType *type)
+void Converter::convertComplexType(const XSD::ComplexType *type, KODE::Class::List &classes) const
 {
     // An empty type is still useful, in document mode: it serializes the element name
     //if ( type->isEmpty() )
@@ -246,11 +246,11 @@ void Converter::convertComplexType(const XSD::ComplexType *type)
     }
 
     newClass.addInclude("QSharedPointer");
-    mClasses.addClass(newClass);
+    classes.addClass(newClass);
 }
 
 // Called for each element and for each attribute of a complex type, as well as for the base class "value".
-QString Converter::generateMemberVariable(const QString &rawName, const QString &typeName, const QString &inputTypeName, KODE::Class &newClass, XSD::Attribute::AttributeUse use, bool usePointer, bool polymorphic)
+QString Converter::generateMemberVariable(const QString &rawName, const QString &typeName, const QString &inputTypeName, KODE::Class &newClass, XSD::Attribute::AttributeUse use, bool usePointer, bool polymorphic) const
 {
     // member variable
     const QString storageType = usePointer ? pointerStorageType(typeName) : typeName;
@@ -366,6 +366,33 @@ QString Converter::generateMemberVariable(const QString &rawName, const QString
     newClass.addFunction(setter);
     newClass.addFunction(getter);
 
+    // For types which aren't passed by value (lists, strings, generated types...),
+    // allow to move values in and out without copying them
+    if (!usePointer && inputTypeName.startsWith(QLatin1String("const "))) {
+        KODE::Function moveSetter(QLatin1String("set") + upperName, QLatin1String("void"), access);
+        moveSetter.addArgument(typeName + QLatin1String("&& ") + argName);
+        moveSetter.setPreprocessorCondition(QLatin1String("Q_COMPILER_RVALUE_REFS"));
+        KODE::Code moveCode;
+        if (optional) {
+            moveCode += variableName + "_nil = false;" + COMMENT;
+        }
+        moveCode += QLatin1String("qSwap(") + variableName + QLatin1String(", ") + argName + QLatin1String(");");
+        moveSetter.setBody(moveCode);
+        newClass.addFunction(moveSetter);
+
+        KODE::Function taker(QLatin1String("take") + upperName, typeName, access);
+        KODE::Code takeCode;
+        takeCode += typeName + QLatin1String(" _result;");
+        takeCode += QLatin1String("qSwap(_result, ") + variableName + QLatin1String(");");
+        if (optional || prohibited) {
+            takeCode += variableName + "_nil = true;" + COMMENT;
+        }
+        takeCode += QLatin1String("return _result;");
+        taker.setBody(takeCode);
+        taker.setDocs(QString::fromLatin1("Returns the %1 and resets it, without copying it.").arg(lowerName));
+        newClass.addFunction(taker);
+    }
+
     return variableName;
 }
 
@@ -382,6 +409,162 @@ static KODE::Code demarshalNameTest(const QName &type, const QString &tagName, b
     return demarshalCode;
 }
 
+namespace
+{
+// One branch of the name dispatch in a deserialize() method
+struct DemarshalCase {
+    QName type;
+    QString name;
+    KODE::Code code;
+};
+}
+
+static bool isAnyCase(const DemarshalCase &demarshalCase)
+{
+    return demarshalCase.type.nameSpace() == XMLSchemaURI && demarshalCase.type.localName() == QLatin1String("any");
+}
+
+static QString charLiteral(ushort ch)
+{
+    if (ch >= 0x20 && ch < 0x7f && ch != '\'' && ch != '\\') {
+        return QLatin1Char('\'') + QChar(ch) + QLatin1Char('\'');
+    }
+    return QLatin1String("0x") + QString::number(ch, 16);
+}
+
+// Above this number of names, dispatch on the name length and first character
+// instead of comparing the name against each element name in turn.
+static const int s_nameSwitchThreshold = 4;
+
+// Helper method for the generation of the deserialize() and readXml() methods:
+// runs the code of the case matching "_name", or defaultCode if none matches
+// and there is no xsd:any case
+static KODE::Code demarshalNameDispatch(const QList<DemarshalCase> &cases, const KODE::Code &defaultCode = KODE::Code())
+{
+    bool hasAnyCase = false;
+    Q_FOREACH (const DemarshalCase &demarshalCase, cases) {
+        hasAnyCase = hasAnyCase || isAnyCase(demarshalCase);
+    }
+    const bool needsDefault = !hasAnyCase && !defaultCode.isEmpty();
+
+    KODE::Code code;
+    if (cases.count() <= s_nameSwitchThreshold) {
+        bool first = true;
+        Q_FOREACH (const DemarshalCase &demarshalCase, cases) {
+            code.addBlock(demarshalNameTest(demarshalCase.type, demarshalCase.name, &first));
+            code.indent();
+            code.addBlock(demarshalCase.code);
+            code.unindent();
+            code += "}";
+        }
+        if (needsDefault) {
+            if (first) {
+                code.addBlock(defaultCode);
+            } else {
+                code += "else {";
+                code.indent();
+                code.addBlock(defaultCode);
+                code.unindent();
+                code += "}";
+            }
+        }
+        return code;
+    }
+
+    // Group the names by length and first character. Within a group, the order
+    // of the cases is kept, so that the first matching element wins, as above.
+    QMap<int, QMap<ushort, QList<int> > > groups;
+    int anyCase = -1;
+    for (int i = 0; i < cases.count(); ++i) {
+        if (isAnyCase(cases.at(i))) {
+            if (anyCase == -1) {
+                anyCase = i;
+            }
+            continue;
+        }
+        const QString &name = cases.at(i).name;
+        groups[name.length()][name.isEmpty() ? 0 : name.at(0).unicode()].append(i);
+    }
+
+    code += QLatin1String("int _nameIndex = -1;") + COMMENT;
+    code += "switch (_name.length()) {";
+    QMap<int, QMap<ushort, QList<int> > >::const_iterator lengthIt = groups.constBegin();
+    for (; lengthIt != groups.constEnd(); ++lengthIt) {
+        code += QLatin1String("case ") + QString::number(lengthIt.key()) + QLatin1Char(':');
+        code.indent();
+        const bool switchOnFirstChar = lengthIt.key() > 0;
+        if (switchOnFirstChar) {
+            code += "switch (_name.at(0).unicode()) {";
+        }
+        QMap<ushort, QList<int> >::const_iterator charIt = lengthIt.value().constBegin();
+        for (; charIt != lengthIt.value().constEnd(); ++charIt) {
+            if (switchOnFirstChar) {
+                code += QLatin1String("case ") + charLiteral(charIt.key()) + QLatin1Char(':');
+                code.indent();
+            }
+            bool first = true;
+            Q_FOREACH (int index, charIt.value()) {
+                code += QString::fromLatin1(first ? "" : "} else ") + QLatin1String("if (_name == QLatin1String(\"") + cases.at(index).name + QLatin1String("\")) {");
+                code.indent();
+                code += QLatin1String("_nameIndex = ") + QString::number(index) + QLatin1Char(';');
+                code.unindent();
+                first = false;
+            }
+            code += "}";
+            if (switchOnFirstChar) {
+                code += "break;";
+                code.unindent();
+            }
+        }
+        if (switchOnFirstChar) {
+            code += "}";
+        }
+        code += "break;";
+        code.unindent();
+    }
+    code += "}";
+
+    code += "switch (_nameIndex) {";
+    for (int i = 0; i < cases.count(); ++i) {
+        if (isAnyCase(cases.at(i))) {
+            if (i != anyCase) {
+                continue; // unreachable, like in the if/else chain
+            }
+            code += "default: {";
+        } else {
+            code += QLatin1String("case ") + QString::number(i) + QLatin1String(": {");
+        }
+        code.indent();
+        code.addBlock(cases.at(i).code);
+        code += "break;";
+        code.unindent();
+        code += "}";
+    }
+    if (needsDefault) {
+        code += "default:";
+        code.indent();
+        code.addBlock(defaultCode);
+        code += "break;";
+        code.unindent();
+    }
+    code += "}";
+    return code;
+}
+
+// Helper method for the generation of the readXml() method: uses the code reading
+// straight from the stream if there is one, otherwise creates "val" and runs
+// the deserialize() code
+static KODE::Code streamOrValueCode(const KODE::Code &streamCode, const QString &valueDeclaration, const KODE::Code &valueCode)
+{
+    if (!streamCode.isEmpty()) {
+        return streamCode;
+    }
+    KODE::Code code;
+    code += valueDeclaration + COMMENT;
+    code.addBlock(valueCode);
+    return code;
+}
+
 // Low-level helper for demarshalVar, doesn't handle the polymorphic case (so it can be called for lists of polymorphics)
 KODE::Code Converter::demarshalVarHelper(const QName &type, const QName &elementType, const QString &variableName, const QString &qtTypeName, const QString &soapValueVarName, bool optional) const
 {
@@ -450,9 +633,64 @@ KODE::Code Converter::demarshalArrayVar(const QName &type, const QString &variab
     return code;
 }
 
-void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::ComplexType *type)
+// Helper method for the generation of the readXml() method: reads the current element
+// (or the attribute) into the variable, without going through a KDSoapValue. textValue is the code
+// returning the text as a QVariant, where %1 is the QVariant type to parse it into.
+// Returns an empty code for the types which can only be deserialized from a KDSoapValue.
+KODE::Code Converter::demarshalStreamVar(const QName &type, const QString &variableName, const QString &qtTypeName, const QString &textValue, bool optional, bool isList) const
+{
+    KODE::Code code;
+    if (mTypeMap.isTypeAny(type) || mTypeMap.isPolymorphic(type)) {
+        return code;
+    }
+    QString target = variableName;
+    if (isList) {
+        target = (variableName.startsWith(QLatin1String("d_ptr->")) ? variableName.mid(7) : variableName) + QLatin1String("Temp");
+        code += qtTypeName + QLatin1String(" ") + target + QLatin1String(";") + COMMENT;
+    }
+    const QString untypedText = textValue.arg(QLatin1String("QVariant::Invalid"));
+    if (mTypeMap.isBuiltinType(type)) {
+        // Numbers, booleans and dates are parsed straight into the right QVariant type
+        const QString metaType = mTypeMap.builtinMetaType(type);
+        if (!metaType.isEmpty()) {
+            code += target + QLatin1String(" = ") + textValue.arg(metaType) + QLatin1String(".value<") + qtTypeName + QLatin1String(">();") + COMMENT;
+        } else {
+            code += target + QLatin1String(" = ") + mTypeMap.deserializeBuiltin(type, QName(), untypedText, qtTypeName) + QLatin1String(";") + COMMENT;
+        }
+    } else if (mTypeMap.isComplexType(type)) {
+        code += target + QLatin1String(".readXml(reader);") + COMMENT;
+    } else {
+        code += target + QLatin1String(".deserialize(") + untypedText + QLatin1String(");") + COMMENT;
+    }
+    if (isList) {
+        code += variableName + QLatin1String(".append(") + target + QLatin1String(");") + COMMENT;
+    }
+    if (optional) {
+        code += variableName + QLatin1String("_nil = false;") + COMMENT;
+    }
+    return code;
+}
+
+// Helper method for the generation of the writeXmlContents() method: wraps the code
+// which fills the KDSoapValueList called listName, for the elements or attributes
+// which can only be written using a KDSoapValue.
+static KODE::Code writeValuesCode(const KODE::Code &valuesCode, const QString &listName, const QString &writeCall)
+{
+    KODE::Code code;
+    code += "{";
+    code.indent();
+    code += QLatin1String("KDSoapValueList ") + listName + QLatin1String(";") + COMMENT;
+    code.addBlock(valuesCode);
+    code += writeCall + COMMENT;
+    code.unindent();
+    code += "}";
+    return code;
+}
+
+void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::ComplexType *type) const
 {
     newClass.addInclude(QLatin1String("KDSoapClient/KDSoapNamespaceManager.h"));
+    newClass.addInclude(QLatin1String("KDSoapClient/KDSoapBinaryCodec.h"));
 
     KODE::Function serializeFunc(QLatin1String("serialize"), QLatin1String("KDSoapValue"));
     serializeFunc.addArgument(QLatin1String("const QString& valueName"));
@@ -467,7 +705,40 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
         deserializeFunc.setVirtualMode(KODE::Function::Virtual);
     }
 
+    KODE::Function readXmlFunc(QLatin1String("readXml"), QLatin1String("void"));
+    readXmlFunc.addArgument(QLatin1String("QXmlStreamReader& reader"));
+    if (!type->derivedTypes().isEmpty()) {
+        readXmlFunc.setVirtualMode(KODE::Function::Virtual);
+    }
+
+    KODE::Function writeXmlFunc(QLatin1String("writeXml"), QLatin1String("void"));
+    writeXmlFunc.addArgument(QLatin1String("QXmlStreamWriter& writer"));
+    writeXmlFunc.addArgument(QLatin1String("const QString& messageNamespace"));
+    writeXmlFunc.addArgument(QLatin1String("const QString& nameSpace"));
+    writeXmlFunc.addArgument(QLatin1String("const QString& valueName"));
+    writeXmlFunc.addArgument(QLatin1String("bool qualified"));
+    writeXmlFunc.setConst(true);
+
+    KODE::Function writeXmlContentsFunc(QLatin1String("writeXmlContents"), QLatin1String("void"));
+    writeXmlContentsFunc.addArgument(QLatin1String("QXmlStreamWriter& writer"));
+    writeXmlContentsFunc.addArgument(QLatin1String("const QString& messageNamespace"));
+    writeXmlContentsFunc.setConst(true);
+    if (!type->derivedTypes().isEmpty()) {
+        writeXmlFunc.setVirtualMode(KODE::Function::Virtual);
+        writeXmlContentsFunc.setVirtualMode(KODE::Function::Virtual);
+    }
+
     KODE::Code marshalCode, demarshalCode;
+    // writeXmlContents() writes the attributes and elements straight to the stream,
+    // unless the type can only be serialized into a KDSoapValue
+    KODE::Code writeElementsCode, writeAttributesCode;
+    // readXml() reads the elements straight from the stream, unless the type
+    // can only be deserialized from a KDSoapValue
+    bool readFromValue = false;
+    QList<DemarshalCase> readElementCases;
+    QList<DemarshalCase> readAttributeCases;
+    const QString readText = QLatin1String("KDSoapElementReader::readText(reader, %1)");
+    const QString readValue = QLatin1String("const KDSoapValue val = KDSoapElementReader::readValue(reader);");
 
     const QString typeArgs = namespaceString(type->nameSpace()) + QLatin1String(", QString::fromLatin1(\"") + type->name() + QLatin1String("\")");
 
@@ -477,6 +748,7 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
         const QString typeName = mTypeMap.localType(baseName);
         KODE::MemberVariable variable(QLatin1String("value"), typeName);
         const QString variableName = QLatin1String("d_ptr->") + variable.name();
+        readFromValue = true;
 
         if (mTypeMap.isComplexType(baseName)) {
             //marshalCode += QLatin1String("KDSoapValue mainValue = ") + variableName + QLatin1String(".serialize(valueName);") + COMMENT;
@@ -524,6 +796,10 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
         if (elements.at(0).isQualified()) {
             marshalCode += QLatin1String("mainValue.setQualified(true);") + COMMENT;
         }
+        if (type->isArray() || (elements.count() == 1 && (elements.at(0).maxOccurs() > 1 || elements.at(0).compositor().maxOccurs() > 1))) {
+            // all children go into the same list, make room for them upfront
+            demarshalCode += QLatin1String("d_ptr->") + KODE::MemberVariable::memberVariableName(elements.at(0).name()) + QLatin1String(".reserve(args.count());") + COMMENT;
+        }
         demarshalCode += "for (int argNr = 0; argNr < args.count(); ++argNr) {";
         demarshalCode.indent();
         demarshalCode += "const KDSoapValue& val = args.at(argNr);";
@@ -544,6 +820,7 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
         const QString typeName = mTypeMap.localType(arrayType);
 
         marshalCode += QLatin1String("args.setArrayType(QString::fromLatin1(\"") + arrayType.nameSpace() + QLatin1String("\"), QString::fromLatin1(\"") + arrayType.localName() + QLatin1String("\"));");
+        marshalCode += QLatin1String("args.reserve(") + variableName + QLatin1String(".count());") + COMMENT;
         marshalCode += QLatin1String("for (int i = 0; i < ") + variableName + QLatin1String(".count(); ++i) {") + COMMENT;
         marshalCode.indent();
         const QString nameSpace = elem.nameSpace();
@@ -560,8 +837,9 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
         marshalCode += '}';
 
         demarshalCode.addBlock(demarshalArrayVar(arrayType, variableName, typeName, isElementOptional(elem)));
+        readFromValue = true;
     } else {
-        bool first = true;
+        QList<DemarshalCase> demarshalCases;
         Q_FOREACH (const XSD::Element &elem, elements) {
 
             const QString elemName = elem.name();
@@ -571,8 +849,10 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
 
             const QString variableName = QLatin1String("d_ptr->") + KODE::MemberVariable::memberVariableName(elemName);
 
-            demarshalCode.addBlock(demarshalNameTest(elem.type(), elemName, &first));
-            demarshalCode.indent();
+            DemarshalCase demarshalCase;
+            demarshalCase.type = elem.type();
+            demarshalCase.name = elemName;
+            DemarshalCase readCase = demarshalCase;
 
             ElementArgumentSerializer serializer(mTypeMap, elem.type(), QName(), variableName);
             serializer.setOutputVariable("args", true);
@@ -585,8 +865,10 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
 
                 QString localVariableName = variableName + QLatin1String(".at(i)");
 
-                marshalCode += QLatin1String("for (int i = 0; i < ") + variableName + QLatin1String(".count(); ++i) {") + COMMENT;
-                marshalCode.indent();
+                KODE::Code elementCode;
+                elementCode += QLatin1String("args.reserve(args.count() + ") + variableName + QLatin1String(".count());") + COMMENT;
+                elementCode += QLatin1String("for (int i = 0; i < ") + variableName + QLatin1String(".count(); ++i) {") + COMMENT;
+                elementCode.indent();
 
                 serializer.setLocalVariableName(localVariableName);
                 if (elem.hasSubstitutions())
@@ -598,11 +880,25 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
                 }
                 serializer.setOmitIfEmpty(false);   // if not set, not in array
 
-                marshalCode.addBlock(serializer.generate());
-                marshalCode.unindent();
-                marshalCode += '}';
+                elementCode.addBlock(serializer.generate());
+                elementCode.unindent();
+                elementCode += '}';
+                marshalCode.addBlock(elementCode);
+
+                const KODE::Code streamCode = serializer.generateStream();
+                if (streamCode.isEmpty()) {
+                    writeElementsCode.addBlock(writeValuesCode(elementCode, QLatin1String("args"), QLatin1String("KDSoapElementWriter::writeElements(writer, messageNamespace, args);")));
+                } else {
+                    writeElementsCode += QLatin1String("for (int i = 0; i < ") + variableName + QLatin1String(".count(); ++i) {") + COMMENT;
+                    writeElementsCode.indent();
+                    writeElementsCode.addBlock(streamCode);
+                    writeElementsCode.unindent();
+                    writeElementsCode += '}';
+                }
 
-                demarshalCode.addBlock(demarshalArrayVar(elem.type(), variableName, typeName, isElementOptional(elem)));
+                demarshalCase.code = demarshalArrayVar(elem.type(), variableName, typeName, isElementOptional(elem));
+                readCase.code = streamOrValueCode(demarshalStreamVar(elem.type(), variableName, typeName, readText, isElementOptional(elem), true),
+                                                  readValue, demarshalCase.code);
             } else {
                 const bool optional = isElementOptional(elem);
                 if (elem.hasSubstitutions())
@@ -615,14 +911,27 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
                 serializer.setOmitIfEmpty(optional);
                 const bool usePointer = usePointerForElement(elem, newClass, mTypeMap, false);
                 serializer.setUsePointer(usePointer);
-                marshalCode.addBlock(serializer.generate());
+                const KODE::Code elementCode = serializer.generate();
+                marshalCode.addBlock(elementCode);
+
+                const KODE::Code streamCode = serializer.generateStream();
+                if (streamCode.isEmpty()) {
+                    writeElementsCode.addBlock(writeValuesCode(elementCode, QLatin1String("args"), QLatin1String("KDSoapElementWriter::writeElements(writer, messageNamespace, args);")));
+                } else {
+                    writeElementsCode.addBlock(streamCode);
+                }
 
-                demarshalCode.addBlock(demarshalVar(elem.type(), QName(), variableName, typeName, "val", optional, usePointer));
+                demarshalCase.code = demarshalVar(elem.type(), QName(), variableName, typeName, "val", optional, usePointer);
+                if (!usePointer) {
+                    readCase.code = demarshalStreamVar(elem.type(), variableName, typeName, readText, optional, false);
+                }
+                readCase.code = streamOrValueCode(readCase.code, readValue, demarshalCase.code);
             }
 
-            demarshalCode.unindent();
-            demarshalCode += "}";
+            demarshalCases.append(demarshalCase);
+            readElementCases.append(readCase);
         } // end: for each element
+        demarshalCode.addBlock(demarshalNameDispatch(demarshalCases));
     }
 
     if (!elements.isEmpty()) {
@@ -640,13 +949,14 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
         demarshalCode += "const KDSoapValue& val = attribs.at(attrNr);";
         demarshalCode += "const QString _name = val.name();";
 
-        bool first = true;
+        QList<DemarshalCase> demarshalCases;
         Q_FOREACH (const XSD::Attribute &attribute, attributes) {
             const QString attrName = attribute.name();
             const QString variableName = QLatin1String("d_ptr->") + KODE::MemberVariable::memberVariableName(attrName);
 
-            demarshalCode.addBlock(demarshalNameTest(attribute.type(), attrName, &first));
-            demarshalCode.indent();
+            DemarshalCase demarshalCase;
+            demarshalCase.type = attribute.type();
+            demarshalCase.name = attrName;
 
             ElementArgumentSerializer serializer(mTypeMap, attribute.type(), QName(), variableName);
             serializer.setElementName(attribute.qualifiedName());
@@ -654,15 +964,28 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
             serializer.setIsQualified(attribute.isQualified());
             serializer.setNillable(false);
             serializer.setOmitIfEmpty(attribute.attributeUse() == XSD::Attribute::Optional || attribute.attributeUse() == XSD::Attribute::Prohibited);
-            marshalCode.addBlock(serializer.generate());
+            const KODE::Code attributeCode = serializer.generate();
+            marshalCode.addBlock(attributeCode);
+
+            const KODE::Code streamCode = serializer.generateStream(true);
+            if (streamCode.isEmpty()) {
+                writeAttributesCode.addBlock(writeValuesCode(attributeCode, QLatin1String("attribs"), QLatin1String("KDSoapElementWriter::writeAttributes(writer, attribs);")));
+            } else {
+                writeAttributesCode.addBlock(streamCode);
+            }
 
             const QString typeName = mTypeMap.localType(attribute.type());
             Q_ASSERT(!typeName.isEmpty());
-            demarshalCode.addBlock(demarshalVar(attribute.type(), QName(), variableName, typeName, "val", attribute.attributeUse() == XSD::Attribute::Optional, false));
-
-            demarshalCode.unindent();
-            demarshalCode += "}";
+            const bool optional = attribute.attributeUse() == XSD::Attribute::Optional;
+            demarshalCase.code = demarshalVar(attribute.type(), QName(), variableName, typeName, "val", optional, false);
+            demarshalCases.append(demarshalCase);
+
+            DemarshalCase readCase = demarshalCase;
+            readCase.code = streamOrValueCode(demarshalStreamVar(attribute.type(), variableName, typeName, "KDSoapElementReader::textToVariant(attribute.value(), %1)", optional, false),
+                                              "const KDSoapValue val(_name, attribute.value().toString());", demarshalCase.code);
+            readAttributeCases.append(readCase);
         }
+        demarshalCode.addBlock(demarshalNameDispatch(demarshalCases));
         marshalCode += QLatin1String("mainValue.childValues().attributes() += attribs;") + COMMENT;
 
         demarshalCode.unindent();
@@ -676,4 +999,85 @@ void Converter::createComplexTypeSerializer(KODE::Class &newClass, const XSD::Co
 
     deserializeFunc.setBody(demarshalCode);
     newClass.addFunction(deserializeFunc);
+
+    if (Settings::self()->generateStreamDeserializers()) {
+        newClass.addHeaderInclude(QLatin1String("KDSoapClient/KDSoapElementReader.h"));
+        KODE::Code readCode;
+        if (readFromValue) {
+            readCode += QLatin1String("deserialize(KDSoapElementReader::readValue(reader));") + COMMENT;
+        } else {
+            if (!attributes.isEmpty()) {
+                readCode += "const QXmlStreamAttributes attributes = reader.attributes();";
+                readCode += "for (int attrNr = 0; attrNr < attributes.count(); ++attrNr) {";
+                readCode.indent();
+                readCode += "const QXmlStreamAttribute& attribute = attributes.at(attrNr);";
+                readCode += "if (KDSoapElementReader::isSoapAttribute(attribute))";
+                readCode.indent();
+                readCode += "continue;";
+                readCode.unindent();
+                readCode += "const QString _name = attribute.name().toString();";
+                readCode.addBlock(demarshalNameDispatch(readAttributeCases));
+                readCode.unindent();
+                readCode += "}";
+            }
+            readCode += "while (reader.readNext() != QXmlStreamReader::Invalid) {";
+            readCode.indent();
+            readCode += "if (reader.isEndElement())";
+            readCode.indent();
+            readCode += "break;";
+            readCode.unindent();
+            readCode += "if (!reader.isStartElement())";
+            readCode.indent();
+            readCode += "continue;";
+            readCode.unindent();
+            KODE::Code skipCode;
+            skipCode += QLatin1String("KDSoapElementReader::skipElement(reader);") + COMMENT;
+            if (elements.isEmpty()) {
+                readCode.addBlock(skipCode);
+            } else {
+                readCode += "const QString _name = reader.name().toString();";
+                readCode.addBlock(demarshalNameDispatch(readElementCases, skipCode));
+            }
+            readCode.unindent();
+            readCode += "}";
+        }
+        readXmlFunc.setBody(readCode);
+        newClass.addFunction(readXmlFunc);
+    }
+
+    if (Settings::self()->generateStreamSerializers()) {
+        newClass.addHeaderInclude(QLatin1String("KDSoapClient/KDSoapElementWriter.h"));
+        KODE::Code writeCode;
+        KODE::Code writeContentsCode;
+        if (readFromValue) {
+            // base types and arrays: same as the KDSoapValue returned by serialize()
+            writeCode += QLatin1String("KDSoapValue value = serialize(valueName);") + COMMENT;
+            writeCode += "value.setNamespaceUri(nameSpace);";
+            writeCode += "if (qualified)";
+            writeCode.indent();
+            writeCode += "value.setQualified(true);";
+            writeCode.unindent();
+            writeCode += "KDSoapValueList values;";
+            writeCode += "values.append(value);";
+            writeCode += QLatin1String("KDSoapElementWriter::writeElements(writer, messageNamespace, values);") + COMMENT;
+            writeContentsCode += QLatin1String("KDSoapElementWriter::writeContents(writer, messageNamespace, serialize(QString()));") + COMMENT;
+        } else {
+            const bool firstElementQualified = !elements.isEmpty() && elements.at(0).isQualified();
+            writeCode += QLatin1String("KDSoapElementWriter::writeStartElement(writer, messageNamespace, nameSpace, valueName, ")
+                         + (firstElementQualified ? QLatin1String("true") : QLatin1String("qualified")) + QLatin1String(");") + COMMENT;
+            writeCode += "writeXmlContents(writer, messageNamespace);";
+            writeCode += "writer.writeEndElement();";
+            // attributes first, QXmlStreamWriter can't add them after child elements
+            writeContentsCode.addBlock(writeAttributesCode);
+            writeContentsCode.addBlock(writeElementsCode);
+            if (writeContentsCode.isEmpty()) {
+                writeContentsCode += "Q_UNUSED(writer);";
+                writeContentsCode += "Q_UNUSED(messageNamespace);";
+            }
+        }
+        writeXmlFunc.setBody(writeCode);
+        newClass.addFunction(writeXmlFunc);
+        writeXmlContentsFunc.setBody(writeContentsCode);
+        newClass.addFunction(writeXmlContentsFunc);
+    }
 }
@@ -4,6 +4,72 @@
 #include <QSet>
 #include <QDebug>
 
+// Returns the C string literal for the given Latin-1 string
+static QString cStringLiteral(const QByteArray &str)
+{
+    QString result = QLatin1String("\"");
+    for (int i = 0; i < str.size(); ++i) {
+        const char ch = str.at(i);
+        if (ch == '"' || ch == '\\') {
+            result += QLatin1Char('\\');
+        }
+        result += QLatin1Char(ch);
+    }
+    return result + QLatin1Char('"');
+}
+
+// Generates a sorted table of (key, operation index) and the binary search
+// storing the index of the operation matching keyVarName into "_operationIndex".
+// When several operations match, the one with the lowest index wins, like
+// in a chain of if/else tests.
+static KODE::Code operationLookup(const QString &tableName, const QString &keyVarName, const QMap<QByteArray, int> &keys)
+{
+    KODE::Code code;
+    if (keys.isEmpty()) {
+        return code;
+    }
+    // QMap iterates in QByteArray order, which is qstrcmp order.
+    code += "static const KDSoapOperationEntry " + tableName + "[] = {";
+    code.indent();
+    QMap<QByteArray, int>::const_iterator it = keys.constBegin();
+    for (; it != keys.constEnd(); ++it) {
+        code += "{ " + cStringLiteral(it.key()) + ", " + QString::number(it.value()) + " },";
+    }
+    code.unindent();
+    code += "};";
+    code += "{";
+    code.indent();
+    code += "int low = 0;";
+    code += "int high = int(sizeof(" + tableName + ") / sizeof(*" + tableName + ")) - 1;";
+    code += "while (low <= high) {";
+    code.indent();
+    code += "const int mid = (low + high) / 2;";
+    code += "const int cmp = qstrcmp(" + keyVarName + ", " + tableName + "[mid].key);";
+    code += "if (cmp == 0) {";
+    code.indent();
+    code += "if (_operationIndex == -1 || " + tableName + "[mid].operation < _operationIndex) {";
+    code.indent();
+    code += "_operationIndex = " + tableName + "[mid].operation;";
+    code.unindent();
+    code += "}";
+    code += "break;";
+    code.unindent();
+    code += "} else if (cmp < 0) {";
+    code.indent();
+    code += "high = mid - 1;";
+    code.unindent();
+    code += "} else {";
+    code.indent();
+    code += "low = mid + 1;";
+    code.unindent();
+    code += "}";
+    code.unindent();
+    code += "}";
+    code.unindent();
+    code += "}";
+    return code;
+}
+
 using namespace KWSDL;
 
 void Converter::convertServerService()
@@ -38,6 +104,9 @@ void Converter::convertServerService()
             serverClass.addHeaderInclude("QtCore/QObject");
             serverClass.addHeaderInclude("KDSoapServer/KDSoapServerObjectInterface.h");
 
+            // Files included in the impl
+            serverClass.addInclude("KDSoapClient/KDSoapBinaryCodec.h");
+
             serverClass.addDeclarationMacro("Q_OBJECT");
             serverClass.addDeclarationMacro("Q_INTERFACES(KDSoapServerObjectInterface)");
 
@@ -53,27 +122,53 @@ void Converter::convertServerService()
 
             PortType portType = mWSDL.findPortType(binding.portTypeName());
             //qDebug() << portType.name();
-            bool first = true;
             const Operation::List operations = portType.operations();
-            Q_FOREACH (const Operation &operation, operations) {
-                const Operation::OperationType opType = operation.operationType();
-                switch (opType) {
-                case Operation::OneWayOperation:
-                case Operation::RequestResponseOperation: // the standard case
-                case Operation::SolicitResponseOperation:
-                case Operation::NotificationOperation:
-                    generateServerMethod(body, binding, operation, serverClass, first);
-                    break;
+
+            // Look up the operation by name and by soap action in sorted tables,
+            // rather than testing each operation in turn.
+            QMap<QByteArray, int> operationNames;
+            QMap<QByteArray, int> soapActions;
+            KODE::Code cases;
+            for (int opNum = 0; opNum < operations.count(); ++opNum) {
+                const Operation &operation = operations.at(opNum);
+                const QByteArray name = operation.name().toLatin1();
+                if (!operationNames.contains(name)) {
+                    operationNames.insert(name, opNum);
                 }
-                first = false;
+                if (binding.type() == Binding::SOAPBinding) {
+                    const SoapBinding soapBinding(binding.soapBinding());
+                    const SoapBinding::Operation op = soapBinding.operations().value(operation.name());
+                    const QByteArray action = op.action().toLatin1();
+                    if (!action.isEmpty() && !soapActions.contains(action)) {
+                        soapActions.insert(action, opNum);
+                    }
+                }
+                cases += "case " + QString::number(opNum) + ": { // " + operation.name();
+                cases.indent();
+                generateServerMethod(cases, binding, operation, serverClass);
+                cases += "break;";
+                cases.unindent();
+                cases += "}";
             }
 
-            if (!first) {
-                body += "else {";
+            if (operations.isEmpty()) {
+                body += "KDSoapServerObjectInterface::processRequest(_request, _response, _soapAction);"  + COMMENT;
+            } else {
+                // Local to processRequest(), so named so that it can't hide a type of the WSDL used in the cases
+                body += "struct KDSoapOperationEntry {";
                 body.indent();
-            }
-            body += "KDSoapServerObjectInterface::processRequest(_request, _response, _soapAction);"  + COMMENT;
-            if (!first) {
+                body += "const char *key;";
+                body += "int operation;";
+                body.unindent();
+                body += "};";
+                body += "int _operationIndex = -1;";
+                body.addBlock(operationLookup("s_operationNames", "method", operationNames));
+                body.addBlock(operationLookup("s_soapActions", "_soapAction", soapActions));
+                body += "switch (_operationIndex) {" + COMMENT;
+                body.addBlock(cases);
+                body += "default:";
+                body.indent();
+                body += "KDSoapServerObjectInterface::processRequest(_request, _response, _soapAction);"  + COMMENT;
                 body.unindent();
                 body += "}";
             }
@@ -86,7 +181,7 @@ void Converter::convertServerService()
     }
 }
 
-void Converter::generateServerMethod(KODE::Code &code, const Binding &binding, const Operation &operation, KODE::Class &newClass, bool first)
+void Converter::generateServerMethod(KODE::Code &code, const Binding &binding, const Operation &operation, KODE::Class &newClass)
 {
     const QString requestVarName = "_request";
     const QString responseVarName = "_response";
@@ -103,17 +198,6 @@ void Converter::generateServerMethod(KODE::Code &code, const Binding &binding, c
     KODE::Function virtualMethod(methodName);
     virtualMethod.setVirtualMode(KODE::Function::PureVirtual);
 
-    QString condition = "method == \"" + operationName + "\"";
-    if (binding.type() == Binding::SOAPBinding) {
-        const SoapBinding soapBinding(binding.soapBinding());
-        const SoapBinding::Operation op = soapBinding.operations().value(operation.name());
-        if (!op.action().isEmpty()) {
-            condition += " || _soapAction == \"" + op.action() + "\"";
-        }
-    }
-    code += QString(first ? "" : "else ") + "if (" + condition + ") {";
-    code.indent();
-
     QStringList inputVars;
     const Part::List parts = message.parts();
     for (int partNum = 0; partNum < parts.count(); ++partNum) {
@@ -193,8 +277,6 @@ void Converter::generateServerMethod(KODE::Code &code, const Binding &binding, c
 
         generateDelayedReponseMethod(methodName, retInputType, retPart, newClass, binding, outputMessage);
     }
-    code.unindent();
-    code += "}";
 
     newClass.addFunction(virtualMethod);
 }
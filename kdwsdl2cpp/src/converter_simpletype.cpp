@@ -28,7 +28,7 @@ void Converter::addVariableInitializer(KODE::MemberVariable &variable) const
     }
 }
 
-QString Converter::listTypeFor(const QString &itemTypeName, KODE::Class &newClass)
+QString Converter::listTypeFor(const QString &itemTypeName, KODE::Class &newClass) const
 {
     if (itemTypeName == QLatin1String("QString")) {
         newClass.addHeaderInclude("QtCore/QStringList");
@@ -42,7 +42,7 @@ QString Converter::listTypeFor(const QString &itemTypeName, KODE::Class &newClas
 // if restricts a basic type or another simple type -> "value" variable
 // else if list -> define a QList
 
-void Converter::convertSimpleType(const XSD::SimpleType *type, const XSD::SimpleType::List &simpleTypeList)
+void Converter::convertSimpleType(const XSD::SimpleType *type, const XSD::SimpleType::List &simpleTypeList, KODE::Class::List &classes) const
 {
     const QString typeName(mTypeMap.localType(type->qualifiedName()));
     //qDebug() << "convertSimpleType:" << type->qualifiedName() << typeName;
@@ -271,10 +271,10 @@ void Converter::convertSimpleType(const XSD::SimpleType *type, const XSD::Simple
     KODE::Function dtor('~' + newClass.name());
     newClass.addFunction(dtor);
 
-    mClasses.addClass(newClass);
+    classes.addClass(newClass);
 }
 
-void Converter::createSimpleTypeSerializer(KODE::Class &newClass, const XSD::SimpleType *type, const XSD::SimpleType::List &simpleTypeList)
+void Converter::createSimpleTypeSerializer(KODE::Class &newClass, const XSD::SimpleType *type, const XSD::SimpleType::List &simpleTypeList) const
 {
     const QString typeName = mTypeMap.localType(type->qualifiedName());
 
@@ -366,6 +366,7 @@ void Converter::createSimpleTypeSerializer(KODE::Class &newClass, const XSD::Sim
             //const QName mostBasicTypeName = simpleTypeList.mostBasicType( baseType );
             //Q_UNUSED(mostBasicTypeName);
             if (mTypeMap.isBuiltinType(baseType)) {     // serialize from QString, int, etc.
+                newClass.addInclude("KDSoapClient/KDSoapBinaryCodec.h");
                 serializeFunc.addBodyLine("return " + mTypeMap.serializeBuiltin(baseType, QName(), variableName, baseTypeName) + ";" + COMMENT);
                 deserializeFunc.addBodyLine(variableName + " = " + mTypeMap.deserializeBuiltin(baseType, QName(), "value", baseTypeName) + ";" + COMMENT);
             } else { // inherits another simple type, need to call its serialize/deserialize method
@@ -47,6 +47,9 @@ void Creator::create(const KODE::Class::List &classes)
     printer.setLabelsDefineIndent(false);
     printer.setIndentLabels(false);
 
+    printer.setImplementationFileCount(Settings::self()->implementationFileCount());
+    printer.setSkipUnchangedFiles(Settings::self()->incremental());
+
     //qDebug() << "Create server=" << Settings::self()->generateServerCode() << "impl=" << Settings::self()->generateImplementation();
 
     KODE::File file;
@@ -132,3 +132,60 @@ KODE::Code ElementArgumentSerializer::generate() const
     return block;
 }
 
+KODE::Code ElementArgumentSerializer::generateStream(bool isAttribute) const
+{
+    Q_ASSERT(!mLocalVarName.isEmpty());
+    KODE::Code block;
+    if (mTypeMap.isTypeAny(mType) || mUsePointer || mTypeMap.isPolymorphic(mType, mElementType)) {
+        return block;
+    }
+    const bool omitIfEmpty = mAppend && mOmitIfEmpty;
+    const bool isComplex = mTypeMap.isComplexType(mType, mElementType);
+    if (isComplex && (mNillable || omitIfEmpty)) {
+        // whether it's nil is only known once the KDSoapValue has been created
+        return block;
+    }
+    const QString nameSpace = mNameNamespace.isEmpty() ? QString::fromLatin1("QString()") : mNameNamespace;
+
+    if (omitIfEmpty) {
+        block += "if (!" + mLocalVarName + "_nil) {";
+        block.indent();
+    }
+    if (isComplex) {
+        block += mLocalVarName + QLatin1String(".writeXml(writer, messageNamespace, ") + nameSpace + QLatin1String(", ") + mNameArg
+                 + QLatin1String(", ") + (mIsQualified ? QLatin1String("true") : QLatin1String("false")) + QLatin1String(");") + COMMENT;
+    } else {
+        const QName actualType = mType.isEmpty() ? mElementType : mType;
+        const QString typeArgs = namespaceString(actualType.nameSpace()) + QLatin1String(", QString::fromLatin1(\"") + actualType.localName() + QLatin1String("\")");
+        QString value;
+        if (mTypeMap.isBuiltinType(mType, mElementType)) {
+            const QString qtTypeName = mTypeMap.localType(mType, mElementType);
+            value = mTypeMap.serializeBuiltin(mType, mElementType, mLocalVarName, qtTypeName);
+        } else {
+            value = mLocalVarName + QLatin1String(".serialize()");
+        }
+        QStringList flags;
+        if (mIsQualified) {
+            flags << QLatin1String("KDSoapElementWriter::Qualified");
+        }
+        if (mNillable && !isAttribute) {
+            flags << QLatin1String("KDSoapElementWriter::Nillable");
+        }
+        if (omitIfEmpty) {
+            flags << QLatin1String("KDSoapElementWriter::OmitIfNil");
+        }
+        const QString flagsArg = flags.isEmpty() ? QString::fromLatin1("0") : flags.join(QLatin1String(" | "));
+        if (isAttribute) {
+            block += QLatin1String("KDSoapElementWriter::writeAttribute(writer, ") + nameSpace + QLatin1String(", ") + mNameArg + QLatin1String(", ") + flagsArg
+                     + QLatin1String(", ") + value + QLatin1String(", ") + typeArgs + QLatin1String(");") + COMMENT;
+        } else {
+            block += QLatin1String("KDSoapElementWriter::writeElement(writer, messageNamespace, ") + nameSpace + QLatin1String(", ") + mNameArg + QLatin1String(", ") + flagsArg
+                     + QLatin1String(", ") + value + QLatin1String(", ") + typeArgs + QLatin1String(");") + COMMENT;
+        }
+    }
+    if (omitIfEmpty) {
+        block.unindent();
+        block += "}";
+    }
+    return block;
+}
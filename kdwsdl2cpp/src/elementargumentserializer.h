@@ -84,6 +84,14 @@ public:
      */
     KODE::Code generate() const;
 
+    /**
+     * Generate the code that writes the element (or the attribute) straight to
+     * the QXmlStreamWriter called "writer", for the writeXml() methods.
+     * @param isAttribute write an attribute rather than an element
+     * @return the generated code, or an empty code if the element can only be written using a KDSoapValue
+     */
+    KODE::Code generateStream(bool isAttribute = false) const;
+
 private:
     const KWSDL::TypeMap &mTypeMap;
     QName mType;
@@ -20,9 +20,12 @@
 #include "compiler.h"
 #include "settings.h"
 
+#include <common/fileprovider.h>
+
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QThreadPool>
 #include <QTimer>
 #include <QCoreApplication>
 #include <QDebug>
@@ -39,6 +42,8 @@ static void showHelp(const char *appName)
             "  -s, -service              name of the service to generate\n"
             "  -o <file>                 generate the header file into <file>\n"
             "  -impl <headerfile>        generate the implementation file, and #include <headerfile>\n"
+            "  -split <n>                with -impl, spread the implementation over <n> files: <file>, then\n"
+            "                            <file> with _2, _3... inserted before the extension\n"
             "  -server                   generate server-side base class, instead of client service\n"
             "  -exportMacro <macroname>  set the export declaration to use for generated classes\n"
             "  -namespace <ns>           put all generated classes into the given C++ namespace\n"
@@ -46,6 +51,22 @@ static void showHelp(const char *appName)
             "                            use <type> as the getter return value for optional elements.\n"
             "                            <type> can be either raw-pointer or boost-optional\n"
             " -keep-unused-types         keep the wsdl unused types to the cpp generation step\n"
+            " -stream-deserializers      generate readXml() methods filling complex types straight from the XML stream,\n"
+            "                            and use them for the results of synchronous document-style calls\n"
+            " -stream-serializers        generate writeXml() methods writing complex types straight to the XML stream,\n"
+            "                            and use them for the requests of document/literal calls\n"
+            " -incremental               don't regenerate the code if the command line, the wsdl file and the files\n"
+            "                            it imports didn't change since the last run (recorded in <file>.stamp),\n"
+            "                            and don't rewrite the output files whose content is the same.\n"
+            "                            <file>.stamp is updated on every run: make it the output of the build rule\n"
+            " -jobs <n>                  number of threads used to generate the code (default: number of cores).\n"
+            "                            The output doesn't depend on it; -jobs 1 disables multithreading\n"
+            " -cache-dir <dir>           keep a copy of the downloaded imports and includes in <dir>, and use it\n"
+            "                            instead of downloading them again\n"
+            " -catalog <file>            OASIS XML catalog mapping the URLs of imports and includes to local files\n"
+            "                            (uri, system, rewriteURI and rewriteSystem entries); can be repeated\n"
+            " -offline                   never download anything: the imports and includes must be local files,\n"
+            "                            mapped by a catalog, or already in the cache directory\n"
             "\n", appName);
 }
 
@@ -63,6 +84,10 @@ int main(int argc, char **argv)
     QString nameSpace;
     Settings::OptionalElementType optionalElementType = Settings::ENone;
     bool keepUnusedTypes = false;
+    bool streamDeserializers = false;
+    bool streamSerializers = false;
+    int implementationFileCount = 1;
+    bool incremental = false;
 
     int arg = 1;
     while (arg < argc) {
@@ -78,6 +103,13 @@ int main(int argc, char **argv)
                 return 1;
             }
             headerFile = QFile::decodeName(argv[arg]);
+        } else if (opt == QLatin1String("-split")) {
+            ++arg;
+            implementationFileCount = argv[arg] ? QByteArray(argv[arg]).toInt() : 0;
+            if (implementationFileCount < 1) {
+                showHelp(argv[0]);
+                return 1;
+            }
         } else if (opt == QLatin1String("-server")) {
             server = true;
         } else if (opt == QLatin1String("-v") || opt == QLatin1String("-version")) {
@@ -125,6 +157,38 @@ int main(int argc, char **argv)
             }
         } else if (opt == QLatin1String("-keep-unused-types")) {
             keepUnusedTypes = true;
+        } else if (opt == QLatin1String("-stream-deserializers")) {
+            streamDeserializers = true;
+        } else if (opt == QLatin1String("-stream-serializers")) {
+            streamSerializers = true;
+        } else if (opt == QLatin1String("-incremental")) {
+            incremental = true;
+        } else if (opt == QLatin1String("-jobs")) {
+            ++arg;
+            const int jobs = argv[arg] ? QByteArray(argv[arg]).toInt() : 0;
+            if (jobs < 1) {
+                showHelp(argv[0]);
+                return 1;
+            }
+            QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+        } else if (opt == QLatin1String("-cache-dir")) {
+            ++arg;
+            if (!argv[arg]) {
+                showHelp(argv[0]);
+                return 1;
+            }
+            FileProvider::setCacheDirectory(QFile::decodeName(argv[arg]));
+        } else if (opt == QLatin1String("-catalog")) {
+            ++arg;
+            if (!argv[arg]) {
+                showHelp(argv[0]);
+                return 1;
+            }
+            if (!FileProvider::loadCatalog(QFile::decodeName(argv[arg]))) {
+                return 1;
+            }
+        } else if (opt == QLatin1String("-offline")) {
+            FileProvider::setOfflineMode(true);
         } else if (!fileName) {
             fileName = argv[arg];
         } else {
@@ -150,6 +214,10 @@ int main(int argc, char **argv)
     Settings::self()->setNameSpace(nameSpace);
     Settings::self()->setOptionalElementType(optionalElementType);
     Settings::self()->setKeepUnusedTypes(keepUnusedTypes);
+    Settings::self()->setGenerateStreamDeserializers(streamDeserializers);
+    Settings::self()->setGenerateStreamSerializers(streamSerializers);
+    Settings::self()->setImplementationFileCount(implementationFileCount);
+    Settings::self()->setIncremental(incremental);
     KWSDL::Compiler compiler;
 
     // so that we have an event loop, for downloads
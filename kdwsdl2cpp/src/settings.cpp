@@ -43,6 +43,10 @@ Settings::Settings()
     mImpl = false;
     mServer = false;
     mKeepUnusedTypes = false;
+    mStreamDeserializers = false;
+    mStreamSerializers = false;
+    mImplementationFileCount = 1;
+    mIncremental = false;
     mOptionalElementType = Settings::ENone;
 }
 
@@ -130,6 +134,26 @@ Settings::OptionalElementType Settings::optionalElementType() const
     return mOptionalElementType;
 }
 
+void Settings::setImplementationFileCount(int count)
+{
+    mImplementationFileCount = count;
+}
+
+int Settings::implementationFileCount() const
+{
+    return mImplementationFileCount;
+}
+
+void Settings::setIncremental(bool b)
+{
+    mIncremental = b;
+}
+
+bool Settings::incremental() const
+{
+    return mIncremental;
+}
+
 void Settings::setKeepUnusedTypes(bool b)
 {
     mKeepUnusedTypes = b;
@@ -140,6 +164,26 @@ bool Settings::keepUnusedTypes() const
     return mKeepUnusedTypes;
 }
 
+void Settings::setGenerateStreamDeserializers(bool b)
+{
+    mStreamDeserializers = b;
+}
+
+bool Settings::generateStreamDeserializers() const
+{
+    return mStreamDeserializers;
+}
+
+void Settings::setGenerateStreamSerializers(bool b)
+{
+    mStreamSerializers = b;
+}
+
+bool Settings::generateStreamSerializers() const
+{
+    return mStreamSerializers;
+}
+
 void Settings::setNamespaceMapping(const NSMapping &namespaceMapping)
 {
     mNamespaceMapping = namespaceMapping;
@@ -39,6 +39,14 @@ public:
     bool generateImplementation() const;
     QString headerFile() const;
 
+    // Number of .cpp files the implementation is split into (see KODE::Printer::implementationFilename)
+    void setImplementationFileCount(int count);
+    int implementationFileCount() const;
+
+    // Skip the run when the inputs didn't change, and only rewrite the output files which changed
+    void setIncremental(bool b);
+    bool incremental() const;
+
     void setGenerateServerCode(bool b);
     bool generateServerCode() const;
 
@@ -59,6 +67,12 @@ public:
     void setKeepUnusedTypes(bool b);
     bool keepUnusedTypes() const;
 
+    void setGenerateStreamDeserializers(bool b);
+    bool generateStreamDeserializers() const;
+
+    void setGenerateStreamSerializers(bool b);
+    bool generateStreamSerializers() const;
+
     // UNUSED
     void setNamespaceMapping(const NSMapping &namespaceMapping);
     NSMapping namespaceMapping() const;
@@ -88,6 +102,10 @@ private:
     bool mServer;
     OptionalElementType mOptionalElementType;
     bool mKeepUnusedTypes;
+    bool mStreamDeserializers;
+    bool mStreamSerializers;
+    int mImplementationFileCount;
+    bool mIncremental;
 };
 
 #endif
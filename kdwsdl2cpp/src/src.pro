@@ -10,6 +10,7 @@ SOURCES = compiler.cpp \
     main.cpp \
     namemapper.cpp \
     settings.cpp \
+    stampfile.cpp \
     typemap.cpp \
     elementargumentserializer.cpp
 HEADERS = compiler.h \
@@ -0,0 +1,125 @@
+/*
+    Copyright (c) 2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "stampfile.h"
+
+#include <common/fileprovider.h>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+
+StampFile::StampFile(const QString &fileName)
+    : mFileName(fileName)
+{
+}
+
+bool StampFile::isUpToDate(const QStringList &outputFiles) const
+{
+    Q_FOREACH (const QString &outputFile, outputFiles) {
+        if (!QFile::exists(outputFile)) {
+            return false;
+        }
+    }
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (file.readLine().trimmed() != settingsHash().toHex()) {
+        return false;
+    }
+
+    // One line per input file: "<sha1> <url>"
+    bool hasInputs = false;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        const int space = line.indexOf(' ');
+        if (space <= 0) {
+            return false;
+        }
+        const QString localFile = FileProvider::localFile(QUrl::fromEncoded(line.mid(space + 1)));
+        if (localFile.isEmpty() || fileHash(localFile).toHex() != line.left(space)) {
+            return false;
+        }
+        hasInputs = true;
+    }
+    return hasInputs;
+}
+
+void StampFile::write() const
+{
+    QByteArray data = settingsHash().toHex() + '\n';
+    Q_FOREACH (const QUrl &url, FileProvider::providedUrls()) {
+        // Downloaded files which weren't cached are gone by now; they make the stamp always out of date
+        const QString localFile = FileProvider::localFile(url);
+        const QByteArray hash = localFile.isEmpty() ? QByteArray("-") : fileHash(localFile).toHex();
+        data += hash + ' ' + url.toEncoded() + '\n';
+    }
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Can't open '%s' for writing.", qPrintable(mFileName));
+        return;
+    }
+    file.write(data);
+}
+
+void StampFile::touch() const
+{
+    // Rewriting the same content works with all Qt versions, unlike setting the date
+    QFile file(mFileName);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning("Can't open '%s' for writing.", qPrintable(mFileName));
+        return;
+    }
+    const QByteArray data = file.readAll();
+    file.seek(0);
+    file.write(data);
+}
+
+QByteArray StampFile::settingsHash()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    Q_FOREACH (const QString &argument, QCoreApplication::arguments()) {
+        hash.addData(argument.toUtf8());
+        hash.addData("\0", 1);
+    }
+    // A new kdwsdl2cpp can generate different code from the same inputs
+    const QFileInfo generator(QCoreApplication::applicationFilePath());
+    hash.addData(QByteArray::number(generator.size()));
+    hash.addData(generator.lastModified().toString(Qt::ISODate).toLatin1());
+    return hash.result();
+}
+
+QByteArray StampFile::fileHash(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (!file.atEnd()) {
+        hash.addData(file.read(64 * 1024));
+    }
+    return hash.result();
+}
@@ -0,0 +1,55 @@
+/*
+    Copyright (c) 2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef STAMPFILE_H
+#define STAMPFILE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+  Records the inputs of a kdwsdl2cpp run: the command line, the generator
+  itself, and the content of every WSDL and schema file it read.
+  In incremental mode, the next run is skipped when none of them changed.
+ */
+class StampFile
+{
+public:
+    explicit StampFile(const QString &fileName);
+
+    // True if the stamp matches the current inputs, and all @p outputFiles exist.
+    // Inputs that are not local files always count as changed.
+    bool isUpToDate(const QStringList &outputFiles) const;
+
+    // Records the current inputs, i.e. the files provided by FileProvider
+    void write() const;
+
+    // Updates the date of the stamp when the run is skipped, so that build
+    // systems using it as the output of kdwsdl2cpp see it as up to date
+    void touch() const;
+
+private:
+    static QByteArray settingsHash();
+    static QByteArray fileHash(const QString &fileName);
+
+    QString mFileName;
+};
+
+#endif
@@ -125,7 +125,17 @@ void TypeMap::addBuiltinType(const char *typeName, const char *localType)
         entry.headers << header;
         entry.headerIncludes << header;
     }
-    mTypeMap.append(entry);
+    addEntry(mTypeMap, mTypeIndex, entry);
+}
+
+void TypeMap::addEntry(QList<Entry> &entries, Index &index, const Entry &entry)
+{
+    // If a name comes up twice, the first entry wins, as it did when the lookups scanned the lists
+    const QName name(entry.nameSpace, entry.typeName);
+    if (!index.contains(name)) {
+        index.insert(name, entries.count());
+    }
+    entries.append(entry);
 }
 
 void TypeMap::setNSManager(NSManager *manager)
@@ -135,13 +145,8 @@ void TypeMap::setNSManager(NSManager *manager)
 
 QList<TypeMap::Entry>::ConstIterator TypeMap::typeEntry(const QName &typeName) const
 {
-    QList<Entry>::ConstIterator it;
-    for (it = mTypeMap.constBegin(); it != mTypeMap.constEnd(); ++it) {
-        if ((*it).typeName == typeName.localName() && (*it).nameSpace == typeName.nameSpace()) {
-            break;
-        }
-    }
-    return it;
+    const Index::ConstIterator it = mTypeIndex.constFind(typeName);
+    return it != mTypeIndex.constEnd() ? mTypeMap.constBegin() + it.value() : mTypeMap.constEnd();
 }
 
 bool TypeMap::isBasicType(const QName &typeName) const
@@ -251,49 +256,32 @@ QStringList TypeMap::headerIncludes(const QName &typeName) const
 
 QString TypeMap::localTypeForAttribute(const QName &typeName) const
 {
-    QList<Entry>::ConstIterator it;
-    for (it = mAttributeMap.constBegin(); it != mAttributeMap.constEnd(); ++it) {
-        if ((*it).typeName == typeName.localName() && (*it).nameSpace == typeName.nameSpace()) {
-            return (*it).localType;
-        }
-    }
-
-    return QString();
+    QList<Entry>::ConstIterator it = attributeEntry(typeName);
+    return it != mAttributeMap.constEnd() ? (*it).localType : QString();
 }
 
 QStringList TypeMap::headersForAttribute(const QName &typeName) const
 {
-    QList<Entry>::ConstIterator it;
-    for (it = mAttributeMap.constBegin(); it != mAttributeMap.constEnd(); ++it) {
-        if ((*it).typeName == typeName.localName() && (*it).nameSpace == typeName.nameSpace()) {
-            return (*it).headers;
-        }
-    }
-
-    return QStringList();
+    QList<Entry>::ConstIterator it = attributeEntry(typeName);
+    return it != mAttributeMap.constEnd() ? (*it).headers : QStringList();
 }
 
 QStringList TypeMap::forwardDeclarationsForAttribute(const QName &typeName) const
 {
-    QList<Entry>::ConstIterator it;
-    for (it = mAttributeMap.constBegin(); it != mAttributeMap.constEnd(); ++it) {
-        if ((*it).typeName == typeName.localName() && (*it).nameSpace == typeName.nameSpace()) {
-            return (*it).forwardDeclarations;
-        }
-    }
-
-    return QStringList();
+    QList<Entry>::ConstIterator it = attributeEntry(typeName);
+    return it != mAttributeMap.constEnd() ? (*it).forwardDeclarations : QStringList();
 }
 
 QList<TypeMap::Entry>::ConstIterator TypeMap::elementEntry(const QName &typeName) const
 {
-    QList<Entry>::ConstIterator it;
-    for (it = mElementMap.constBegin(); it != mElementMap.constEnd(); ++it) {
-        if ((*it).typeName == typeName.localName() && (*it).nameSpace == typeName.nameSpace()) {
-            break;
-        }
-    }
-    return it;
+    const Index::ConstIterator it = mElementIndex.constFind(typeName);
+    return it != mElementIndex.constEnd() ? mElementMap.constBegin() + it.value() : mElementMap.constEnd();
+}
+
+QList<TypeMap::Entry>::ConstIterator TypeMap::attributeEntry(const QName &typeName) const
+{
+    const Index::ConstIterator it = mAttributeIndex.constFind(typeName);
+    return it != mAttributeIndex.constEnd() ? mAttributeMap.constBegin() + it.value() : mAttributeMap.constEnd();
 }
 
 QString TypeMap::localTypeForElement(const QName &elementName) const
@@ -358,7 +346,7 @@ void TypeMap::addSchemaTypes(const XSD::Types &types, const QString &ns)
         //entry.headers << (*simpleIt).name().toLower() + ".h";
         entry.forwardDeclarations << entry.localType;
 
-        mTypeMap.append(entry);
+        addEntry(mTypeMap, mTypeIndex, entry);
     }
 
     foreach (const XSD::ComplexType &complex, types.complexTypes()) {
@@ -384,7 +372,7 @@ void TypeMap::addSchemaTypes(const XSD::Types &types, const QString &ns)
             entry.forwardDeclarations << entry.localType;
         }
 
-        mTypeMap.append(entry);
+        addEntry(mTypeMap, mTypeIndex, entry);
     }
 
     XSD::Attribute::List attributes = types.attributes();
@@ -402,7 +390,7 @@ void TypeMap::addSchemaTypes(const XSD::Types &types, const QString &ns)
         entry.headers << (*attrIt).name().toLower() + "attribute.h";
         entry.forwardDeclarations << entry.localType;
 
-        mAttributeMap.append(entry);
+        addEntry(mAttributeMap, mAttributeIndex, entry);
     }
 
     const XSD::Element::List elements = types.elements();
@@ -440,7 +428,7 @@ void TypeMap::addSchemaTypes(const XSD::Types &types, const QString &ns)
           entry.localType = mNSManager->prefix( entry.nameSpace ).toUpper() + "__" + adaptLocalTypeName( elemIt.name() + "Element" );
         }*/
         //qDebug() << "Adding TypeMap entry for element" << entry.typeName << resolvedType;
-        mElementMap.append(entry);
+        addEntry(mElementMap, mElementIndex, entry);
     }
 }
 
@@ -547,9 +535,9 @@ QString KWSDL::TypeMap::deserializeBuiltin(const QName &typeName, const QName &e
 {
     const QName type = typeName.isEmpty() ? baseTypeForElement(elementName) : typeName;
     if (type.nameSpace() == XMLSchemaURI && type.localName() == "hexBinary") {
-        return "QByteArray::fromHex(" + var + ".toString().toLatin1())";
+        return "KDSoapBinaryCodec::fromHex(" + var + ".toString())";
     } else if (type.nameSpace() == XMLSchemaURI && type.localName() == "base64Binary") {
-        return "QByteArray::fromBase64(" + var + ".toString().toLatin1())";
+        return "KDSoapBinaryCodec::fromBase64(" + var + ".toString())";
     } else if (type.nameSpace() == XMLSchemaURI && type.localName() == "dateTime") {
         Q_ASSERT(qtTypeName == QLatin1String("KDDateTime"));
         return "KDDateTime::fromDateString(" + var + ".toString())";
@@ -560,16 +548,48 @@ QString KWSDL::TypeMap::deserializeBuiltin(const QName &typeName, const QName &e
     }
 }
 
+QString KWSDL::TypeMap::builtinMetaType(const QName &typeName) const
+{
+    if (typeName.nameSpace() != XMLSchemaURI) {
+        return QString();
+    }
+    const QString type = typeName.localName();
+    if (type == "boolean") {
+        return "QVariant::Bool";
+    } else if (type == "int" || type == "short") {
+        return "QVariant::Int";
+    } else if (type == "unsignedInt" || type == "unsignedShort") {
+        return "QVariant::UInt";
+    } else if (type == "long" || type == "integer" || type == "negativeInteger" || type == "nonPositiveInteger") {
+        return "QVariant::LongLong";
+    } else if (type == "unsignedLong" || type == "nonNegativeInteger" || type == "positiveInteger") {
+        return "QVariant::ULongLong";
+    } else if (type == "double") {
+        return "QVariant::Double";
+    } else if (type == "float" || type == "decimal") {
+        return "QMetaType::Float";
+    } else if (type == "date") {
+        return "QVariant::Date";
+    } else if (type == "time") {
+        return "QVariant::Time";
+    } else if (type == "dateTime") {
+        return "qMetaTypeId<KDDateTime>()";
+    }
+    return QString();
+}
+
 QString KWSDL::TypeMap::serializeBuiltin(const QName &typeName, const QName &elementName, const QString &var, const QString &qtTypeName) const
 {
     Q_UNUSED(qtTypeName);
     const QName type = typeName.isEmpty() ? baseTypeForElement(elementName) : typeName;
     // variantToTextValue also has support for calling toHex/toBase64 at runtime, but this fails
     // when the type derives from hexBinary and is named differently, see Telegram testcase.
+    // base64 is its default though, so base64Binary values are kept as QByteArray, which lets
+    // KDSoapClientInterface::setMtomEnabled() send them as attachments.
     if (type.nameSpace() == XMLSchemaURI && type.localName() == "hexBinary") {
-        return "QString::fromLatin1(" + var + ".toHex().constData())";
+        return "KDSoapBinaryCodec::toHex(" + var + ")";
     } else if (type.nameSpace() == XMLSchemaURI && type.localName() == "base64Binary") {
-        return "QString::fromLatin1(" + var + ".toBase64().constData())";
+        return "QVariant(" + var + ")";
     } else if (type.nameSpace() == XMLSchemaURI && type.localName() == "dateTime") {
         return var + ".toDateString()";
     } else if (type.nameSpace() == XMLSchemaURI && type.localName() == "anySimpleType") {
@@ -22,6 +22,7 @@
 #define KWSDL_TYPEMAP_H
 
 #include <QStringList>
+#include <QHash>
 
 #include <common/qname.h>
 #include <schema/types.h>
@@ -110,6 +111,12 @@ public:
     QString deserializeBuiltin(const QName &typeName, const QName &elementName, const QString &var, const QString &qtTypeName) const;
     QString serializeBuiltin(const QName &typeName, const QName &elementName, const QString &var, const QString &qtTypeName) const;
 
+    /**
+     * Return C++ code for the QVariant type which the text of the builtin type @p typeName
+     * can be parsed into directly, e.g. "QVariant::Int", or an empty string.
+     */
+    QString builtinMetaType(const QName &typeName) const;
+
     QString localTypeForAttribute(const QName &typeName) const;
     QStringList headersForAttribute(const QName &typeName) const;
     QStringList forwardDeclarationsForAttribute(const QName &typeName) const;
@@ -145,13 +152,22 @@ private:
         QString dumpBools() const;
     };
 
+    typedef QHash<QName, int> Index;
+    static void addEntry(QList<Entry> &entries, Index &index, const Entry &entry);
+
     QList<Entry>::ConstIterator typeEntry(const QName &typeName) const;
     QList<Entry>::ConstIterator elementEntry(const QName &typeName) const;
+    QList<Entry>::ConstIterator attributeEntry(const QName &typeName) const;
 
     QList<Entry> mTypeMap;
     QList<Entry> mElementMap;
     QList<Entry> mAttributeMap;
 
+    // Position of the first entry for each name in the lists above, for the lookups
+    Index mTypeIndex;
+    Index mElementIndex;
+    Index mAttributeIndex;
+
     NSManager *mNSManager;
 };
 
@@ -25,11 +25,11 @@
 #include <QFile>
 #include <QUrl>
 
-#include <QXmlSimpleReader>
 #include <common/nsmanager.h>
 #include <common/fileprovider.h>
 #include <common/messagehandler.h>
 #include <common/parsercontext.h>
+#include <common/xmlelementreader.h>
 
 #include <wsdl/port.h>
 
@@ -133,57 +133,64 @@ Type Definitions::type() const
     return mType;
 }
 
-bool Definitions::loadXML(ParserContext *context, const QDomElement &element)
+bool Definitions::loadXML(ParserContext *context, XmlElementReader &reader)
 {
+    const QDomElement element = reader.element();
     setTargetNamespace(element.attribute(QLatin1String("targetNamespace")));
     mName = element.attribute(QLatin1String("name"));
 
     context->namespaceManager()->enterChild(element);
 
-    QDomElement child = element.firstChildElement();
-    while (!child.isNull()) {
-        NSManager namespaceManager(context, child);
-        const QName tagName(child.tagName());
+    // Only the children of <definitions> are loaded into memory, one at a time;
+    // <types> is streamed further down to the individual schema definitions.
+    while (reader.readNextStartElement()) {
+        NSManager namespaceManager(context, reader.element());
+        const QName tagName(reader.element().tagName());
         if (tagName.localName() == QLatin1String("import")) {
             QString oldTn = targetNamespace();
             QString oldName = mName;
-            importDefinition(context, child.attribute(QLatin1String("location")));
+            importDefinition(context, reader.element().attribute(QLatin1String("location")));
             setTargetNamespace(oldTn);
             mName = oldName;
+            reader.skipCurrentElement();
         } else if (tagName.localName() == QLatin1String("types")) {
-            if (!mType.loadXML(context, child)) {
+            if (!mType.loadXML(context, reader)) {
                 return false;
             }
         } else if (tagName.localName() == QLatin1String("message")) {
             Message message(mTargetNamespace);
-            message.loadXML(context, child);
+            message.loadXML(context, reader.readElement());
             //qDebug() << "Definitions: found message" << message.name() << message.nameSpace();
             mMessages.append(message);
         } else if (tagName.localName() == QLatin1String("portType")) {
             PortType portType(mTargetNamespace);
-            portType.loadXML(context, child);
+            portType.loadXML(context, reader.readElement());
             mPortTypes.append(portType);
         } else if (tagName.localName() == QLatin1String("binding")) {
             Binding binding(mTargetNamespace);
-            binding.loadXML(context, child);
+            binding.loadXML(context, reader.readElement());
             mBindings.append(binding);
         } else if (tagName.localName() == QLatin1String("service")) {
-            const QString name = child.attribute(QLatin1String("name"));
+            const QString name = reader.element().attribute(QLatin1String("name"));
             //qDebug() << "Service:" << name << "looking for" << mWantedService;
             // is this the service we want?
             if (mWantedService.isEmpty() || mWantedService == name) {
                 Service service(mTargetNamespace);
-                service.loadXML(context, &mBindings, child);
+                service.loadXML(context, &mBindings, reader.readElement());
                 mServices.append(service);
+            } else {
+                reader.skipCurrentElement();
             }
         } else if (tagName.localName() == QLatin1String("documentation")) {
             // ignore documentation for now
+            reader.skipCurrentElement();
         } else {
-            context->messageHandler()->warning(QString::fromLatin1("Definitions: unknown tag %1").arg(child.tagName()));
+            context->messageHandler()->warning(QString::fromLatin1("Definitions: unknown tag %1 at (%2, %3)").arg(reader.element().tagName())
+                                               .arg(reader.elementLineNumber()).arg(reader.elementColumnNumber()));
+            reader.skipCurrentElement();
         }
-        child = child.nextSiblingElement();
     }
-    return true;
+    return !reader.hasError();
 }
 
 void Definitions::fixUpDefinitions(/*ParserContext *context, const QDomElement &element */)
@@ -240,21 +247,14 @@ void Definitions::importDefinition(ParserContext *context, const QString &locati
             return;
         }
 
-        QXmlInputSource source(&file);
-        QXmlSimpleReader reader;
-        reader.setFeature(QLatin1String("http://xml.org/sax/features/namespace-prefixes"), true);
-
-        QDomDocument doc(QLatin1String("kwsdl"));
-        QString errorMsg;
-        int errorLine, errorColumn;
-        bool ok = doc.setContent(&source, &reader, &errorMsg, &errorLine, &errorColumn);
-        if (!ok) {
-            qDebug("Error[%d:%d] %s", errorLine, errorColumn, qPrintable(errorMsg));
+        XmlElementReader reader(&file);
+        if (!reader.readNextStartElement()) {
+            qDebug("Error[%d:%d] %s", reader.lineNumber(), reader.columnNumber(), qPrintable(reader.errorString()));
             return;
         }
 
         // prepare the new context to avoid infinite recursion
-        QDomElement rootNode = doc.documentElement();
+        QDomElement rootNode = reader.element();
         NSManager namespaceManager(context, rootNode);
 
         const QName tagName(rootNode.tagName());
@@ -265,7 +265,10 @@ void Definitions::importDefinition(ParserContext *context, const QString &locati
             const QUrl oldBaseUrl = context->documentBaseUrl();
             context->setDocumentBaseUrlFromFileUrl(locationUrl);
 
-            loadXML(context, rootNode);
+            loadXML(context, reader);
+            if (reader.hasError()) {
+                qDebug("Error[%d:%d] %s", reader.lineNumber(), reader.columnNumber(), qPrintable(reader.errorString()));
+            }
 
             context->setDocumentBaseUrl(oldBaseUrl);
 
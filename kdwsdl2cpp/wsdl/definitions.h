@@ -36,6 +36,7 @@
 #include <kode_export.h>
 
 class ParserContext;
+class XmlElementReader;
 
 namespace KWSDL
 {
@@ -72,7 +73,8 @@ public:
     void setType(const Type &type);
     Type type() const;
 
-    bool loadXML(ParserContext *context, const QDomElement &element);
+    // Reads the <definitions> element the reader is positioned on
+    bool loadXML(ParserContext *context, XmlElementReader &reader);
     //void saveXML( ParserContext *context, QDomDocument &document ) const;
 
     void fixUpDefinitions(/*ParserContext *context, const QDomElement &element*/);
@@ -22,6 +22,7 @@
 #include <common/messagehandler.h>
 #include <common/nsmanager.h>
 #include <common/parsercontext.h>
+#include <common/xmlelementreader.h>
 
 #include <schema/parser.h>
 
@@ -54,21 +55,24 @@ XSD::Types Type::types() const
     return mTypes;
 }
 
-bool Type::loadXML(ParserContext *context, const QDomElement &element)
+bool Type::loadXML(ParserContext *context, XmlElementReader &reader)
 {
     XSD::Parser parser(context, nameSpace());
-    QDomElement child = element.firstChildElement();
-    while (!child.isNull()) {
+    while (reader.readNextStartElement()) {
+        const QDomElement child = reader.element();
         NSManager namespaceManager(context, child);
         if (namespaceManager.nameSpace(child) == XSD::Parser::schemaUri() &&
                 namespaceManager.localName(child) == QLatin1String("schema")) {
             //qDebug() << "Loading schema" << nameSpace();
-            if (!parser.parseSchemaTag(context, child)) {
+            if (!parser.parseSchemaTag(context, reader)) {
                 return false;
             }
+        } else {
+            reader.skipCurrentElement();
         }
-
-        child = child.nextSiblingElement();
+    }
+    if (reader.hasError()) {
+        return false;
     }
     if (!parser.resolveForwardDeclarations()) {
         return false;
@@ -30,6 +30,7 @@
 #include <kode_export.h>
 
 class ParserContext;
+class XmlElementReader;
 
 namespace KWSDL
 {
@@ -44,7 +45,8 @@ public:
     void setTypes(const XSD::Types &types);
     XSD::Types types() const;
 
-    bool loadXML(ParserContext *context, const QDomElement &element);
+    // Reads the <types> element the reader is positioned on
+    bool loadXML(ParserContext *context, XmlElementReader &reader);
     void saveXML(ParserContext *context, QDomDocument &document, QDomElement &parent) const;
 
 private:
@@ -21,6 +21,7 @@
 **
 **********************************************************************/
 #include "KDDateTime.h"
+#include "KDDateTime_p.h"
 #include <QSharedData>
 #include <QDebug>
 
@@ -74,6 +75,11 @@ void KDDateTime::setTimeZone(const QString &timeZone)
         setTimeSpec(Qt::LocalTime);
     } else {
         setTimeSpec(Qt::OffsetFromUTC);
+        int offset;
+        if (KDDateTimeFormat::parseTimeZone(timeZone.constData(), timeZone.size(), &offset)) {
+            setUtcOffset(offset);
+            return;
+        }
         const int pos = timeZone.indexOf(QLatin1Char(':'));
         if (pos > 0) {
             const int hours = timeZone.left(pos).toInt();
@@ -84,7 +90,10 @@ void KDDateTime::setTimeZone(const QString &timeZone)
     }
 }
 
-KDDateTime KDDateTime::fromDateString(const QString &s)
+Q_GLOBAL_STATIC_WITH_ARGS(QString, s_utcTimeZone, (QLatin1String("Z")))
+
+// For the forms which KDDateTimeFormat doesn't handle, like years with more than 4 digits
+static KDDateTime fromDateStringSlow(const QString &s)
 {
     KDDateTime kdt;
     QString tz;
@@ -105,18 +114,221 @@ KDDateTime KDDateTime::fromDateString(const QString &s)
     return kdt;
 }
 
-QString KDDateTime::toDateString() const
+KDDateTime KDDateTime::fromDateString(const QString &s)
+{
+    const QChar *str = s.constData();
+    int length = s.size();
+    int timeZoneLength = 0;
+    if (length > 0 && str[length - 1] == QLatin1Char('Z')) {
+        timeZoneLength = 1;
+    } else if (length > 6 && (str[length - 6] == QLatin1Char('+') || str[length - 6] == QLatin1Char('-'))) {
+        timeZoneLength = 6;
+    }
+    length -= timeZoneLength;
+
+    QDate date;
+    QTime time(0, 0);
+    int offset = 0;
+    if (!KDDateTimeFormat::parseDate(str, qMin(length, int(KDDateTimeFormat::MaxDateLength)), &date) ||
+            (length > KDDateTimeFormat::MaxDateLength && (str[KDDateTimeFormat::MaxDateLength] != QLatin1Char('T') ||
+                    !KDDateTimeFormat::parseTime(str + KDDateTimeFormat::MaxDateLength + 1, length - KDDateTimeFormat::MaxDateLength - 1, &time))) ||
+            (timeZoneLength && !KDDateTimeFormat::parseTimeZone(str + length, timeZoneLength, &offset))) {
+        return fromDateStringSlow(s);
+    }
+
+    // Create the QDateTime with the right spec directly, changing it afterwards is slow
+    if (timeZoneLength == 0) {
+        return KDDateTime(QDateTime(date, time));
+    }
+#if QT_VERSION >= 0x050200
+    KDDateTime kdt(timeZoneLength == 1 ? QDateTime(date, time, Qt::UTC) : QDateTime(date, time, Qt::OffsetFromUTC, offset));
+#else
+    QDateTime dateTime(date, time, Qt::UTC);
+    if (timeZoneLength > 1) {
+        dateTime.setUtcOffset(offset);
+    }
+    KDDateTime kdt(dateTime);
+#endif
+    kdt.d->mTimeZone = timeZoneLength == 1 ? *s_utcTimeZone() : QString(str + length, timeZoneLength);
+    return kdt;
+}
+
+// For the values which KDDateTimeFormat doesn't handle
+static QString toDateStringSlow(const KDDateTime &dateTime)
 {
     QString str;
-    if (time().msec()) {
+    if (dateTime.time().msec()) {
         // include milli-seconds
-        str = toString(QLatin1String("yyyy-MM-ddThh:mm:ss.zzz"));
-        str += d->mTimeZone;
+        str = dateTime.toString(QLatin1String("yyyy-MM-ddThh:mm:ss.zzz"));
+        str += dateTime.timeZone();
     } else {
-        str = toString(Qt::ISODate);
+        str = dateTime.toString(Qt::ISODate);
 #if QT_VERSION < 0x040800 // Qt adds the timezone since 4.8
-        str += d->mTimeZone;
+        str += dateTime.timeZone();
 #endif
     }
     return str;
 }
+
+QString KDDateTime::toDateString() const
+{
+    QChar buffer[KDDateTimeFormat::MaxDateLength + 1 + KDDateTimeFormat::MaxTimeLength + KDDateTimeFormat::MaxTimeZoneLength];
+    int length = KDDateTimeFormat::writeDate(date(), buffer);
+    if (length == 0 || !time().isValid()) {
+        return toDateStringSlow(*this);
+    }
+    buffer[length++] = QLatin1Char('T');
+    const bool withMilliSeconds = time().msec() != 0;
+    length += KDDateTimeFormat::writeTime(time(), withMilliSeconds, buffer + length);
+#if QT_VERSION >= 0x040800
+    if (!withMilliSeconds) {
+        // Like Qt::ISODate, which adds the timezone since 4.8
+        switch (timeSpec()) {
+        case Qt::LocalTime:
+            break;
+        case Qt::UTC:
+            buffer[length++] = QLatin1Char('Z');
+            break;
+        default:
+#if QT_VERSION >= 0x050200
+            length += KDDateTimeFormat::writeTimeZone(offsetFromUtc(), buffer + length);
+#else
+            length += KDDateTimeFormat::writeTimeZone(utcOffset(), buffer + length);
+#endif
+            break;
+        }
+        return QString(buffer, length);
+    }
+#endif
+    const QString &timeZone = d->mTimeZone;
+    if (timeZone.size() > KDDateTimeFormat::MaxTimeZoneLength) {
+        return QString(buffer, length) + timeZone;
+    }
+    for (int i = 0; i < timeZone.size(); ++i) {
+        buffer[length++] = timeZone.at(i);
+    }
+    return QString(buffer, length);
+}
+
+static inline bool readDigits(const QChar *str, int count, int *value)
+{
+    int result = 0;
+    for (int i = 0; i < count; ++i) {
+        const ushort c = str[i].unicode();
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        result = result * 10 + (c - '0');
+    }
+    *value = result;
+    return true;
+}
+
+static inline void writeDigits(int value, int count, QChar *out)
+{
+    for (int i = count - 1; i >= 0; --i) {
+        out[i] = QChar(ushort('0' + value % 10));
+        value /= 10;
+    }
+}
+
+bool KDDateTimeFormat::parseDate(const QChar *str, int length, QDate *date)
+{
+    int year, month, day;
+    if (length != MaxDateLength || str[4] != QLatin1Char('-') || str[7] != QLatin1Char('-') ||
+            !readDigits(str, 4, &year) || !readDigits(str + 5, 2, &month) || !readDigits(str + 8, 2, &day)) {
+        return false;
+    }
+    *date = QDate(year, month, day);
+    return date->isValid();
+}
+
+bool KDDateTimeFormat::parseTime(const QChar *str, int length, QTime *time)
+{
+    int hours, minutes, seconds;
+    if (length < 8 || str[2] != QLatin1Char(':') || str[5] != QLatin1Char(':') ||
+            !readDigits(str, 2, &hours) || !readDigits(str + 3, 2, &minutes) || !readDigits(str + 6, 2, &seconds)) {
+        return false;
+    }
+    int msecs = 0;
+    if (length > 8) {
+        if (length == 9 || str[8] != QLatin1Char('.')) {
+            return false;
+        }
+        // Round to milliseconds, like Qt::ISODate does
+        int scale = 100;
+        for (int i = 9; i < length; ++i) {
+            int digit;
+            if (!readDigits(str + i, 1, &digit)) {
+                return false;
+            }
+            if (scale > 0) {
+                msecs += digit * scale;
+                scale /= 10;
+            } else if (i == 12 && digit >= 5) {
+                msecs = qMin(msecs + 1, 999);
+            }
+        }
+    }
+    *time = QTime(hours, minutes, seconds, msecs);
+    return time->isValid();
+}
+
+bool KDDateTimeFormat::parseTimeZone(const QChar *str, int length, int *offset)
+{
+    if (length == 1 && str[0] == QLatin1Char('Z')) {
+        *offset = 0;
+        return true;
+    }
+    int hours, minutes;
+    if (length != MaxTimeZoneLength || (str[0] != QLatin1Char('+') && str[0] != QLatin1Char('-')) || str[3] != QLatin1Char(':') ||
+            !readDigits(str + 1, 2, &hours) || !readDigits(str + 4, 2, &minutes) || minutes > 59) {
+        return false;
+    }
+    *offset = hours * 3600 + minutes * 60;
+    if (str[0] == QLatin1Char('-')) {
+        *offset = -*offset;
+    }
+    return true;
+}
+
+int KDDateTimeFormat::writeDate(const QDate &date, QChar *out)
+{
+    if (!date.isValid() || date.year() < 0 || date.year() > 9999) {
+        return 0;
+    }
+    writeDigits(date.year(), 4, out);
+    out[4] = QLatin1Char('-');
+    writeDigits(date.month(), 2, out + 5);
+    out[7] = QLatin1Char('-');
+    writeDigits(date.day(), 2, out + 8);
+    return MaxDateLength;
+}
+
+int KDDateTimeFormat::writeTime(const QTime &time, bool withMilliSeconds, QChar *out)
+{
+    if (!time.isValid()) {
+        return 0;
+    }
+    writeDigits(time.hour(), 2, out);
+    out[2] = QLatin1Char(':');
+    writeDigits(time.minute(), 2, out + 3);
+    out[5] = QLatin1Char(':');
+    writeDigits(time.second(), 2, out + 6);
+    if (!withMilliSeconds) {
+        return 8;
+    }
+    out[8] = QLatin1Char('.');
+    writeDigits(time.msec(), 3, out + 9);
+    return MaxTimeLength;
+}
+
+int KDDateTimeFormat::writeTimeZone(int offset, QChar *out)
+{
+    out[0] = offset < 0 ? QLatin1Char('-') : QLatin1Char('+');
+    offset = qAbs(offset) / 60;
+    writeDigits(offset / 60, 2, out + 1);
+    out[3] = QLatin1Char(':');
+    writeDigits(offset % 60, 2, out + 4);
+    return MaxTimeZoneLength;
+}
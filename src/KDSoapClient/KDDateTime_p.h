@@ -0,0 +1,55 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDDATETIME_P_H
+#define KDDATETIME_P_H
+
+#include <QtCore/QDateTime>
+
+/**
+ * \internal
+ * Parsers and formatters for the fixed formats of xsd:date, xsd:time and xsd:dateTime,
+ * working on raw characters so that converting large numbers of values doesn't allocate.
+ * The parsers return false for anything else than the usual forms, in which case the callers
+ * fall back to the more lenient QDateTime::fromString().
+ */
+class KDDateTimeFormat
+{
+public:
+    // "yyyy-MM-dd"
+    static bool parseDate(const QChar *str, int length, QDate *date);
+    // "hh:mm:ss", optionally followed by fractional seconds, which are rounded to milliseconds
+    static bool parseTime(const QChar *str, int length, QTime *time);
+    // "Z", "+hh:mm" or "-hh:mm"; the offset is in seconds
+    static bool parseTimeZone(const QChar *str, int length, int *offset);
+
+    // The writers return the number of characters written, or 0 if the value can't be
+    // written in the fixed format (invalid, or a year outside of 0-9999).
+    static const int MaxDateLength = 10;
+    static int writeDate(const QDate &date, QChar *out);
+    static const int MaxTimeLength = 12;
+    static int writeTime(const QTime &time, bool withMilliSeconds, QChar *out);
+    static const int MaxTimeZoneLength = 6;
+    static int writeTimeZone(int offset, QChar *out);
+};
+
+#endif // KDDATETIME_P_H
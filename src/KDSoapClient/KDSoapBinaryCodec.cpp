@@ -0,0 +1,235 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapBinaryCodec.h"
+#include "KDSoapBinaryCodec_p.h"
+#include <QIODevice>
+
+static const char s_base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char s_hexDigits[] = "0123456789abcdef";
+
+// Value of each Latin-1 character in base64, -1 for the characters which aren't part of it
+static const signed char s_base64Values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+static inline int base64Value(QChar ch)
+{
+    const ushort c = ch.unicode();
+    return c < 256 ? s_base64Values[c] : -1;
+}
+
+static inline int base64Value(char ch)
+{
+    return s_base64Values[uchar(ch)];
+}
+
+static inline int hexValue(QChar ch)
+{
+    const ushort c = ch.unicode();
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+QString KDSoapBinaryCodec::toBase64(const QByteArray &data)
+{
+    const uchar *in = reinterpret_cast<const uchar *>(data.constData());
+    const int size = data.size();
+    QString result;
+    result.resize((size + 2) / 3 * 4);
+    QChar *out = result.data();
+    int i = 0;
+    // Three bytes give four characters, without any branch
+    for (; i + 2 < size; i += 3) {
+        const uint triple = (uint(in[i]) << 16) | (uint(in[i + 1]) << 8) | in[i + 2];
+        out[0] = QLatin1Char(s_base64Alphabet[triple >> 18]);
+        out[1] = QLatin1Char(s_base64Alphabet[(triple >> 12) & 0x3f]);
+        out[2] = QLatin1Char(s_base64Alphabet[(triple >> 6) & 0x3f]);
+        out[3] = QLatin1Char(s_base64Alphabet[triple & 0x3f]);
+        out += 4;
+    }
+    if (i < size) {
+        const bool twoBytes = i + 1 < size;
+        const uint triple = (uint(in[i]) << 16) | (twoBytes ? uint(in[i + 1]) << 8 : 0);
+        out[0] = QLatin1Char(s_base64Alphabet[triple >> 18]);
+        out[1] = QLatin1Char(s_base64Alphabet[(triple >> 12) & 0x3f]);
+        out[2] = twoBytes ? QLatin1Char(s_base64Alphabet[(triple >> 6) & 0x3f]) : QLatin1Char('=');
+        out[3] = QLatin1Char('=');
+    }
+    return result;
+}
+
+QByteArray KDSoapBinaryCodec::fromBase64(const QString &text)
+{
+    QByteArray result;
+    result.resize(text.size() * 3 / 4);
+    KDSoapBase64Decoder decoder;
+    result.truncate(decoder.decode(text.constData(), text.size(), result.data()));
+    return result;
+}
+
+KDSoapBase64Decoder::KDSoapBase64Decoder()
+    : m_buffer(0), m_bits(0)
+{
+}
+
+// Shared by the QChar and the char versions of KDSoapBase64Decoder::decode()
+template <typename Char>
+static int decodeBase64(const Char *in, int size, char *out, uint &bufferState, int &bitsState)
+{
+    char *const begin = out;
+    uint buffer = bufferState;
+    int bits = bitsState;
+    int i = 0;
+    while (i < size) {
+        // Four valid characters give three bytes
+        if (bits == 0 && i + 3 < size) {
+            const int a = base64Value(in[i]);
+            const int b = base64Value(in[i + 1]);
+            const int c = base64Value(in[i + 2]);
+            const int d = base64Value(in[i + 3]);
+            if ((a | b | c | d) >= 0) {
+                const uint triple = (uint(a) << 18) | (uint(b) << 12) | (uint(c) << 6) | uint(d);
+                out[0] = char(triple >> 16);
+                out[1] = char(triple >> 8);
+                out[2] = char(triple);
+                out += 3;
+                i += 4;
+                continue;
+            }
+        }
+        // Padding, line breaks, or anything else: skip the invalid characters one by one
+        const int value = base64Value(in[i++]);
+        if (value >= 0) {
+            buffer = (buffer << 6) | uint(value);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                *out++ = char(buffer >> bits);
+                buffer &= (1 << bits) - 1;
+            }
+        }
+    }
+    bufferState = buffer;
+    bitsState = bits;
+    return int(out - begin);
+}
+
+template <typename Char>
+static bool decodeBase64(KDSoapBase64Decoder &decoder, const Char *in, int size, QIODevice *device)
+{
+    static const int s_blockSize = 64 * 1024; // characters
+    QByteArray block;
+    block.resize(s_blockSize * 3 / 4 + 1);
+    while (size > 0) {
+        const int length = qMin(size, s_blockSize);
+        const int written = decoder.decode(in, length, block.data());
+        if (device->write(block.constData(), written) != written) {
+            return false;
+        }
+        in += length;
+        size -= length;
+    }
+    return true;
+}
+
+int KDSoapBase64Decoder::decode(const QChar *in, int size, char *out)
+{
+    return decodeBase64(in, size, out, m_buffer, m_bits);
+}
+
+int KDSoapBase64Decoder::decode(const char *in, int size, char *out)
+{
+    return decodeBase64(in, size, out, m_buffer, m_bits);
+}
+
+bool KDSoapBase64Decoder::decode(const QStringRef &text, QIODevice *device)
+{
+    return decodeBase64(*this, text.unicode(), text.size(), device);
+}
+
+bool KDSoapBase64Decoder::decode(const char *text, int length, QIODevice *device)
+{
+    return decodeBase64(*this, text, length, device);
+}
+
+QString KDSoapBinaryCodec::toHex(const QByteArray &data)
+{
+    const uchar *in = reinterpret_cast<const uchar *>(data.constData());
+    const int size = data.size();
+    QString result;
+    result.resize(size * 2);
+    QChar *out = result.data();
+    for (int i = 0; i < size; ++i) {
+        out[0] = QLatin1Char(s_hexDigits[in[i] >> 4]);
+        out[1] = QLatin1Char(s_hexDigits[in[i] & 0xf]);
+        out += 2;
+    }
+    return result;
+}
+
+QByteArray KDSoapBinaryCodec::fromHex(const QString &text)
+{
+    const QChar *in = text.constData();
+    const int size = text.size();
+    QByteArray result;
+    result.resize((size + 1) / 2);
+    uchar *begin = reinterpret_cast<uchar *>(result.data());
+    uchar *out = begin + result.size();
+    // From the end, like QByteArray::fromHex(), so that an odd digit count gives a leading 0 nibble
+    bool lowNibble = true;
+    for (int i = size - 1; i >= 0; --i) {
+        const int value = hexValue(in[i]);
+        if (value == -1) {
+            continue;
+        }
+        if (lowNibble) {
+            *--out = uchar(value);
+        } else {
+            *out |= uchar(value << 4);
+        }
+        lowNibble = !lowNibble;
+    }
+    result.remove(0, int(out - begin));
+    return result;
+}
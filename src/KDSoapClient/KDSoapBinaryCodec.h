@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPBINARYCODEC_H
+#define KDSOAPBINARYCODEC_H
+
+#include "KDSoapGlobal.h"
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+/**
+ * Conversions between binary data and the text of xsd:base64Binary and xsd:hexBinary values.
+ *
+ * Unlike QByteArray::toBase64() followed by QString::fromLatin1(), these write the
+ * characters straight into the resulting QString, and read them straight from it,
+ * which avoids a full copy of large documents sent as binary data.
+ * They are used by KDSoapValue and by the code generated by kdwsdl2cpp.
+ *
+ * \since 1.7
+ */
+class KDSOAP_EXPORT KDSoapBinaryCodec //krazy:exclude=dpointer
+{
+public:
+    /**
+     * Returns \p data encoded in base64, with padding.
+     */
+    static QString toBase64(const QByteArray &data);
+    /**
+     * Decodes the base64 \p text. Like QByteArray::fromBase64(), invalid characters are ignored.
+     */
+    static QByteArray fromBase64(const QString &text);
+    /**
+     * Returns \p data encoded in lowercase hexadecimal.
+     */
+    static QString toHex(const QByteArray &data);
+    /**
+     * Decodes the hexadecimal \p text. Like QByteArray::fromHex(), invalid characters are ignored.
+     */
+    static QByteArray fromHex(const QString &text);
+
+private:
+    KDSoapBinaryCodec();
+};
+
+#endif // KDSOAPBINARYCODEC_H
@@ -0,0 +1,67 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPBINARYCODEC_P_H
+#define KDSOAPBINARYCODEC_P_H
+
+#include <QtCore/QString>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/**
+ * \internal
+ * Base64 decoder for text which comes in several parts, such as the
+ * text chunks of a large element in a QXmlStreamReader.
+ */
+class KDSoapBase64Decoder
+{
+public:
+    KDSoapBase64Decoder();
+
+    /**
+     * Decodes the next \p length characters of the text into \p out, which must have room
+     * for length * 3 / 4 + 1 bytes. Returns the number of bytes written.
+     */
+    int decode(const QChar *text, int length, char *out);
+    /**
+     * Same, for text in an ASCII compatible encoding, such as UTF-8.
+     */
+    int decode(const char *text, int length, char *out);
+
+    /**
+     * Decodes the next part of the text and writes it to \p device, in blocks.
+     * Returns false if writing failed.
+     */
+    bool decode(const QStringRef &text, QIODevice *device);
+    /**
+     * Same, for text in an ASCII compatible encoding, such as UTF-8.
+     */
+    bool decode(const char *text, int length, QIODevice *device);
+
+private:
+    uint m_buffer;
+    int m_bits;
+};
+
+#endif // KDSOAPBINARYCODEC_P_H
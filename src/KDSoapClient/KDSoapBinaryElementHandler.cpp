@@ -0,0 +1,88 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapBinaryElementHandler.h"
+#include "KDSoapNamespaceManager.h"
+#include "KDSoapValue.h"
+#include <QSet>
+#include <QPair>
+#include <QTemporaryFile>
+
+class KDSoapBinaryElementHandler::Private
+{
+public:
+    Private()
+        : m_handleBase64Type(false)
+    {
+    }
+
+    QSet<QPair<QString, QString> > m_elements;
+    bool m_handleBase64Type;
+};
+
+KDSoapBinaryElementHandler::KDSoapBinaryElementHandler()
+    : d(new Private)
+{
+}
+
+KDSoapBinaryElementHandler::~KDSoapBinaryElementHandler()
+{
+    delete d;
+}
+
+void KDSoapBinaryElementHandler::addElement(const QString &nameSpace, const QString &name)
+{
+    d->m_elements.insert(qMakePair(nameSpace, name));
+}
+
+void KDSoapBinaryElementHandler::setHandleBase64Type(bool enabled)
+{
+    d->m_handleBase64Type = enabled;
+}
+
+bool KDSoapBinaryElementHandler::handlesElement(const QString &nameSpace, const QString &name, const QString &typeNameSpace, const QString &type) const
+{
+    if (d->m_handleBase64Type && type == QLatin1String("base64Binary") &&
+            (typeNameSpace == KDSoapNamespaceManager::xmlSchema2001() || typeNameSpace == KDSoapNamespaceManager::xmlSchema1999())) {
+        return true;
+    }
+    return d->m_elements.contains(qMakePair(nameSpace, name));
+}
+
+QIODevice *KDSoapBinaryElementHandler::createDevice(const QString &nameSpace, const QString &name, const QString &typeNameSpace, const QString &type)
+{
+    if (!handlesElement(nameSpace, name, typeNameSpace, type)) {
+        return 0;
+    }
+    QTemporaryFile *file = new QTemporaryFile;
+    if (!file->open()) {
+        qWarning("KDSoapBinaryElementHandler: couldn't create a temporary file for %s", qPrintable(name));
+        delete file;
+        return 0;
+    }
+    return file;
+}
+
+QSharedPointer<QIODevice> KDSoapBinaryElementHandler::device(const KDSoapValue &value)
+{
+    return value.value().value<QSharedPointer<QIODevice> >();
+}
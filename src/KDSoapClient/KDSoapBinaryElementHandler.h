@@ -0,0 +1,119 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPBINARYELEMENTHANDLER_H
+#define KDSOAPBINARYELEMENTHANDLER_H
+
+#include "KDSoapGlobal.h"
+#include <QtCore/QString>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QIODevice>
+#include <QtCore/QMetaType>
+
+class KDSoapValue;
+
+/**
+ * KDSoapBinaryElementHandler decodes the content of large base64Binary elements of
+ * a reply into a QIODevice while the reply is parsed, instead of keeping the text
+ * and then the decoded data in memory.
+ *
+ * The elements to handle are selected by name, or by their xsi:type. For each of them,
+ * createDevice() is called; the default implementation writes into a QTemporaryFile.
+ * The value of the element in the KDSoapValue tree then only holds the device, which
+ * is returned by device(). The code generated by kdwsdl2cpp sees an empty QByteArray.
+ *
+ * For replies encoded in UTF-8 (the default) or ASCII, the text of these elements is
+ * decoded straight from the reply when it is large, in blocks of 64 KB: the memory used
+ * while parsing doesn't depend on the size of the elements. The reply itself is still
+ * received into memory. Replies in other encodings are converted to text first.
+ *
+ * A handler can't be combined with the stream deserializers of kdwsdl2cpp
+ * (KDSoapClientInterface::call() with a KDSoapElementReader), which read the
+ * body themselves: such replies are turned into a fault instead.
+ *
+ * \code
+ * KDSoapBinaryElementHandler handler;
+ * handler.addElement(QString::fromLatin1("http://www.example.com/documents"), QString::fromLatin1("content"));
+ * client.setBinaryElementHandler(&handler);
+ * const KDSoapMessage reply = client.call(QLatin1String("getDocument"), message);
+ * QSharedPointer<QIODevice> content = KDSoapBinaryElementHandler::device(reply.childValues().child(QLatin1String("content")));
+ * \endcode
+ *
+ * \see KDSoapClientInterface::setBinaryElementHandler()
+ * \since 1.7
+ */
+class KDSOAP_EXPORT KDSoapBinaryElementHandler
+{
+public:
+    /**
+     * Constructs a handler which doesn't handle any element yet.
+     */
+    KDSoapBinaryElementHandler();
+    /**
+     * Destructor. The devices which were created remain owned by the values.
+     */
+    virtual ~KDSoapBinaryElementHandler();
+
+    /**
+     * Decodes the elements called \p name in the namespace \p nameSpace into devices.
+     */
+    void addElement(const QString &nameSpace, const QString &name);
+
+    /**
+     * Decodes all the elements with xsi:type="xsd:base64Binary" into devices.
+     */
+    void setHandleBase64Type(bool enabled);
+
+    /**
+     * Returns true if the element \p name in \p nameSpace, whose xsi:type is
+     * \p type in \p typeNameSpace (empty if it has none), should be decoded into a device.
+     */
+    bool handlesElement(const QString &nameSpace, const QString &name, const QString &typeNameSpace, const QString &type) const;
+
+    /**
+     * Returns the device which the decoded content of the element \p name in \p nameSpace
+     * is written to, opened for writing, or 0 to read the element as usual.
+     * The ownership of the device is passed to the KDSoapValue of the element.
+     *
+     * The default implementation returns a new QTemporaryFile when handlesElement() is true.
+     * Reimplement it to write into other devices.
+     */
+    virtual QIODevice *createDevice(const QString &nameSpace, const QString &name, const QString &typeNameSpace, const QString &type);
+
+    /**
+     * Returns the device which the content of \p value was decoded into,
+     * or a null pointer if the value wasn't handled by a KDSoapBinaryElementHandler.
+     * The device is positioned at the end of the data, call reset() before reading it.
+     */
+    static QSharedPointer<QIODevice> device(const KDSoapValue &value);
+
+private:
+    Q_DISABLE_COPY(KDSoapBinaryElementHandler)
+    class Private;
+    Private *const d;
+};
+
+#if QT_VERSION < 0x050000 // declared by Qt for all QObject subclasses since Qt 5
+Q_DECLARE_METATYPE(QSharedPointer<QIODevice>)
+#endif
+
+#endif // KDSOAPBINARYELEMENTHANDLER_H
@@ -24,14 +24,22 @@ INSTALLHEADERS = KDSoapMessage.h \
     KDDateTime.h \
     KDSoapFaultException.h \
     KDSoapMessageAddressingProperties.cpp \
-    KDSoapEndpointReference.cpp
+    KDSoapEndpointReference.cpp \
+    KDSoapElementReader.h \
+    KDSoapElementWriter.h \
+    KDSoapBinaryCodec.h \
+    KDSoapBinaryElementHandler.h
 PRIVATEHEADERS = KDSoapPendingCall_p.h \
     KDSoapPendingCallWatcher_p.h \
     KDSoapClientInterface_p.h \
     KDSoapClientThread_p.h \
     KDSoapMessageReader_p.h \
     KDSoapMessageWriter_p.h \
-    KDSoapNamespacePrefixes_p.h
+    KDSoapNamespacePrefixes_p.h \
+    KDSoapValueArena_p.h \
+    KDDateTime_p.h \
+    KDSoapBinaryCodec_p.h \
+    KDSoapMtomPackage_p.h
 HEADERS = $$INSTALLHEADERS \
     $$PRIVATEHEADERS \
     KDSoapReplySslHandler_p.h \
@@ -54,7 +62,12 @@ SOURCES = KDSoapMessage.cpp \
     KDSoapReplySslHandler.cpp \
     KDSoapFaultException.cpp \
     KDSoapMessageAddressingProperties.cpp \
-    KDSoapEndpointReference.cpp
+    KDSoapEndpointReference.cpp \
+    KDSoapElementReader.cpp \
+    KDSoapElementWriter.cpp \
+    KDSoapBinaryCodec.cpp \
+    KDSoapBinaryElementHandler.cpp \
+    KDSoapMtomPackage.cpp
 DEFINES += KDSOAP_BUILD_KDSOAP_LIB
 
 # installation targets:
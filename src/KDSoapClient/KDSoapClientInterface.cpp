@@ -24,6 +24,8 @@
 #include "KDSoapClientInterface_p.h"
 #include "KDSoapNamespaceManager.h"
 #include "KDSoapMessageWriter_p.h"
+#include "KDSoapMtomPackage_p.h"
+#include "KDSoapPendingCall_p.h"
 #ifndef QT_NO_OPENSSL
 #include "KDSoapSslHandler.h"
 #include "KDSoapReplySslHandler_p.h"
@@ -66,7 +68,10 @@ KDSoapClientInterfacePrivate::KDSoapClientInterfacePrivate()
       m_authentication(),
       m_version(KDSoapClientInterface::SOAP1_1),
       m_style(KDSoapClientInterface::RPCStyle),
-      m_ignoreSslErrors(false)
+      m_ignoreSslErrors(false),
+      m_arenaAllocation(false),
+      m_binaryElementHandler(0),
+      m_mtomEnabled(false)
 {
 #ifndef QT_NO_OPENSSL
     m_sslHandler = 0;
@@ -139,12 +144,21 @@ QNetworkRequest KDSoapClientInterfacePrivate::prepareRequest(const QString &meth
     return request;
 }
 
-QBuffer *KDSoapClientInterfacePrivate::prepareRequestBuffer(const QString &method, const KDSoapMessage &message, const KDSoapHeaders &headers)
+QBuffer *KDSoapClientInterfacePrivate::prepareRequestBuffer(const QString &method, const KDSoapMessage &message, const KDSoapHeaders &headers, QNetworkRequest &request)
 {
     KDSoapMessageWriter msgWriter;
     msgWriter.setMessageNamespace(m_messageNamespace);
     msgWriter.setVersion(m_version);
-    const QByteArray data = msgWriter.messageToXml(message, (m_style == KDSoapClientInterface::RPCStyle) ? method : QString(), headers, m_persistentHeaders);
+    KDSoapMtomPackage mtomPackage;
+    if (m_mtomEnabled) {
+        msgWriter.setMtomPackage(&mtomPackage);
+    }
+    QByteArray data = msgWriter.messageToXml(message, (m_style == KDSoapClientInterface::RPCStyle) ? method : QString(), headers, m_persistentHeaders);
+    if (m_mtomEnabled) {
+        const QByteArray soapContentType = request.header(QNetworkRequest::ContentTypeHeader).toByteArray();
+        data = mtomPackage.toMultipart(data, soapContentType);
+        request.setHeader(QNetworkRequest::ContentTypeHeader, mtomPackage.contentType(soapContentType));
+    }
     QBuffer *buffer = new QBuffer;
     buffer->setData(data);
     buffer->open(QIODevice::ReadOnly);
@@ -153,15 +167,24 @@ QBuffer *KDSoapClientInterfacePrivate::prepareRequestBuffer(const QString &metho
 
 KDSoapPendingCall KDSoapClientInterface::asyncCall(const QString &method, const KDSoapMessage &message, const QString &soapAction, const KDSoapHeaders &headers)
 {
-    QBuffer *buffer = d->prepareRequestBuffer(method, message, headers);
     QNetworkRequest request = d->prepareRequest(method, soapAction);
+    QBuffer *buffer = d->prepareRequestBuffer(method, message, headers, request);
     //qDebug() << "post()";
     QNetworkReply *reply = d->accessManager()->post(request, buffer);
     d->setupReply(reply);
-    return KDSoapPendingCall(reply, buffer);
+    KDSoapPendingCall pendingCall(reply, buffer);
+    pendingCall.d->arenaAllocation = d->m_arenaAllocation;
+    pendingCall.d->binaryElementHandler = d->m_binaryElementHandler;
+    return pendingCall;
 }
 
 KDSoapMessage KDSoapClientInterface::call(const QString &method, const KDSoapMessage &message, const QString &soapAction, const KDSoapHeaders &headers)
+{
+    return call(method, message, soapAction, headers, 0);
+}
+
+KDSoapMessage KDSoapClientInterface::call(const QString &method, const KDSoapMessage &message, const QString &soapAction, const KDSoapHeaders &headers,
+        KDSoapElementReader *bodyReader)
 {
     d->accessManager()->cookieJar(); // create it in the right thread, the secondary thread will use it
     // Problem is: I don't want a nested event loop here. Too dangerous for GUI programs.
@@ -169,6 +192,7 @@ KDSoapMessage KDSoapClientInterface::call(const QString &method, const KDSoapMes
     // So the only option that remains is a thread and acquiring a semaphore...
     KDSoapThreadTaskData *task = new KDSoapThreadTaskData(this, method, message, soapAction, headers);
     task->m_authentication = d->m_authentication;
+    task->m_bodyReader = bodyReader;
     d->m_thread.enqueue(task);
     if (!d->m_thread.isRunning()) {
         d->m_thread.start();
@@ -182,8 +206,8 @@ KDSoapMessage KDSoapClientInterface::call(const QString &method, const KDSoapMes
 
 void KDSoapClientInterface::callNoReply(const QString &method, const KDSoapMessage &message, const QString &soapAction, const KDSoapHeaders &headers)
 {
-    QBuffer *buffer = d->prepareRequestBuffer(method, message, headers);
     QNetworkRequest request = d->prepareRequest(method, soapAction);
+    QBuffer *buffer = d->prepareRequestBuffer(method, message, headers, request);
     QNetworkReply *reply = d->accessManager()->post(request, buffer);
     d->setupReply(reply);
     QObject::connect(reply, SIGNAL(finished()), reply, SLOT(deleteLater()));
@@ -215,6 +239,36 @@ void KDSoapClientInterface::setHeader(const QString &name, const KDSoapMessage &
     d->m_persistentHeaders[name].setQualified(true);
 }
 
+void KDSoapClientInterface::setArenaAllocation(bool enabled)
+{
+    d->m_arenaAllocation = enabled;
+}
+
+bool KDSoapClientInterface::arenaAllocation() const
+{
+    return d->m_arenaAllocation;
+}
+
+void KDSoapClientInterface::setBinaryElementHandler(KDSoapBinaryElementHandler *handler)
+{
+    d->m_binaryElementHandler = handler;
+}
+
+KDSoapBinaryElementHandler *KDSoapClientInterface::binaryElementHandler() const
+{
+    return d->m_binaryElementHandler;
+}
+
+void KDSoapClientInterface::setMtomEnabled(bool enabled)
+{
+    d->m_mtomEnabled = enabled;
+}
+
+bool KDSoapClientInterface::isMtomEnabled() const
+{
+    return d->m_mtomEnabled;
+}
+
 void KDSoapClientInterface::ignoreSslErrors()
 {
     d->m_ignoreSslErrors = true;
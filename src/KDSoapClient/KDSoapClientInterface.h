@@ -29,6 +29,8 @@
 #include "KDSoapPendingCall.h"
 
 class KDSoapAuthentication;
+class KDSoapElementReader;
+class KDSoapBinaryElementHandler;
 class KDSoapSslHandler;
 class KDSoapClientInterfacePrivate;
 QT_BEGIN_NAMESPACE
@@ -157,6 +159,22 @@ public:
                        const QString &soapAction = QString(),
                        const KDSoapHeaders &headers = KDSoapHeaders());
 
+    /**
+     * Calls the method \p method on this interface, and lets \p bodyReader read the element
+     * returned in the body of the reply straight from the XML stream.
+     *
+     * The returned message then only has the name and namespace of that element, no child values.
+     * Faults are parsed as usual, and returned in the message.
+     * \p bodyReader is called from the thread performing the call, and must stay alive until this returns.
+     * This can't be combined with setBinaryElementHandler(): the reply is then a fault.
+     *
+     * This is used by the code generated with kdwsdl2cpp -stream-deserializers.
+     * \since 1.7
+     */
+    KDSoapMessage call(const QString &method, const KDSoapMessage &message,
+                       const QString &soapAction, const KDSoapHeaders &headers,
+                       KDSoapElementReader *bodyReader);
+
     /**
      * Calls the method \p method on this interface and passes the parameters specified in \p message
      * to the method.
@@ -287,6 +305,56 @@ public:
      */
     KDSoapHeaders lastResponseHeaders() const;
 
+    /**
+     * Sets whether the values of the replies are allocated from a few large memory blocks,
+     * rather than with one allocation per value. This makes parsing and destroying large
+     * replies faster, but the memory used by a reply is only released once all the values
+     * coming from it have been destroyed, so don't keep small parts of large replies around.
+     * Disabled by default.
+     * \since 1.7
+     */
+    void setArenaAllocation(bool enabled);
+
+    /**
+     * Returns whether the values of the replies are allocated from large memory blocks.
+     * \since 1.7
+     */
+    bool arenaAllocation() const;
+
+    /**
+     * Sets the handler which decodes the large base64Binary elements of the replies
+     * into devices while they are parsed, rather than into the KDSoapValue tree.
+     * The handler must remain valid while calls are made; 0 (the default) disables it.
+     * \see KDSoapBinaryElementHandler
+     * \since 1.7
+     */
+    void setBinaryElementHandler(KDSoapBinaryElementHandler *handler);
+
+    /**
+     * Returns the handler set by setBinaryElementHandler().
+     * \since 1.7
+     */
+    KDSoapBinaryElementHandler *binaryElementHandler() const;
+
+    /**
+     * Sets whether the requests are sent with MTOM (SOAP Message Transmission Optimization Mechanism):
+     * the QByteArray values, except the hexBinary ones, are then sent as raw binary attachments
+     * of a multipart/related message, rather than as base64 text inside of the envelope.
+     * Only enable this if the server supports MTOM. Disabled by default.
+     *
+     * Replies sent with MTOM are always understood, whether this is enabled or not;
+     * their attachments are written into the device of the KDSoapBinaryElementHandler, if any,
+     * and otherwise become the same base64 text values as without MTOM.
+     * \since 1.7
+     */
+    void setMtomEnabled(bool enabled);
+
+    /**
+     * Returns whether the requests are sent with MTOM.
+     * \since 1.7
+     */
+    bool isMtomEnabled() const;
+
     /**
      * Asks Qt to ignore ssl errors in https requests. Use this for testing
      * only!
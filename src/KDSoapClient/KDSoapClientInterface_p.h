@@ -36,6 +36,7 @@ class QBuffer;
 QT_END_NAMESPACE
 class KDSoapMessage;
 class KDSoapNamespacePrefixes;
+class KDSoapBinaryElementHandler;
 
 class KDSoapClientInterfacePrivate : public QObject
 {
@@ -56,6 +57,9 @@ public:
     KDSoapClientInterface::SoapVersion m_version;
     KDSoapClientInterface::Style m_style;
     bool m_ignoreSslErrors;
+    bool m_arenaAllocation;
+    KDSoapBinaryElementHandler *m_binaryElementHandler;
+    bool m_mtomEnabled;
     KDSoapHeaders m_lastResponseHeaders;
 #ifndef QT_NO_OPENSSL
     QList<QSslError> m_ignoreErrorsList;
@@ -65,7 +69,7 @@ public:
 
     QNetworkAccessManager *accessManager();
     QNetworkRequest prepareRequest(const QString &method, const QString &action);
-    QBuffer *prepareRequestBuffer(const QString &method, const KDSoapMessage &message, const KDSoapHeaders &headers);
+    QBuffer *prepareRequestBuffer(const QString &method, const KDSoapMessage &message, const KDSoapHeaders &headers, QNetworkRequest &request);
     void writeElementContents(KDSoapNamespacePrefixes &namespacePrefixes, QXmlStreamWriter &writer, const KDSoapValue &element, KDSoapMessage::Use use);
     void writeChildren(KDSoapNamespacePrefixes &namespacePrefixes, QXmlStreamWriter &writer, const KDSoapValueList &args, KDSoapMessage::Use use);
     void writeAttributes(QXmlStreamWriter &writer, const QList<KDSoapValue> &attributes);
@@ -27,6 +27,7 @@
 #include "KDSoapClientInterface.h"
 #include "KDSoapClientInterface_p.h"
 #include "KDSoapPendingCall.h"
+#include "KDSoapPendingCall_p.h"
 #include <QNetworkRequest>
 #include <QNetworkProxy>
 #include <QBuffer>
@@ -99,11 +100,14 @@ void KDSoapThreadTask::process(QNetworkAccessManager &accessManager)
 
     accessManager.setProxy(m_data->m_iface->d->accessManager()->proxy());
 
-    QBuffer *buffer = m_data->m_iface->d->prepareRequestBuffer(m_data->m_method, m_data->m_message, m_data->m_headers);
     QNetworkRequest request = m_data->m_iface->d->prepareRequest(m_data->m_method, m_data->m_action);
+    QBuffer *buffer = m_data->m_iface->d->prepareRequestBuffer(m_data->m_method, m_data->m_message, m_data->m_headers, request);
     QNetworkReply *reply = accessManager.post(request, buffer);
     m_data->m_iface->d->setupReply(reply);
     KDSoapPendingCall pendingCall(reply, buffer);
+    pendingCall.d->bodyReader = m_data->m_bodyReader;
+    pendingCall.d->arenaAllocation = m_data->m_iface->d->m_arenaAllocation;
+    pendingCall.d->binaryElementHandler = m_data->m_iface->d->m_binaryElementHandler;
 
     KDSoapPendingCallWatcher *watcher = new KDSoapPendingCallWatcher(pendingCall, this);
     connect(watcher, SIGNAL(finished(KDSoapPendingCallWatcher*)),
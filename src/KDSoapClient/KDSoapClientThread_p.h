@@ -34,6 +34,7 @@
 #include <QtNetwork/QNetworkAccessManager>
 
 class KDSoapPendingCallWatcher;
+class KDSoapElementReader;
 class KDSoapClientInterface;
 QT_BEGIN_NAMESPACE
 class QEventLoop;
@@ -43,7 +44,7 @@ class KDSoapThreadTaskData
 {
 public:
     KDSoapThreadTaskData(KDSoapClientInterface *iface, const QString &method, const KDSoapMessage &message, const QString &action, const KDSoapHeaders &headers)
-        : m_iface(iface), m_method(method), m_message(message), m_action(action), m_headers(headers) {}
+        : m_iface(iface), m_method(method), m_message(message), m_action(action), m_headers(headers), m_bodyReader(0) {}
 
     void waitForCompletion()
     {
@@ -67,6 +68,7 @@ public:
     KDSoapMessage m_response;
     KDSoapHeaders m_responseHeaders;
     KDSoapHeaders m_headers;
+    KDSoapElementReader *m_bodyReader;
 };
 
 class KDSoapThreadTask : public QObject
@@ -0,0 +1,96 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapElementReader.h"
+#include "KDSoapMessageReader_p.h"
+#include "KDSoapNamespaceManager.h"
+
+KDSoapElementReader::~KDSoapElementReader()
+{
+}
+
+QVariant KDSoapElementReader::readText(QXmlStreamReader &reader)
+{
+    // Like KDSoapMessageReader, keep the last text chunk only, and ignore child elements
+    QString text;
+    while (reader.readNext() != QXmlStreamReader::Invalid) {
+        if (reader.isEndElement()) {
+            break;
+        }
+        if (reader.isCharacters()) {
+            text = reader.text().toString();
+        } else if (reader.isStartElement()) {
+            skipElement(reader);
+        }
+    }
+    if (text.isEmpty()) {
+        return QVariant();
+    }
+    return QVariant(text);
+}
+
+QVariant KDSoapElementReader::readText(QXmlStreamReader &reader, int metaTypeId)
+{
+    QVariant variant;
+    while (reader.readNext() != QXmlStreamReader::Invalid) {
+        if (reader.isEndElement()) {
+            break;
+        }
+        if (reader.isCharacters()) {
+            variant = KDSoapMessageReader::textToVariant(reader.text(), metaTypeId);
+        } else if (reader.isStartElement()) {
+            skipElement(reader);
+        }
+    }
+    return variant;
+}
+
+QVariant KDSoapElementReader::textToVariant(const QStringRef &text, int metaTypeId)
+{
+    return KDSoapMessageReader::textToVariant(text, metaTypeId);
+}
+
+KDSoapValue KDSoapElementReader::readValue(QXmlStreamReader &reader)
+{
+    return KDSoapMessageReader::readElement(reader);
+}
+
+void KDSoapElementReader::skipElement(QXmlStreamReader &reader)
+{
+    int depth = 1;
+    while (depth > 0 && reader.readNext() != QXmlStreamReader::Invalid) {
+        if (reader.isStartElement()) {
+            ++depth;
+        } else if (reader.isEndElement()) {
+            --depth;
+        }
+    }
+}
+
+bool KDSoapElementReader::isSoapAttribute(const QXmlStreamAttribute &attribute)
+{
+    const QStringRef ns = attribute.namespaceUri();
+    return ns == KDSoapNamespaceManager::xmlSchemaInstance1999() ||
+           ns == KDSoapNamespaceManager::xmlSchemaInstance2001() ||
+           ns == KDSoapNamespaceManager::soapEncoding() || ns == KDSoapNamespaceManager::soapEncoding200305() ||
+           ns == KDSoapNamespaceManager::soapEnvelope() || ns == KDSoapNamespaceManager::soapEnvelope200305();
+}
@@ -0,0 +1,117 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPELEMENTREADER_H
+#define KDSOAPELEMENTREADER_H
+
+#include "KDSoapGlobal.h"
+#include "KDSoapValue.h"
+#include <QtCore/QVariant>
+#include <QtCore/QXmlStreamReader>
+
+/**
+ * KDSoapElementReader reads the element returned in the body of a SOAP reply
+ * directly from the XML stream, without building a KDSoapValue tree first.
+ *
+ * The code generated by kdwsdl2cpp with the \c -stream-deserializers option
+ * uses it to fill the returned complex types in synchronous calls.
+ * The static helpers are used by the generated \c readXml() methods.
+ *
+ * \see KDSoapClientInterface::call()
+ * \since 1.7
+ */
+class KDSOAP_EXPORT KDSoapElementReader
+{
+public:
+    /**
+     * Destructs the element reader.
+     */
+    virtual ~KDSoapElementReader();
+
+    /**
+     * Reads the element on which \p reader is positioned.
+     * The implementation must read up to and including the matching end element.
+     */
+    virtual void readElement(QXmlStreamReader &reader) = 0;
+
+    /**
+     * Reads the text of the current element, up to its end element.
+     * \return an invalid QVariant if the element is empty, like KDSoapValue::value() would.
+     */
+    static QVariant readText(QXmlStreamReader &reader);
+
+    /**
+     * Reads the text of the current element, up to its end element, and converts it to
+     * the type \p metaTypeId, e.g. QVariant::Int or qMetaTypeId<KDDateTime>().
+     * Numbers, booleans and dates are parsed straight from the XML stream.
+     * \return the text itself if it can't be converted, or an invalid QVariant if the element is empty.
+     */
+    static QVariant readText(QXmlStreamReader &reader, int metaTypeId);
+
+    /**
+     * Converts \p text, e.g. the value of an attribute, to the type \p metaTypeId,
+     * like readText() does for the text of an element.
+     */
+    static QVariant textToVariant(const QStringRef &text, int metaTypeId);
+
+    /**
+     * Reads the current element and its children into a KDSoapValue, up to its end element.
+     * This is the fallback for elements that have no generated stream reader, such as xsd:any.
+     */
+    static KDSoapValue readValue(QXmlStreamReader &reader);
+
+    /**
+     * Skips the current element and its children, up to its end element.
+     */
+    static void skipElement(QXmlStreamReader &reader);
+
+    /**
+     * \return \c true if \p attribute belongs to the XML schema instance or SOAP namespaces,
+     * such as xsi:type, and should not be deserialized into a generated type.
+     */
+    static bool isSoapAttribute(const QXmlStreamAttribute &attribute);
+};
+
+/**
+ * Element reader which calls readXml(QXmlStreamReader &) on a generated type.
+ * \since 1.7
+ */
+template <typename T>
+class KDSoapTypedElementReader : public KDSoapElementReader
+{
+public:
+    explicit KDSoapTypedElementReader(T *target)
+        : m_target(target)
+    {
+    }
+
+    virtual void readElement(QXmlStreamReader &reader)
+    {
+        *m_target = T(); // in case the reply is parsed again after an XML error
+        m_target->readXml(reader);
+    }
+
+private:
+    T *m_target;
+};
+
+#endif // KDSOAPELEMENTREADER_H
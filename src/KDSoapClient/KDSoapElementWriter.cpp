@@ -0,0 +1,94 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapElementWriter.h"
+#include "KDSoapNamespaceManager.h"
+#include "KDSoapNamespacePrefixes_p.h"
+
+// The logic below must match KDSoapValue::writeElement and KDSoapValue::writeChildren, with LiteralUse
+
+KDSoapElementWriter::~KDSoapElementWriter()
+{
+}
+
+void KDSoapElementWriter::writeStartElement(QXmlStreamWriter &writer, const QString &messageNamespace, const QString &nameSpace, const QString &name, bool qualified)
+{
+    if (qualified || (!nameSpace.isEmpty() && nameSpace != messageNamespace)) {
+        writer.writeStartElement(nameSpace.isEmpty() ? messageNamespace : nameSpace, name);
+    } else {
+        writer.writeStartElement(name);
+    }
+}
+
+void KDSoapElementWriter::writeElement(QXmlStreamWriter &writer, const QString &messageNamespace, const QString &nameSpace, const QString &name, int flags,
+                                       const QVariant &value, const QString &typeNs, const QString &type)
+{
+    const bool isNil = value.isNull();
+    if (isNil && (flags & OmitIfNil)) {
+        return;
+    }
+    writeStartElement(writer, messageNamespace, nameSpace, name, flags & Qualified);
+    if (isNil) {
+        if (flags & Nillable) {
+            writer.writeAttribute(KDSoapNamespaceManager::xmlSchemaInstance2001(), QLatin1String("nil"), QLatin1String("true"));
+        }
+    } else {
+        writer.writeCharacters(KDSoapValue::variantToTextValue(value, typeNs, type));
+    }
+    writer.writeEndElement();
+}
+
+void KDSoapElementWriter::writeAttribute(QXmlStreamWriter &writer, const QString &nameSpace, const QString &name, int flags,
+        const QVariant &value, const QString &typeNs, const QString &type)
+{
+    if (value.isNull() && (flags & OmitIfNil)) {
+        return;
+    }
+    if (flags & Qualified) {
+        writer.writeAttribute(nameSpace, name, KDSoapValue::variantToTextValue(value, typeNs, type));
+    } else {
+        writer.writeAttribute(name, KDSoapValue::variantToTextValue(value, typeNs, type));
+    }
+}
+
+void KDSoapElementWriter::writeElements(QXmlStreamWriter &writer, const QString &messageNamespace, const KDSoapValueList &values)
+{
+    KDSoapNamespacePrefixes namespacePrefixes; // only used for xsi:type, with EncodedUse
+    for (int i = 0; i < values.count(); ++i) {
+        values.at(i).writeElement(namespacePrefixes, writer, KDSoapValue::LiteralUse, messageNamespace, false);
+    }
+}
+
+void KDSoapElementWriter::writeAttributes(QXmlStreamWriter &writer, const KDSoapValueList &values)
+{
+    for (int i = 0; i < values.count(); ++i) {
+        const KDSoapValue &attr = values.at(i);
+        writeAttribute(writer, attr.namespaceUri(), attr.name(), attr.isQualified() ? Qualified : 0,
+                       attr.value(), attr.typeNs(), attr.type());
+    }
+}
+
+void KDSoapElementWriter::writeContents(QXmlStreamWriter &writer, const QString &messageNamespace, const KDSoapValue &value)
+{
+    KDSoapNamespacePrefixes namespacePrefixes;
+    value.writeElementContents(namespacePrefixes, writer, KDSoapValue::LiteralUse, messageNamespace);
+}
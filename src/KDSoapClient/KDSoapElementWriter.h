@@ -0,0 +1,126 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPELEMENTWRITER_H
+#define KDSOAPELEMENTWRITER_H
+
+#include "KDSoapGlobal.h"
+#include "KDSoapValue.h"
+#include <QtCore/QVariant>
+#include <QtCore/QXmlStreamWriter>
+
+/**
+ * KDSoapElementWriter writes the contents of the element in the body of a SOAP message
+ * directly to the XML stream, without building a KDSoapValue tree first.
+ *
+ * The code generated by kdwsdl2cpp with the \c -stream-serializers option
+ * uses it for the requests of document/literal calls.
+ * The static helpers are used by the generated \c writeXml() methods, and write
+ * exactly what the equivalent KDSoapValue would write with KDSoapValue::LiteralUse.
+ *
+ * \see KDSoapMessage::setElementWriter()
+ * \since 1.7
+ */
+class KDSOAP_EXPORT KDSoapElementWriter
+{
+public:
+    /**
+     * Destructs the element writer.
+     */
+    virtual ~KDSoapElementWriter();
+
+    /**
+     * Writes the attributes, child elements and text of the element
+     * whose start element was just written to \p writer.
+     * \param messageNamespace the namespace of the message, used for qualified child elements without a namespace.
+     */
+    virtual void writeElementContents(QXmlStreamWriter &writer, const QString &messageNamespace) const = 0;
+
+    /**
+     * Flags for writeElement() and writeAttribute().
+     */
+    enum WriteFlag {
+        Qualified = 1, ///< like KDSoapValue::setQualified(true)
+        Nillable = 2,  ///< like KDSoapValue::setNillable(true)
+        OmitIfNil = 4  ///< don't write anything if \p value is null
+    };
+
+    /**
+     * Writes the start element for a child element called \p name.
+     */
+    static void writeStartElement(QXmlStreamWriter &writer, const QString &messageNamespace, const QString &nameSpace, const QString &name, bool qualified);
+
+    /**
+     * Writes a child element containing \p value, of the XML type \p typeNs:\p type.
+     * \param flags a combination of WriteFlag values
+     */
+    static void writeElement(QXmlStreamWriter &writer, const QString &messageNamespace, const QString &nameSpace, const QString &name, int flags,
+                             const QVariant &value, const QString &typeNs, const QString &type);
+
+    /**
+     * Writes an attribute with the given \p value, of the XML type \p typeNs:\p type.
+     * \param flags a combination of WriteFlag values, Nillable is ignored
+     */
+    static void writeAttribute(QXmlStreamWriter &writer, const QString &nameSpace, const QString &name, int flags,
+                               const QVariant &value, const QString &typeNs, const QString &type);
+
+    /**
+     * Writes \p values as child elements.
+     * This is the fallback for the elements that have no generated writer, such as xsd:any.
+     */
+    static void writeElements(QXmlStreamWriter &writer, const QString &messageNamespace, const KDSoapValueList &values);
+
+    /**
+     * Writes \p values as attributes.
+     */
+    static void writeAttributes(QXmlStreamWriter &writer, const KDSoapValueList &values);
+
+    /**
+     * Writes the attributes, child elements and text of \p value.
+     */
+    static void writeContents(QXmlStreamWriter &writer, const QString &messageNamespace, const KDSoapValue &value);
+};
+
+/**
+ * Element writer which calls writeXmlContents(QXmlStreamWriter &, const QString &) on a copy
+ * of a generated type.
+ * \since 1.7
+ */
+template <typename T>
+class KDSoapTypedElementWriter : public KDSoapElementWriter
+{
+public:
+    explicit KDSoapTypedElementWriter(const T &value)
+        : m_value(value)
+    {
+    }
+
+    virtual void writeElementContents(QXmlStreamWriter &writer, const QString &messageNamespace) const
+    {
+        m_value.writeXmlContents(writer, messageNamespace);
+    }
+
+private:
+    T m_value;
+};
+
+#endif // KDSOAPELEMENTWRITER_H
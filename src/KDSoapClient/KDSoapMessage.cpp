@@ -21,12 +21,14 @@
 **
 **********************************************************************/
 #include "KDSoapMessage.h"
+#include "KDSoapElementWriter.h"
 #include "KDSoapNamespaceManager.h"
 #include "KDSoapNamespacePrefixes_p.h"
 #include "KDDateTime.h"
 #include <QDebug>
 #include <QXmlStreamReader>
 #include <QVariant>
+#include <QSharedPointer>
 
 class KDSoapMessageData : public QSharedData
 {
@@ -39,6 +41,7 @@ public:
     bool isFault;
     bool hasMessageAddressingProperties;
     KDSoapMessageAddressingProperties messageAddressingProperties;
+    QSharedPointer<KDSoapElementWriter> elementWriter;
 };
 
 KDSoapMessage::KDSoapMessage()
@@ -153,6 +156,16 @@ bool KDSoapMessage::hasMessageAddressingProperties() const
     return d->hasMessageAddressingProperties;
 }
 
+void KDSoapMessage::setElementWriter(KDSoapElementWriter *writer)
+{
+    d->elementWriter = QSharedPointer<KDSoapElementWriter>(writer);
+}
+
+const KDSoapElementWriter *KDSoapMessage::elementWriter() const
+{
+    return d->elementWriter.data();
+}
+
 KDSoapMessage::Use KDSoapMessage::use() const
 {
     return d->use;
@@ -34,6 +34,7 @@ class QString;
 QT_END_NAMESPACE
 class KDSoapMessageData;
 class KDSoapHeaders;
+class KDSoapElementWriter;
 
 /**
  * The KDSoapMessage class represents one message sent or received via SOAP.
@@ -172,6 +173,25 @@ public:
      * \since 1.5
      */
     KDSoapMessageAddressingProperties messageAddressingProperties() const;
+
+    /**
+     * Makes \p writer write the contents of this message (its attributes, child elements and text)
+     * straight to the XML stream, instead of the child values of the message.
+     * The message takes ownership of \p writer, and shares it with its copies.
+     * This is only used for non-fault messages. \p writer is meant for KDSoapValue::LiteralUse;
+     * with KDSoapValue::EncodedUse its output is still sent, but a warning is printed
+     * since it doesn't contain the xsi:type attributes required by the SOAP encoding.
+     *
+     * This is used by the code generated with kdwsdl2cpp -stream-serializers.
+     * \since 1.7
+     */
+    void setElementWriter(KDSoapElementWriter *writer);
+
+    /**
+     * \return the writer passed to setElementWriter(), or 0 if none was set.
+     * \since 1.7
+     */
+    const KDSoapElementWriter *elementWriter() const;
 private:
     bool isNull() const;
     friend class KDSoapPendingCall;
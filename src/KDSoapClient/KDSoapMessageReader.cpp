@@ -22,11 +22,20 @@
 **********************************************************************/
 
 #include "KDSoapMessageReader_p.h"
+#include "KDSoapElementReader.h"
 #include "KDSoapNamespaceManager.h"
 #include "KDSoapNamespacePrefixes_p.h"
+#include "KDSoapValueArena_p.h"
+#include "KDSoapBinaryCodec_p.h"
+#include "KDSoapBinaryElementHandler.h"
+#include "KDSoapMtomPackage_p.h"
 #include "KDDateTime.h"
+#include "KDDateTime_p.h"
 
 #include <QDebug>
+#include <QHash>
+#include <QIODevice>
+#include <QVector>
 #include <QXmlStreamReader>
 
 // Wrapper for compatibility with Qt < 4.6.
@@ -90,13 +99,415 @@ static int xmlTypeToMetaType(const QString &xmlType)
     return -1;
 }
 
-static KDSoapValue parseElement(QXmlStreamReader &reader, const QXmlStreamNamespaceDeclarations &envNsDecls)
+QVariant KDSoapMessageReader::textToVariant(const QStringRef &text, int metaTypeId)
 {
+    if (text.isEmpty()) {
+        return QVariant();
+    }
+#if QT_VERSION >= 0x050100
+    const QStringRef &str = text;
+#else
+    const QString str = text.toString(); // QStringRef can't parse numbers yet
+#endif
+    bool ok = false;
+    switch (metaTypeId) {
+    case QVariant::Int: {
+        const int value = str.toInt(&ok);
+        if (ok) {
+            return QVariant(value);
+        }
+        break;
+    }
+    case QVariant::UInt: {
+        const uint value = str.toUInt(&ok);
+        if (ok) {
+            return QVariant(value);
+        }
+        break;
+    }
+    case QVariant::LongLong: {
+        const qlonglong value = str.toLongLong(&ok);
+        if (ok) {
+            return QVariant(value);
+        }
+        break;
+    }
+    case QVariant::ULongLong: {
+        const qulonglong value = str.toULongLong(&ok);
+        if (ok) {
+            return QVariant(value);
+        }
+        break;
+    }
+    case QVariant::Double: {
+        const double value = str.toDouble(&ok);
+        if (ok) {
+            return QVariant(value);
+        }
+        break;
+    }
+    case QMetaType::Float: {
+        const float value = str.toFloat(&ok);
+        if (ok) {
+            return QVariant::fromValue(value);
+        }
+        break;
+    }
+    case QVariant::Bool:
+        // The xsd:boolean lexical space; anything else is converted by QVariant, as before
+        if (text == QLatin1String("true") || text == QLatin1String("1")) {
+            return QVariant(true);
+        } else if (text == QLatin1String("false") || text == QLatin1String("0")) {
+            return QVariant(false);
+        }
+        break;
+    case QVariant::Date: {
+        QDate date;
+        if (KDDateTimeFormat::parseDate(text.unicode(), text.size(), &date)) {
+            return QVariant(date);
+        }
+        break;
+    }
+    case QVariant::Time: {
+        QTime time;
+        if (KDDateTimeFormat::parseTime(text.unicode(), text.size(), &time)) {
+            return QVariant(time);
+        }
+        break;
+    }
+    default:
+        if (metaTypeId == qMetaTypeId<KDDateTime>()) {
+            const KDDateTime dateTime = KDDateTime::fromDateString(text.toString());
+            if (dateTime.isValid()) {
+                return QVariant::fromValue(dateTime);
+            }
+        }
+        break;
+    }
+
+    QVariant variant(text.toString());
+    if (metaTypeId != QVariant::Invalid && metaTypeId != -1) {
+        QVariant copy = variant;
+        if (!variant.convert(static_cast<QVariant::Type>(metaTypeId))) {
+            variant = copy;
+        }
+    }
+    return variant;
+}
+
+// The same element names, attribute names and namespaces come up again and again in a message,
+// use a single QString for each of them rather than one allocation per KDSoapValue.
+class KDSoapStringPool
+{
+public:
+    QString intern(const QStringRef &str)
+    {
+        if (str.isEmpty()) {
+            return QString();
+        }
+        // Looked up by hash, so that a QString is only created for new strings
+        const uint hash = qHash(str);
+        QMultiHash<uint, QString>::const_iterator it = m_strings.constFind(hash);
+        for (; it != m_strings.constEnd() && it.key() == hash; ++it) {
+            if (it.value() == str) {
+                return it.value();
+            }
+        }
+        const QString string = str.toString();
+        m_strings.insert(hash, string);
+        return string;
+    }
+
+private:
+    QMultiHash<uint, QString> m_strings;
+};
+
+// True if data is encoded in UTF-8, the default, or in ASCII
+static bool isUtf8Document(const QByteArray &data)
+{
+    if (data.size() < 2 || data.at(0) == 0 || data.at(1) == 0 || data.startsWith("\xFE\xFF") || data.startsWith("\xFF\xFE")) {
+        return false; // UTF-16 or UTF-32
+    }
+    const int start = data.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    if (data.mid(start, 5) != "<?xml") {
+        return true;
+    }
+    const QByteArray declaration = data.mid(start, data.indexOf("?>", start) - start);
+    const int pos = declaration.indexOf("encoding");
+    if (pos == -1) {
+        return true;
+    }
+    const int quote = declaration.indexOf('=', pos) + 1;
+    const QByteArray encoding = declaration.mid(quote).trimmed().mid(1).toLower();
+    return encoding.startsWith("utf-8") || encoding.startsWith("utf8") || encoding.startsWith("us-ascii");
+}
+
+// Length of the character reference at text, if it is one for a whitespace character (such as
+// &#13; for the line breaks of base64 text), otherwise 0
+static int whitespaceReferenceLength(const char *text, int size)
+{
+    int i = 2;
+    if (size < 4 || text[0] != '&' || text[1] != '#') {
+        return 0;
+    }
+    const bool hex = text[2] == 'x';
+    if (hex) {
+        ++i;
+    }
+    int value = 0;
+    const int start = i;
+    for (; i < size && i < start + 4 && text[i] != ';'; ++i) {
+        const char c = text[i];
+        if (c >= '0' && c <= '9') {
+            value = value * (hex ? 16 : 10) + (c - '0');
+        } else if (hex && c >= 'a' && c <= 'f') {
+            value = value * 16 + (c - 'a' + 10);
+        } else if (hex && c >= 'A' && c <= 'F') {
+            value = value * 16 + (c - 'A' + 10);
+        } else {
+            return 0;
+        }
+    }
+    if (i == start || i == size || text[i] != ';') {
+        return 0;
+    }
+    return value == 0x9 || value == 0xa || value == 0xd || value == 0x20 ? i + 1 : 0;
+}
+
+// True if the text is base64 data, with whitespace which can be encoded as references
+static bool isBase64Text(const char *text, int size)
+{
+    for (int i = 0; i < size; ++i) {
+        const char c = text[i];
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                c == '+' || c == '/' || c == '=' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            continue;
+        }
+        const int length = whitespaceReferenceLength(text + i, size - i);
+        if (length == 0) {
+            return false;
+        }
+        i += length - 1;
+    }
+    return true;
+}
+
+// QXmlStreamReader converts the text of an element into one QString, or the whole message
+// when it isn't given in parts. So for UTF-8 messages, large base64 texts are found with a
+// byte-level scan of the message, and the reader gets a copy of it where each one is replaced
+// with a processing instruction. Their text is then decoded straight from the message bytes,
+// so the memory used for an element doesn't depend on its size.
+class KDSoapLargeTexts
+{
+public:
+    // Smaller texts are read from QXmlStreamReader as usual
+    enum { MinimumSize = 16384 };
+
+    // Returns false if the message can't be handled this way, it must then be read as it is
+    bool scan(const QByteArray &data)
+    {
+        m_data = data;
+        m_texts.clear();
+        const char *text = data.constData();
+        const int size = data.size();
+        int pos = data.indexOf('<');
+        while (pos != -1 && pos + 1 < size) {
+            int end = -1;
+            if (text[pos + 1] == '?') {
+                if (data.mid(pos + 2, int(qstrlen(s_target))) == s_target) {
+                    return false; // can't be told apart from the ones added by readerData()
+                }
+                end = data.indexOf("?>", pos);
+                end = end == -1 ? -1 : end + 2;
+            } else if (text[pos + 1] == '!') {
+                if (data.mid(pos, 4) == "<!--") {
+                    end = data.indexOf("-->", pos + 4);
+                    end = end == -1 ? -1 : end + 3;
+                } else if (data.mid(pos, 9) == "<![CDATA[") {
+                    end = data.indexOf("]]>", pos + 9);
+                    end = end == -1 ? -1 : end + 3;
+                } else {
+                    return false; // a DTD, not allowed in SOAP messages anyway
+                }
+            } else if (text[pos + 1] == '/') {
+                end = data.indexOf('>', pos);
+                end = end == -1 ? -1 : end + 1;
+            } else {
+                // A start element, whose attribute values can contain '>'
+                char quote = 0;
+                for (end = pos + 1; end < size && (quote || text[end] != '>'); ++end) {
+                    if (quote) {
+                        if (text[end] == quote) {
+                            quote = 0;
+                        }
+                    } else if (text[end] == '"' || text[end] == '\'') {
+                        quote = text[end];
+                    }
+                }
+                if (end == size) {
+                    break;
+                }
+                ++end;
+                if (text[end - 2] != '/') {
+                    const int textEnd = data.indexOf('<', end);
+                    if (textEnd - end >= MinimumSize && textEnd + 1 < size && text[textEnd + 1] == '/' &&
+                            isBase64Text(text + end, textEnd - end)) {
+                        m_texts.append(qMakePair(end, textEnd));
+                    }
+                }
+            }
+            if (end == -1) {
+                break;
+            }
+            pos = data.indexOf('<', end);
+        }
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_texts.isEmpty();
+    }
+
+    // The message without the large texts, for QXmlStreamReader
+    QByteArray readerData() const
+    {
+        QByteArray result;
+        int pos = 0;
+        for (int i = 0; i < m_texts.count(); ++i) {
+            const QPair<int, int> &range = m_texts.at(i);
+            result += m_data.mid(pos, range.first - pos);
+            result += "<?";
+            result += s_target;
+            result += ' ' + QByteArray::number(i);
+            // Keeps the line numbers of the reader's error messages
+            for (int pos = range.first; pos < range.second; ++pos) {
+                if (m_data.at(pos) == '\n') {
+                    result += '\n';
+                }
+            }
+            result += "?>";
+            pos = range.second;
+        }
+        result += m_data.mid(pos);
+        return result;
+    }
+
+    // The index of the large text replaced by the current token of the reader, or -1
+    int textIndex(const QXmlStreamReader &reader) const
+    {
+        if (!reader.isProcessingInstruction() || reader.processingInstructionTarget() != QLatin1String(s_target)) {
+            return -1;
+        }
+        bool ok;
+        const int index = reader.processingInstructionData().toString().trimmed().toInt(&ok);
+        return ok && index >= 0 && index < m_texts.count() ? index : -1;
+    }
+
+    // Decodes the base64 text, without the character references, which are only for whitespace
+    bool decode(int index, KDSoapBase64Decoder &decoder, QIODevice *device) const
+    {
+        const char *text = m_data.constData();
+        const QPair<int, int> &range = m_texts.at(index);
+        int pos = range.first;
+        while (pos < range.second) {
+            int end = m_data.indexOf('&', pos);
+            if (end == -1 || end > range.second) {
+                end = range.second;
+            }
+            if (!decoder.decode(text + pos, end - pos, device)) {
+                return false;
+            }
+            pos = end;
+            if (pos < range.second) {
+                pos += whitespaceReferenceLength(text + pos, range.second - pos);
+            }
+        }
+        return true;
+    }
+
+    // The text as the reader would have given it, for elements which aren't decoded
+    QString text(int index) const
+    {
+        const QPair<int, int> &range = m_texts.at(index);
+        QString result;
+        result.reserve(range.second - range.first);
+        for (int pos = range.first; pos < range.second; ++pos) {
+            const char c = m_data.at(pos);
+            const int length = c == '&' ? whitespaceReferenceLength(m_data.constData() + pos, range.second - pos) : 0;
+            if (length) {
+                const QByteArray reference = m_data.mid(pos + 2, length - 3);
+                result += QChar(reference.startsWith('x') ? reference.mid(1).toUShort(0, 16) : reference.toUShort());
+                pos += length - 1;
+            } else {
+                result += QLatin1Char(c);
+            }
+        }
+        return result;
+    }
+
+private:
+    static const char s_target[];
+    QByteArray m_data;
+    QVector<QPair<int, int> > m_texts;
+};
+
+const char KDSoapLargeTexts::s_target[] = "kdsoap-large-text";
+
+// What is shared by all the elements of a message while parsing it
+struct KDSoapParseContext {
+    KDSoapParseContext()
+        : arena(0), binaryHandler(0), mtomPackage(0), largeTexts(0)
+    {
+    }
+    QXmlStreamNamespaceDeclarations envNsDecls;
+    KDSoapStringPool pool;
+    KDSoapValueArena *arena;
+    KDSoapBinaryElementHandler *binaryHandler;
+    const KDSoapMtomPackage *mtomPackage;
+    const KDSoapLargeTexts *largeTexts; // only for UTF-8 messages with a binaryHandler
+};
+
+// Decodes the base64 text of the current element into device, up to its end element.
+// With MTOM, the data is copied from the attachment instead, without any decoding.
+static void readBinaryElement(QXmlStreamReader &reader, QIODevice *device, KDSoapParseContext &context)
+{
+    KDSoapBase64Decoder decoder;
     const QString name = reader.name().toString();
-    KDSoapValue val(name, QVariant());
-    val.setNamespaceUri(reader.namespaceUri().toString());
+    while (reader.readNext() != QXmlStreamReader::Invalid) {
+        if (reader.isEndElement()) {
+            break;
+        }
+        bool ok = true;
+        if (reader.isCharacters()) {
+            ok = decoder.decode(reader.text(), device);
+        } else if (reader.isProcessingInstruction()) {
+            const int index = context.largeTexts ? context.largeTexts->textIndex(reader) : -1;
+            if (index != -1) {
+                ok = context.largeTexts->decode(index, decoder, device);
+            }
+        } else if (reader.isStartElement()) {
+            if (context.mtomPackage && KDSoapMtomPackage::isInclude(reader)) {
+                context.mtomPackage->readInclude(reader, device);
+            } else {
+                KDSoapElementReader::skipElement(reader);
+            }
+        }
+        if (!ok) {
+            reader.raiseError(QObject::tr("Error writing the content of %1: %2").arg(name, device->errorString()));
+        }
+    }
+}
+
+static KDSoapValue parseElement(QXmlStreamReader &reader, KDSoapParseContext &context)
+{
+    KDSoapStringPool &pool = context.pool;
+    const QXmlStreamNamespaceDeclarations &envNsDecls = context.envNsDecls;
+    const QString name = pool.intern(reader.name());
+    KDSoapValue val = context.arena ? context.arena->createValue(name) : KDSoapValue(name, QVariant());
+    val.setNamespaceUri(pool.intern(reader.namespaceUri()));
     //qDebug() << "parsing" << name;
-    QVariant::Type metaTypeId = QVariant::Invalid;
+    int metaTypeId = QVariant::Invalid;
 
     const QXmlStreamAttributes attributes = reader.attributes();
     Q_FOREACH (const QXmlStreamAttribute &attribute, attributes) {
@@ -112,8 +523,12 @@ static KDSoapValue parseElement(QXmlStreamReader &reader, const QXmlStreamNamesp
                 const QString type = attrValue.toString();
                 const int pos = type.indexOf(QLatin1Char(':'));
                 const QString dataType = type.mid(pos + 1);
-                val.setType(namespaceForPrefix(envNsDecls, type.left(pos)).toString(), dataType);
-                metaTypeId = static_cast<QVariant::Type>(xmlTypeToMetaType(dataType));
+                val.setType(pool.intern(namespaceForPrefix(envNsDecls, type.left(pos))), pool.intern(QStringRef(&dataType)));
+                metaTypeId = xmlTypeToMetaType(dataType);
+                if (metaTypeId == qMetaTypeId<KDDateTime>()) {
+                    // Kept as text: applications and generated deserializers call toString() on it
+                    metaTypeId = QVariant::Invalid;
+                }
             }
             continue;
         } else if (ns == KDSoapNamespaceManager::soapEncoding() || ns == KDSoapNamespaceManager::soapEncoding200305() ||
@@ -121,40 +536,77 @@ static KDSoapValue parseElement(QXmlStreamReader &reader, const QXmlStreamNamesp
             continue;
         }
         //qDebug() << "Got attribute:" << name << ns << "=" << attrValue;
-        val.childValues().attributes().append(KDSoapValue(name.toString(), attrValue.toString()));
+        val.childValues().attributes().append(KDSoapValue(pool.intern(name), attrValue.toString()));
+    }
+    if (context.binaryHandler) {
+        QIODevice *device = context.binaryHandler->createDevice(val.namespaceUri(), name, val.typeNs(), val.type());
+        if (device) {
+            readBinaryElement(reader, device, context);
+            val.setValue(QVariant::fromValue(QSharedPointer<QIODevice>(device)));
+            return val;
+        }
     }
-    QString text;
+    QVariant variant;
     while (reader.readNext() != QXmlStreamReader::Invalid) {
         if (reader.isEndElement()) {
             break;
         }
         if (reader.isCharacters()) {
-            text = reader.text().toString();
-            //qDebug() << "text=" << text;
+            // With use=encoded, we have type info, we can convert the text here
+            // Otherwise, for servers, we do it later, once we know the method's parameter types.
+            variant = KDSoapMessageReader::textToVariant(reader.text(), metaTypeId);
+            //qDebug() << "text=" << reader.text() << variant << metaTypeId;
+        } else if (reader.isProcessingInstruction()) {
+            const int index = context.largeTexts ? context.largeTexts->textIndex(reader) : -1;
+            if (index != -1) {
+                // A large text, but not for a binary element
+                const QString text = context.largeTexts->text(index);
+                variant = KDSoapMessageReader::textToVariant(QStringRef(&text), metaTypeId);
+            }
         } else if (reader.isStartElement()) {
-            const KDSoapValue subVal = parseElement(reader, envNsDecls); // recurse
+            if (context.mtomPackage && KDSoapMtomPackage::isInclude(reader)) {
+                // Sent as an attachment: the value is the same as if the base64 text had been inline
+                const QString text = context.mtomPackage->readIncludeText(reader);
+                variant = KDSoapMessageReader::textToVariant(QStringRef(&text), metaTypeId);
+                continue;
+            }
+            const KDSoapValue subVal = parseElement(reader, context); // recurse
             val.childValues().append(subVal);
         }
     }
 
-    if (!text.isEmpty()) {
-        QVariant variant(text);
-        //qDebug() << text << variant << metaTypeId;
-        // With use=encoded, we have type info, we can convert the variant here
-        // Otherwise, for servers, we do it later, once we know the method's parameter types.
-        if (metaTypeId != QVariant::Invalid) {
-            QVariant copy = variant;
-            if (!variant.convert(metaTypeId)) {
-                variant = copy;
-            }
-        }
+    if (variant.isValid()) {
         val.setValue(variant);
     }
     return val;
 }
 
 KDSoapMessageReader::KDSoapMessageReader()
+    : m_arenaAllocation(false), m_binaryHandler(0), m_mtomPackage(0)
+{
+}
+
+void KDSoapMessageReader::setArenaAllocation(bool enabled)
+{
+    m_arenaAllocation = enabled;
+}
+
+void KDSoapMessageReader::setBinaryElementHandler(KDSoapBinaryElementHandler *handler)
+{
+    m_binaryHandler = handler;
+}
+
+void KDSoapMessageReader::setMtomPackage(const KDSoapMtomPackage *package)
+{
+    m_mtomPackage = package;
+}
+
+KDSoapValue KDSoapMessageReader::readElement(QXmlStreamReader &reader)
 {
+    // Without the envelope's namespace declarations, xsi:type prefixes can't be resolved,
+    // but the type name is still used to convert the value.
+    KDSoapParseContext context;
+    return parseElement(reader, context);
 }
 
 static bool isInvalidCharRef(const QByteArray &charRef)
@@ -180,18 +632,19 @@ static bool isInvalidCharRef(const QByteArray &charRef)
     return false;
 }
 
-static QByteArray handleNotWellFormedError(const QByteArray &data, qint64 offset)
+// readerData is what was given to the reader, which can be different from data (see KDSoapLargeTexts)
+static QByteArray handleNotWellFormedError(const QByteArray &data, const QByteArray &readerData, qint64 offset)
 {
     qint64 i = offset - 1; // offset is the char following the failing one
     QByteArray dataCleanedUp;
     QByteArray originalSequence;
 
-    while (i >= 0 && data.at(i) != '&') {
-        if (data.at(i) == '<') { // InvalidXML but not invalid characters related
+    while (i >= 0 && i < readerData.size() && readerData.at(i) != '&') {
+        if (readerData.at(i) == '<') { // InvalidXML but not invalid characters related
             return dataCleanedUp;
         }
 
-        originalSequence.prepend(data.at(i));
+        originalSequence.prepend(readerData.at(i));
         i--;
     }
 
@@ -203,20 +656,53 @@ static QByteArray handleNotWellFormedError(const QByteArray &data, qint64 offset
     return dataCleanedUp;
 }
 
-KDSoapMessageReader::XmlError KDSoapMessageReader::xmlToMessage(const QByteArray &data, KDSoapMessage *pMsg, QString *pMessageNamespace, KDSoapHeaders *pRequestHeaders) const
+namespace {
+// Releases the reader's reference to the arena, the parsed values keep it alive
+struct ArenaHolder {
+    explicit ArenaHolder(KDSoapValueArena *a) : arena(a) {}
+    ~ArenaHolder()
+    {
+        if (arena) {
+            arena->release();
+        }
+    }
+    KDSoapValueArena *arena;
+};
+}
+
+KDSoapMessageReader::XmlError KDSoapMessageReader::xmlToMessage(const QByteArray &data, KDSoapMessage *pMsg, QString *pMessageNamespace, KDSoapHeaders *pRequestHeaders,
+        KDSoapElementReader *bodyReader) const
 {
     Q_ASSERT(pMsg);
-    QXmlStreamReader reader(data);
+    if (bodyReader && m_binaryHandler) {
+        // The generated deserializers read the body themselves, binary elements would be lost
+        qWarning("ERROR: A binary element handler can't be used with the stream deserializers of the generated code");
+        pMsg->setFault(true);
+        pMsg->addArgument(QString::fromLatin1("faultcode"), QString::fromLatin1("Client"));
+        pMsg->addArgument(QString::fromLatin1("faultstring"),
+                          QString::fromLatin1("A binary element handler can't be used with the stream deserializers of the generated code"));
+        return ParseError;
+    }
+    KDSoapLargeTexts largeTexts;
+    const bool hasLargeTexts = m_binaryHandler && isUtf8Document(data) && largeTexts.scan(data) && !largeTexts.isEmpty();
+    const QByteArray readerData = hasLargeTexts ? largeTexts.readerData() : data;
+    QXmlStreamReader reader(readerData);
+    KDSoapParseContext context;
+    ArenaHolder arena(m_arenaAllocation ? new KDSoapValueArena : 0);
+    context.arena = arena.arena;
+    context.binaryHandler = m_binaryHandler;
+    context.mtomPackage = m_mtomPackage;
+    context.largeTexts = hasLargeTexts ? &largeTexts : 0;
     if (readNextStartElement(reader)) {
         if (reader.name() == QLatin1String("Envelope") && (reader.namespaceUri() == KDSoapNamespaceManager::soapEnvelope() ||
                 reader.namespaceUri() == KDSoapNamespaceManager::soapEnvelope200305())) {
-            const QXmlStreamNamespaceDeclarations envNsDecls = reader.namespaceDeclarations();
+            context.envNsDecls = reader.namespaceDeclarations();
             if (readNextStartElement(reader)) {
                 if (reader.name() == QLatin1String("Header") && (reader.namespaceUri() == KDSoapNamespaceManager::soapEnvelope() ||
                         reader.namespaceUri() == KDSoapNamespaceManager::soapEnvelope200305())) {
                     while (readNextStartElement(reader)) {
                         KDSoapMessage header;
-                        static_cast<KDSoapValue &>(header) = parseElement(reader, envNsDecls);
+                        static_cast<KDSoapValue &>(header) = parseElement(reader, context);
                         pRequestHeaders->append(header);
                     }
                     readNextStartElement(reader); // read <Body>
@@ -224,7 +710,14 @@ KDSoapMessageReader::XmlError KDSoapMessageReader::xmlToMessage(const QByteArray
                 if (reader.name() == QLatin1String("Body") && (reader.namespaceUri() == KDSoapNamespaceManager::soapEnvelope() ||
                         reader.namespaceUri() == KDSoapNamespaceManager::soapEnvelope200305())) {
                     if (readNextStartElement(reader)) {
-                        *pMsg = parseElement(reader, envNsDecls);
+                        if (bodyReader && reader.name() != QLatin1String("Fault")) {
+                            *pMsg = KDSoapMessage();
+                            static_cast<KDSoapValue &>(*pMsg) = KDSoapValue(reader.name().toString(), QVariant());
+                            pMsg->setNamespaceUri(reader.namespaceUri().toString());
+                            bodyReader->readElement(reader);
+                        } else {
+                            *pMsg = parseElement(reader, context);
+                        }
                         if (pMessageNamespace) {
                             *pMessageNamespace = pMsg->namespaceUri();
                         }
@@ -246,9 +739,9 @@ KDSoapMessageReader::XmlError KDSoapMessageReader::xmlToMessage(const QByteArray
     if (reader.hasError()) {
         if (reader.error() == QXmlStreamReader::NotWellFormedError) {
             qWarning() << "Handling a Not well Formed Error";
-            QByteArray dataCleanedUp = handleNotWellFormedError(data, reader.characterOffset());
+            QByteArray dataCleanedUp = handleNotWellFormedError(data, readerData, reader.characterOffset());
             if (!dataCleanedUp.isEmpty()) {
-                return xmlToMessage(dataCleanedUp, pMsg, pMessageNamespace, pRequestHeaders);
+                return xmlToMessage(dataCleanedUp, pMsg, pMessageNamespace, pRequestHeaders, bodyReader);
             }
         }
         pMsg->setFault(true);
@@ -26,6 +26,13 @@
 
 #include "KDSoapMessage.h"
 
+class KDSoapElementReader;
+class KDSoapBinaryElementHandler;
+class KDSoapMtomPackage;
+QT_BEGIN_NAMESPACE
+class QXmlStreamReader;
+QT_END_NAMESPACE
+
 class KDSOAP_EXPORT KDSoapMessageReader
 {
 public:
@@ -37,7 +44,41 @@ public:
 
     KDSoapMessageReader();
 
-    XmlError xmlToMessage(const QByteArray &data, KDSoapMessage *pParsedMessage, QString *pMessageNamespace, KDSoapHeaders *pRequestHeaders) const;
+    /**
+     * Allocates the values of the parsed messages from a few large blocks, see KDSoapValueArena.
+     */
+    void setArenaAllocation(bool enabled);
+
+    /**
+     * Decodes the base64Binary elements selected by \p handler into devices, see KDSoapBinaryElementHandler.
+     */
+    void setBinaryElementHandler(KDSoapBinaryElementHandler *handler);
+
+    /**
+     * Resolves the xop:Include elements of a message received with MTOM, using the attachments of \p package.
+     */
+    void setMtomPackage(const KDSoapMtomPackage *package);
+
+    /**
+     * Parses \p data into \p pParsedMessage.
+     * If \p bodyReader is set, the element in the body is read by it instead, unless it's a fault;
+     * \p pParsedMessage then only gets the name and namespace of that element.
+     * A \p bodyReader can't be used with a binary element handler: this returns ParseError and a fault.
+     */
+    XmlError xmlToMessage(const QByteArray &data, KDSoapMessage *pParsedMessage, QString *pMessageNamespace, KDSoapHeaders *pRequestHeaders,
+                          KDSoapElementReader *bodyReader = 0) const;
+
+    // Parses the current element and its children, for KDSoapElementReader::readValue
+    static KDSoapValue readElement(QXmlStreamReader &reader);
+
+    // Converts the text of an element to metaTypeId, parsing numbers, booleans and dates
+    // without an intermediate QString when possible. Returns the text if it can't be converted.
+    static QVariant textToVariant(const QStringRef &text, int metaTypeId);
+
+private:
+    bool m_arenaAllocation;
+    KDSoapBinaryElementHandler *m_binaryHandler;
+    const KDSoapMtomPackage *m_mtomPackage;
 };
 
 #endif
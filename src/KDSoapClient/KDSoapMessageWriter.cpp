@@ -25,11 +25,14 @@
 #include "KDSoapClientInterface_p.h"
 #include "KDSoapNamespaceManager.h"
 #include "KDSoapValue.h"
+#include "KDSoapElementWriter.h"
+#include "KDSoapMtomPackage_p.h"
 #include <QVariant>
 #include <QDebug>
 
 KDSoapMessageWriter::KDSoapMessageWriter()
-    : m_version(KDSoapClientInterface::SOAP1_1)
+    : m_version(KDSoapClientInterface::SOAP1_1),
+      m_mtomPackage(0)
 {
 }
 
@@ -43,6 +46,11 @@ void KDSoapMessageWriter::setMessageNamespace(const QString &ns)
     m_messageNamespace = ns;
 }
 
+void KDSoapMessageWriter::setMtomPackage(KDSoapMtomPackage *package)
+{
+    m_mtomPackage = package;
+}
+
 QByteArray KDSoapMessageWriter::messageToXml(const KDSoapMessage &message, const QString &method,
         const KDSoapHeaders &headers, const QMap<QString, KDSoapMessage> &persistentHeaders) const
 {
@@ -52,6 +60,10 @@ QByteArray KDSoapMessageWriter::messageToXml(const KDSoapMessage &message, const
 
     KDSoapNamespacePrefixes namespacePrefixes;
     namespacePrefixes.writeStandardNamespaces(writer, m_version, message.hasMessageAddressingProperties());
+    if (m_mtomPackage) {
+        namespacePrefixes.writeNamespace(writer, KDSoapMtomPackage::xopNamespace(), QLatin1String("xop"));
+        namespacePrefixes.setMtomPackage(m_mtomPackage);
+    }
 
     QString soapEnvelope;
     QString soapEncoding;
@@ -110,7 +122,17 @@ QByteArray KDSoapMessageWriter::messageToXml(const KDSoapMessage &message, const
         // http://www.ibm.com/developerworks/webservices/library/ws-tip-namespace/index.html
         // isQualified() is only for child elements.
         writer.writeStartElement(messageNamespace, elementName);
-        message.writeElementContents(namespacePrefixes, writer, message.use(), messageNamespace);
+        const KDSoapElementWriter *elementWriter = message.elementWriter();
+        if (elementWriter && !message.isFault()) {
+            // The child values are empty when an element writer is set, so falling back to them would
+            // silently send an empty body.
+            if (message.use() != KDSoapMessage::LiteralUse) {
+                qWarning("ERROR: Message %s has an element writer, which only supports LiteralUse: no xsi:type attributes will be written", qPrintable(elementName));
+            }
+            elementWriter->writeElementContents(writer, messageNamespace);
+        } else {
+            message.writeElementContents(namespacePrefixes, writer, message.use(), messageNamespace);
+        }
         writer.writeEndElement();
     }
     writer.writeEndElement(); // Body
@@ -34,6 +34,7 @@ class KDSoapHeaders;
 class KDSoapNamespacePrefixes;
 class KDSoapValue;
 class KDSoapValueList;
+class KDSoapMtomPackage;
 
 /**
  * \internal
@@ -46,6 +47,8 @@ public:
 
     void setVersion(KDSoapClientInterface::SoapVersion version);
     void setMessageNamespace(const QString &ns);
+    // Writes the binary values as attachments of \p package, see KDSoapMtomPackage
+    void setMtomPackage(KDSoapMtomPackage *package);
 
     QByteArray messageToXml(const KDSoapMessage &message, const QString &method /*empty in document style*/,
                             const KDSoapHeaders &headers,
@@ -54,6 +57,7 @@ public:
 private:
     QString m_messageNamespace;
     KDSoapClientInterface::SoapVersion m_version;
+    KDSoapMtomPackage *m_mtomPackage;
 
 };
 
@@ -0,0 +1,323 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapMtomPackage_p.h"
+#include "KDSoapBinaryCodec.h"
+#include "KDSoapElementReader.h"
+#include <QIODevice>
+#include <QUuid>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+// Strips the angle brackets around a Content-ID, or around the start parameter which refers to one
+static QByteArray stripAngleBrackets(const QByteArray &id)
+{
+    const QByteArray trimmed = id.trimmed();
+    if (trimmed.startsWith('<') && trimmed.endsWith('>')) {
+        return trimmed.mid(1, trimmed.size() - 2);
+    }
+    return trimmed;
+}
+
+KDSoapMtomPackage::KDSoapMtomPackage()
+    : m_root(-1),
+      m_uniqueId(QUuid::createUuid().toString().mid(1, 36).toLatin1())
+{
+}
+
+QString KDSoapMtomPackage::xopNamespace()
+{
+    return QString::fromLatin1("http://www.w3.org/2004/08/xop/include");
+}
+
+bool KDSoapMtomPackage::isMultipart(const QByteArray &contentType)
+{
+    return contentType.trimmed().toLower().startsWith("multipart/related");
+}
+
+QByteArray KDSoapMtomPackage::contentTypeParameter(const QByteArray &contentType, const char *name)
+{
+    const int size = contentType.size();
+    int pos = contentType.indexOf(';');
+    while (pos != -1) {
+        const int equal = contentType.indexOf('=', pos + 1);
+        if (equal == -1) {
+            break;
+        }
+        const bool found = qstricmp(contentType.mid(pos + 1, equal - pos - 1).trimmed().constData(), name) == 0;
+        QByteArray value;
+        pos = equal + 1;
+        while (pos < size && (contentType.at(pos) == ' ' || contentType.at(pos) == '\t')) {
+            ++pos;
+        }
+        if (pos < size && contentType.at(pos) == '"') {
+            // quoted-string, with backslash escapes
+            for (++pos; pos < size && contentType.at(pos) != '"'; ++pos) {
+                if (contentType.at(pos) == '\\' && pos + 1 < size) {
+                    ++pos;
+                }
+                value += contentType.at(pos);
+            }
+            pos = contentType.indexOf(';', pos);
+        } else {
+            const int end = contentType.indexOf(';', pos);
+            value = contentType.mid(pos, end == -1 ? -1 : end - pos).trimmed();
+            pos = end;
+        }
+        if (found) {
+            return value;
+        }
+    }
+    return QByteArray();
+}
+
+bool KDSoapMtomPackage::parse(const QByteArray &contentType, const QByteArray &data)
+{
+    m_parts.clear();
+    m_root = -1;
+    if (!isMultipart(contentType)) {
+        return false;
+    }
+    const QByteArray boundary = contentTypeParameter(contentType, "boundary");
+    if (boundary.isEmpty()) {
+        return false;
+    }
+    m_data = data;
+
+    // Each part starts after a "--boundary" line; the body of a part ends with the CRLF before the next one.
+    const QByteArray delimiter = "\r\n--" + boundary;
+    int pos;
+    if (data.startsWith(delimiter.mid(2))) {
+        pos = delimiter.size() - 2;
+    } else {
+        pos = data.indexOf(delimiter); // skip the preamble
+        if (pos == -1) {
+            return false;
+        }
+        pos += delimiter.size();
+    }
+    while (qstrncmp(data.constData() + pos, "--", 2) != 0) { // "--boundary--" closes the message
+        const int lineEnd = data.indexOf("\r\n", pos);
+        const int headersEnd = lineEnd == -1 ? -1 : data.indexOf("\r\n\r\n", lineEnd);
+        if (headersEnd == -1) {
+            return false;
+        }
+        const int bodyStart = headersEnd + 4;
+        const int bodyEnd = data.indexOf(delimiter, bodyStart);
+        if (bodyEnd == -1) {
+            return false;
+        }
+        Part part;
+        part.offset = bodyStart;
+        part.length = bodyEnd - bodyStart;
+        part.base64 = false;
+        const QList<QByteArray> headers = headersEnd > lineEnd ? data.mid(lineEnd + 2, headersEnd - lineEnd - 2).split('\n') : QList<QByteArray>();
+        Q_FOREACH (const QByteArray &header, headers) {
+            const int colon = header.indexOf(':');
+            if (colon == -1) {
+                continue;
+            }
+            const QByteArray name = header.left(colon).trimmed().toLower();
+            const QByteArray value = header.mid(colon + 1).trimmed();
+            if (name == "content-id") {
+                part.contentId = stripAngleBrackets(value);
+            } else if (name == "content-transfer-encoding") {
+                part.base64 = value.toLower() == "base64";
+            } else if (name == "content-type") {
+                part.contentType = value;
+            }
+        }
+        m_parts.append(part);
+        pos = bodyEnd + delimiter.size();
+        if (pos >= data.size()) {
+            return false;
+        }
+    }
+
+    if (m_parts.isEmpty()) {
+        return false;
+    }
+
+    // The start parameter refers to the root part, which is the first one by default
+    const QByteArray start = stripAngleBrackets(contentTypeParameter(contentType, "start"));
+    m_root = 0;
+    for (int i = 0; i < m_parts.count() && !start.isEmpty(); ++i) {
+        if (m_parts.at(i).contentId == start) {
+            m_root = i;
+            break;
+        }
+    }
+
+    // The Content-Type of the root part says which envelope it holds, e.g. application/xop+xml;type="text/xml",
+    // but start-info and action are the usual places for the media type and action of the envelope.
+    m_soapContentType = contentTypeParameter(m_parts.at(m_root).contentType, "type");
+    const QByteArray startInfo = contentTypeParameter(contentType, "start-info");
+    if (!startInfo.isEmpty()) {
+        m_soapContentType = startInfo;
+    }
+    const QByteArray action = contentTypeParameter(contentType, "action");
+    if (!action.isEmpty() && contentTypeParameter(m_soapContentType, "action").isEmpty()) {
+        m_soapContentType += ";action=\"" + action + '"';
+    }
+    return true;
+}
+
+QByteArray KDSoapMtomPackage::partData(const Part &part) const
+{
+    if (part.base64) {
+        return QByteArray::fromBase64(QByteArray::fromRawData(m_data.constData() + part.offset, part.length));
+    }
+    return m_data.mid(part.offset, part.length);
+}
+
+QByteArray KDSoapMtomPackage::rootPart() const
+{
+    if (m_root == -1) {
+        return QByteArray();
+    }
+    return partData(m_parts.at(m_root));
+}
+
+QByteArray KDSoapMtomPackage::soapContentType() const
+{
+    return m_soapContentType;
+}
+
+bool KDSoapMtomPackage::isInclude(const QXmlStreamReader &reader)
+{
+    return reader.name() == QLatin1String("Include") && reader.namespaceUri() == xopNamespace();
+}
+
+const KDSoapMtomPackage::Part *KDSoapMtomPackage::readIncludedPart(QXmlStreamReader &reader) const
+{
+    // href="cid:..." holds the Content-ID of the attachment, URL-encoded (RFC 2392)
+    const QString href = reader.attributes().value(QLatin1String("href")).toString();
+    KDSoapElementReader::skipElement(reader);
+    if (href.startsWith(QLatin1String("cid:"), Qt::CaseInsensitive)) {
+        const QByteArray contentId = QByteArray::fromPercentEncoding(href.mid(4).toLatin1());
+        for (int i = 0; i < m_parts.count(); ++i) {
+            if (i != m_root && m_parts.at(i).contentId == contentId) {
+                return &m_parts.at(i);
+            }
+        }
+    }
+    reader.raiseError(QObject::tr("XOP attachment not found: %1").arg(href));
+    return 0;
+}
+
+QString KDSoapMtomPackage::readIncludeText(QXmlStreamReader &reader) const
+{
+    const Part *part = readIncludedPart(reader);
+    if (!part) {
+        return QString();
+    }
+    if (part->base64) {
+        return QString::fromLatin1(m_data.constData() + part->offset, part->length).remove(QLatin1Char('\r')).remove(QLatin1Char('\n'));
+    }
+    return KDSoapBinaryCodec::toBase64(QByteArray::fromRawData(m_data.constData() + part->offset, part->length));
+}
+
+void KDSoapMtomPackage::readInclude(QXmlStreamReader &reader, QIODevice *device) const
+{
+    const Part *part = readIncludedPart(reader);
+    if (!part) {
+        return;
+    }
+    const bool written = part->base64 ? device->write(partData(*part)) != -1
+                         : device->write(m_data.constData() + part->offset, part->length) == part->length;
+    if (!written) {
+        reader.raiseError(QObject::tr("Error writing the content of an XOP attachment: %1").arg(device->errorString()));
+    }
+}
+
+QByteArray KDSoapMtomPackage::reconstitutedRootPart() const
+{
+    QByteArray xml;
+    QXmlStreamWriter writer(&xml);
+    QXmlStreamReader reader(rootPart());
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement() && isInclude(reader)) {
+            writer.writeCharacters(readIncludeText(reader));
+        } else {
+            writer.writeCurrentToken(reader);
+        }
+    }
+    if (reader.hasError()) {
+        return rootPart(); // let the message reader report the error
+    }
+    return xml;
+}
+
+QByteArray KDSoapMtomPackage::rootContentId() const
+{
+    return "root." + m_uniqueId + "@kdsoap";
+}
+
+QByteArray KDSoapMtomPackage::attachmentContentId(int index) const
+{
+    return QByteArray::number(index + 1) + '.' + m_uniqueId + "@kdsoap";
+}
+
+void KDSoapMtomPackage::writeInclude(QXmlStreamWriter &writer, const QByteArray &data)
+{
+    writer.writeEmptyElement(xopNamespace(), QLatin1String("Include"));
+    writer.writeAttribute(QLatin1String("href"), QLatin1String("cid:") + QString::fromLatin1(attachmentContentId(m_attachments.count())));
+    m_attachments.append(data);
+}
+
+QByteArray KDSoapMtomPackage::contentType(const QByteArray &soapContentType) const
+{
+    // soapContentType is like text/xml;charset=utf-8 or application/soap+xml;charset=utf-8;action=...
+    const QByteArray mediaType = soapContentType.left(soapContentType.indexOf(';')).trimmed();
+    const QByteArray action = contentTypeParameter(soapContentType, "action");
+    QByteArray result = "multipart/related;type=\"application/xop+xml\";start=\"<" + rootContentId() + ">\";start-info=\"" + mediaType + '"';
+    if (!action.isEmpty()) {
+        result += ";action=\"" + action + '"';
+    }
+    result += ";boundary=\"MIMEBoundary_" + m_uniqueId + '"';
+    return result;
+}
+
+QByteArray KDSoapMtomPackage::toMultipart(const QByteArray &envelope, const QByteArray &soapContentType) const
+{
+    const QByteArray boundary = "--MIMEBoundary_" + m_uniqueId;
+    const QByteArray mediaType = soapContentType.left(soapContentType.indexOf(';')).trimmed();
+    int size = envelope.size() + 200;
+    Q_FOREACH (const QByteArray &attachment, m_attachments) {
+        size += attachment.size() + 200;
+    }
+    QByteArray data;
+    data.reserve(size);
+    data += boundary;
+    data += "\r\nContent-Type: application/xop+xml;charset=utf-8;type=\"" + mediaType + '"';
+    data += "\r\nContent-Transfer-Encoding: binary\r\nContent-ID: <" + rootContentId() + ">\r\n\r\n";
+    data += envelope;
+    for (int i = 0; i < m_attachments.count(); ++i) {
+        data += "\r\n" + boundary;
+        data += "\r\nContent-Type: application/octet-stream\r\nContent-Transfer-Encoding: binary\r\nContent-ID: <";
+        data += attachmentContentId(i) + ">\r\n\r\n";
+        data += m_attachments.at(i);
+    }
+    data += "\r\n" + boundary + "--\r\n";
+    return data;
+}
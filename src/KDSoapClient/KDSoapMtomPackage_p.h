@@ -0,0 +1,146 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPMTOMPACKAGE_P_H
+#define KDSOAPMTOMPACKAGE_P_H
+
+#include "KDSoapGlobal.h"
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+class QXmlStreamReader;
+class QXmlStreamWriter;
+QT_END_NAMESPACE
+
+/**
+ * \internal
+ * A SOAP message sent with MTOM (http://www.w3.org/TR/soap12-mtom/): a multipart/related
+ * MIME message whose root part is the envelope, and whose other parts hold the binary values,
+ * referenced from the envelope by xop:Include elements (http://www.w3.org/TR/xop10/).
+ * The binary values travel as they are, rather than as base64 text inside of the XML.
+ *
+ * Internal class -- only exported for the server lib
+ */
+class KDSOAP_EXPORT KDSoapMtomPackage
+{
+public:
+    KDSoapMtomPackage();
+
+    static QString xopNamespace();
+
+    /**
+     * Returns true if \p contentType, the value of a Content-Type header, is multipart/related.
+     */
+    static bool isMultipart(const QByteArray &contentType);
+
+    /**
+     * Returns the value of the parameter \p name of the Content-Type header value \p contentType,
+     * without the quotes; or an empty QByteArray if it has no such parameter.
+     */
+    static QByteArray contentTypeParameter(const QByteArray &contentType, const char *name);
+
+    /**
+     * Splits \p data, the body of a message with the Content-Type \p contentType, into its parts.
+     * Returns false if it isn't a multipart/related message, or if it is malformed.
+     */
+    bool parse(const QByteArray &contentType, const QByteArray &data);
+
+    /**
+     * Returns the root part of the parsed message, i.e. the envelope.
+     */
+    QByteArray rootPart() const;
+
+    /**
+     * Returns the Content-Type which the envelope would have had without MTOM, such as
+     * "application/soap+xml;action=...", from the parameters of the parsed message.
+     */
+    QByteArray soapContentType() const;
+
+    /**
+     * Returns the envelope with each xop:Include replaced with the base64 text of its attachment,
+     * for the readers which only know about text.
+     */
+    QByteArray reconstitutedRootPart() const;
+
+    /**
+     * Returns true if the current start element of \p reader is an xop:Include.
+     */
+    static bool isInclude(const QXmlStreamReader &reader);
+
+    /**
+     * Reads the xop:Include element \p reader is on, and returns the base64 text of its attachment,
+     * i.e. what the element would have contained without MTOM.
+     * Raises an error in \p reader if there's no such attachment.
+     */
+    QString readIncludeText(QXmlStreamReader &reader) const;
+
+    /**
+     * Reads the xop:Include element \p reader is on, and writes the data of its attachment to \p device.
+     * Raises an error in \p reader if there's no such attachment or if writing fails.
+     */
+    void readInclude(QXmlStreamReader &reader, QIODevice *device) const;
+
+    /**
+     * Adds \p data as a new attachment, and writes an xop:Include element referring to it.
+     */
+    void writeInclude(QXmlStreamWriter &writer, const QByteArray &data);
+
+    /**
+     * Returns the Content-Type of the message created by toMultipart();
+     * \p soapContentType is the one the envelope would have had without MTOM.
+     */
+    QByteArray contentType(const QByteArray &soapContentType) const;
+
+    /**
+     * Returns the body of the message: the root part holding \p envelope,
+     * followed by the attachments added by writeInclude().
+     */
+    QByteArray toMultipart(const QByteArray &envelope, const QByteArray &soapContentType) const;
+
+private:
+    struct Part {
+        QByteArray contentId;
+        QByteArray contentType;
+        int offset;
+        int length;
+        bool base64;
+    };
+    QByteArray partData(const Part &part) const;
+    const Part *readIncludedPart(QXmlStreamReader &reader) const;
+    QByteArray rootContentId() const;
+    QByteArray attachmentContentId(int index) const;
+
+    // Parsed message
+    QByteArray m_data;
+    QList<Part> m_parts;
+    int m_root;
+    QByteArray m_soapContentType;
+
+    // Message being written
+    QByteArray m_uniqueId;
+    QList<QByteArray> m_attachments;
+};
+
+#endif // KDSOAPMTOMPACKAGE_P_H
@@ -28,9 +28,16 @@
 
 #include "KDSoapClientInterface.h"
 
+class KDSoapMtomPackage;
+
 class KDSoapNamespacePrefixes : public QMap<QString /*ns*/, QString /*prefix*/>
 {
 public:
+    KDSoapNamespacePrefixes()
+        : m_mtomPackage(0)
+    {
+    }
+
     void writeStandardNamespaces(QXmlStreamWriter &writer,
                                  KDSoapClientInterface::SoapVersion version = KDSoapClientInterface::SOAP1_1,
                                  bool messageAddressingEnabled = false);
@@ -49,6 +56,19 @@ public:
         }
         return prefix + QLatin1Char(':') + localName;
     }
+
+    // When sending with MTOM, the binary values are written as attachments of this package
+    void setMtomPackage(KDSoapMtomPackage *package)
+    {
+        m_mtomPackage = package;
+    }
+    KDSoapMtomPackage *mtomPackage() const
+    {
+        return m_mtomPackage;
+    }
+
+private:
+    KDSoapMtomPackage *m_mtomPackage;
 };
 
 #endif // KDSOAPNAMESPACESPREFIXES_H
@@ -24,6 +24,7 @@
 #include "KDSoapPendingCall_p.h"
 #include "KDSoapNamespaceManager.h"
 #include "KDSoapMessageReader_p.h"
+#include "KDSoapMtomPackage_p.h"
 #include <QNetworkReply>
 #include <QDebug>
 
@@ -117,6 +118,16 @@ void KDSoapPendingCall::Private::parseReply()
 
     if (!data.isEmpty()) {
         KDSoapMessageReader reader;
-        reader.xmlToMessage(data, &replyMessage, 0, &replyHeaders);
+        reader.setArenaAllocation(arenaAllocation);
+        reader.setBinaryElementHandler(binaryElementHandler);
+        KDSoapMtomPackage mtomPackage;
+        if (mtomPackage.parse(reply->rawHeader("Content-Type"), data)) {
+            reader.setMtomPackage(&mtomPackage);
+            // The element readers only know about text, give them the attachments as base64 text
+            const QByteArray envelope = bodyReader ? mtomPackage.reconstitutedRootPart() : mtomPackage.rootPart();
+            reader.xmlToMessage(envelope, &replyMessage, 0, &replyHeaders, bodyReader);
+        } else {
+            reader.xmlToMessage(data, &replyMessage, 0, &replyHeaders, bodyReader);
+        }
     }
 }
@@ -33,12 +33,14 @@ QT_BEGIN_NAMESPACE
 class QNetworkReply;
 QT_END_NAMESPACE
 class KDSoapValue;
+class KDSoapElementReader;
+class KDSoapBinaryElementHandler;
 
 class KDSoapPendingCall::Private : public QSharedData
 {
 public:
     Private(QNetworkReply *r, QBuffer *b)
-        : reply(r), buffer(b), parsed(false)
+        : reply(r), buffer(b), bodyReader(0), arenaAllocation(false), binaryElementHandler(0), parsed(false)
     {
     }
     ~Private();
@@ -52,6 +54,12 @@ public:
     QBuffer *buffer;
     KDSoapMessage replyMessage;
     KDSoapHeaders replyHeaders;
+    // Reads the body of the reply instead of replyMessage, see KDSoapClientInterface::call
+    KDSoapElementReader *bodyReader;
+    // See KDSoapClientInterface::setArenaAllocation
+    bool arenaAllocation;
+    // See KDSoapClientInterface::setBinaryElementHandler
+    KDSoapBinaryElementHandler *binaryElementHandler;
     bool parsed;
 };
 
@@ -21,30 +21,185 @@
 **
 **********************************************************************/
 #include "KDSoapValue.h"
+#include "KDSoapBinaryCodec.h"
 #include "KDSoapNamespacePrefixes_p.h"
+#include "KDSoapValueArena_p.h"
+#include "KDSoapMtomPackage_p.h"
 #include "KDSoapNamespaceManager.h"
 #include "KDDateTime.h"
+#include "KDDateTime_p.h"
 #include <QDateTime>
 #include <QUrl>
+#include <QAtomicPointer>
 #include <QDebug>
+#include <stdlib.h>
 
+Q_GLOBAL_STATIC(KDSoapValueList, s_emptyChildValues)
+
+// Stored before each KDSoapValue::Private allocated from an arena, to know where to give its memory back
+union KDSoapValueAllocationHeader {
+    KDSoapValueArena *arena;
+    double alignment;
+};
+
+// Most values in a message are leaves, like <id>42</id>, so the child values
+// (a KDSoapValueList, with its attributes and array type) are only allocated when used.
+// Scalars are stored inline in the QVariant, and the strings are implicitly shared,
+// e.g. KDSoapMessageReader uses the same QString for all the elements with the same name.
 class KDSoapValue::Private : public QSharedData
 {
 public:
-    Private(): m_qualified(false), m_nillable(false) {}
+    Private(): m_qualified(false), m_nillable(false), m_inArena(false), m_childValues(0) {}
     Private(const QString &n, const QVariant &v, const QString &typeNameSpace, const QString &typeName)
-        : m_name(n), m_value(v), m_typeNamespace(typeNameSpace), m_typeName(typeName), m_qualified(false), m_nillable(false) {}
+        : m_qualified(false), m_nillable(false), m_inArena(false), m_name(n), m_value(v), m_typeNamespace(typeNameSpace), m_typeName(typeName), m_childValues(0) {}
+    Private(const Private &other)
+        : QSharedData(other),
+          m_qualified(other.m_qualified),
+          m_nillable(other.m_nillable),
+          m_inArena(false),
+          m_name(other.m_name),
+          m_nameNamespace(other.m_nameNamespace),
+          m_value(other.m_value),
+          m_typeNamespace(other.m_typeNamespace),
+          m_typeName(other.m_typeName),
+          m_childValues(0)
+    {
+        const KDSoapValueList *children = other.loadChildValues();
+        if (children) {
+            m_childValues = new KDSoapValueList(*children);
+        }
+    }
+    ~Private()
+    {
+        delete loadChildValues();
+    }
+
+    KDSoapValueList *loadChildValues() const
+    {
+#if QT_VERSION >= 0x050000
+        return m_childValues.loadAcquire();
+#else
+        return m_childValues;
+#endif
+    }
 
+    // Read-only access, doesn't allocate anything
+    const KDSoapValueList &constChildValues() const
+    {
+        const KDSoapValueList *children = loadChildValues();
+        return children ? *children : *s_emptyChildValues();
+    }
+
+    // Allocates the child values on first use. This is thread-safe,
+    // since values shared between threads can be read using childValues() const.
+    KDSoapValueList &childValues()
+    {
+        KDSoapValueList *children = loadChildValues();
+        if (!children) {
+            children = new KDSoapValueList;
+            if (!m_childValues.testAndSetOrdered(0, children)) {
+                delete children;
+                children = loadChildValues();
+            }
+        }
+        return *children;
+    }
+
+    // First, to use the padding after the reference count of QSharedData
+    bool m_qualified : 1;
+    bool m_nillable : 1;
+    bool m_inArena : 1; // set by KDSoapValueArena::createValue(), then there's a header before this
     QString m_name;
     QString m_nameNamespace;
     QVariant m_value;
     QString m_typeNamespace;
     QString m_typeName;
-    KDSoapValueList m_childValues;
-    bool m_qualified;
-    bool m_nillable;
+    QAtomicPointer<KDSoapValueList> m_childValues;
+
+    static void *operator new(size_t size)
+    {
+        return ::operator new(size);
+    }
+    static void *operator new(size_t size, KDSoapValueArena *arena)
+    {
+        KDSoapValueAllocationHeader *header = static_cast<KDSoapValueAllocationHeader *>(arena->allocate(sizeof(KDSoapValueAllocationHeader) + size));
+        header->arena = arena;
+        return header + 1;
+    }
+    static void operator delete(void *ptr)
+    {
+        // The destructor leaves the bit-fields alone, so the flag can still be read here
+        if (static_cast<Private *>(ptr)->m_inArena) {
+            KDSoapValueAllocationHeader *header = static_cast<KDSoapValueAllocationHeader *>(ptr) - 1;
+            header->arena->release();
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+    static void operator delete(void *, KDSoapValueArena *arena)
+    {
+        // Only called if the constructor throws, before m_inArena is set
+        arena->release();
+    }
+
+private:
+    Private &operator=(const Private &);
+};
+
+struct KDSoapValueArena::Block {
+    Block *next;
+    double alignment;
 };
 
+static const size_t s_arenaBlockSize = 64 * 1024;
+
+KDSoapValueArena::KDSoapValueArena()
+    : m_blocks(0), m_current(0), m_available(0), m_ref(1)
+{
+}
+
+KDSoapValueArena::~KDSoapValueArena()
+{
+    while (m_blocks) {
+        Block *next = m_blocks->next;
+        ::free(m_blocks);
+        m_blocks = next;
+    }
+}
+
+void *KDSoapValueArena::allocate(size_t size)
+{
+    size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+    if (size > m_available) {
+        const size_t blockSize = qMax(s_arenaBlockSize, sizeof(Block) + size);
+        Block *block = static_cast<Block *>(::malloc(blockSize));
+        Q_CHECK_PTR(block);
+        block->next = m_blocks;
+        m_blocks = block;
+        m_current = reinterpret_cast<char *>(block) + sizeof(Block);
+        m_available = blockSize - sizeof(Block);
+    }
+    void *ptr = m_current;
+    m_current += size;
+    m_available -= size;
+    m_ref.ref();
+    return ptr;
+}
+
+void KDSoapValueArena::release()
+{
+    if (!m_ref.deref()) {
+        delete this;
+    }
+}
+
+KDSoapValue KDSoapValueArena::createValue(const QString &name)
+{
+    KDSoapValue::Private *d = new (this) KDSoapValue::Private(name, QVariant(), QString(), QString());
+    d->m_inArena = true;
+    return KDSoapValue(d);
+}
+
 uint qHash(const KDSoapValue &value)
 {
     return qHash(value.name());
@@ -63,7 +218,7 @@ KDSoapValue::KDSoapValue(const QString &n, const QVariant &v, const QString &typ
 KDSoapValue::KDSoapValue(const QString &n, const KDSoapValueList &children, const QString &typeNameSpace, const QString &typeName)
     : d(new Private(n, QVariant(), typeNameSpace, typeName))
 {
-    d->m_childValues = children;
+    d->m_childValues = new KDSoapValueList(children);
 }
 
 KDSoapValue::~KDSoapValue()
@@ -75,6 +230,11 @@ KDSoapValue::KDSoapValue(const KDSoapValue &other)
 {
 }
 
+KDSoapValue::KDSoapValue(Private *dd)
+    : d(dd)
+{
+}
+
 bool KDSoapValue::isNull() const
 {
     return d->m_name.isEmpty() && isNil();
@@ -82,7 +242,8 @@ bool KDSoapValue::isNull() const
 
 bool KDSoapValue::isNil() const
 {
-    return d->m_value.isNull() && d->m_childValues.isEmpty() && d->m_childValues.attributes().isEmpty();
+    const KDSoapValueList &children = d->constChildValues();
+    return d->m_value.isNull() && children.isEmpty() && children.attributes().isEmpty();
 }
 
 void KDSoapValue::setNillable(bool nillable)
@@ -118,7 +279,7 @@ void KDSoapValue::setQualified(bool qualified)
 KDSoapValueList &KDSoapValue::childValues() const
 {
     // I want to fool the QSharedDataPointer mechanism here...
-    return const_cast<KDSoapValueList &>(d->m_childValues);
+    return const_cast<Private *>(d.constData())->childValues();
 }
 
 bool KDSoapValue::operator ==(const KDSoapValue &other) const
@@ -131,7 +292,13 @@ bool KDSoapValue::operator !=(const KDSoapValue &other) const
     return d != other.d;
 }
 
-static QString variantToTextValue(const QVariant &value, const QString &typeNs, const QString &type)
+static bool isHexBinary(const QString &typeNs, const QString &type)
+{
+    return (typeNs == KDSoapNamespaceManager::xmlSchema1999() || typeNs == KDSoapNamespaceManager::xmlSchema2001())
+           && type == QLatin1String("hexBinary");
+}
+
+QString KDSoapValue::variantToTextValue(const QVariant &value, const QString &typeNs, const QString &type)
 {
     switch (value.userType()) {
     case QVariant::Char:
@@ -143,15 +310,11 @@ static QString variantToTextValue(const QVariant &value, const QString &typeNs,
         return value.toUrl().toString();
     case QVariant::ByteArray: {
         const QByteArray data = value.toByteArray();
-        if (typeNs == KDSoapNamespaceManager::xmlSchema1999() || typeNs == KDSoapNamespaceManager::xmlSchema2001()) {
-            if (type == QLatin1String("hexBinary")) {
-                const QByteArray hb = data.toHex();
-                return QString::fromLatin1(hb.constData(), hb.size());
-            }
+        if (isHexBinary(typeNs, type)) {
+            return KDSoapBinaryCodec::toHex(data);
         }
         // default to base64Binary, like variantToXMLType() does.
-        const QByteArray b64 = value.toByteArray().toBase64();
-        return QString::fromLatin1(b64.constData(), b64.size());
+        return KDSoapBinaryCodec::toBase64(data);
     }
     case QVariant::Int:
     // fall-through
@@ -167,15 +330,17 @@ static QString variantToTextValue(const QVariant &value, const QString &typeNs,
         return value.toString();
     case QVariant::Time: {
         const QTime time = value.toTime();
-        if (time.msec()) {
-            // include milli-seconds
-            return time.toString(QLatin1String("hh:mm:ss.zzz"));
-        } else {
-            return time.toString(Qt::ISODate);
-        }
+        QChar buffer[KDDateTimeFormat::MaxTimeLength];
+        // include milli-seconds if set
+        const int length = KDDateTimeFormat::writeTime(time, time.msec() != 0, buffer);
+        return QString(buffer, length);
+    }
+    case QVariant::Date: {
+        const QDate date = value.toDate();
+        QChar buffer[KDDateTimeFormat::MaxDateLength];
+        const int length = KDDateTimeFormat::writeDate(date, buffer);
+        return length ? QString(buffer, length) : date.toString(Qt::ISODate);
     }
-    case QVariant::Date:
-        return value.toDate().toString(Qt::ISODate);
     case QVariant::DateTime: // http://www.w3.org/TR/xmlschema-2/#dateTime
         return KDDateTime(value.toDateTime()).toDateString();
     case QVariant::Invalid:
@@ -287,7 +452,7 @@ void KDSoapValue::writeElementContents(KDSoapNamespacePrefixes &namespacePrefixe
         }
 
         // cppcheck-suppress redundantCopyLocalConst
-        const KDSoapValueList list = this->childValues();
+        const KDSoapValueList &list = d->constChildValues();
         const bool isArray = !list.arrayType().isEmpty();
         if (isArray) {
             writer.writeAttribute(KDSoapNamespaceManager::soapEncoding(), QLatin1String("arrayType"), namespacePrefixes.resolve(list.arrayTypeNs(), list.arrayType()) + QLatin1Char('[') + QString::number(list.count()) + QLatin1Char(']'));
@@ -296,13 +461,18 @@ void KDSoapValue::writeElementContents(KDSoapNamespacePrefixes &namespacePrefixe
     writeChildren(namespacePrefixes, writer, use, messageNamespace, false);
 
     if (!value.isNull()) {
-        writer.writeCharacters(variantToTextValue(value, this->typeNs(), this->type()));
+        KDSoapMtomPackage *mtomPackage = namespacePrefixes.mtomPackage();
+        if (mtomPackage && value.userType() == QVariant::ByteArray && !isHexBinary(this->typeNs(), this->type())) {
+            mtomPackage->writeInclude(writer, value.toByteArray());
+        } else {
+            writer.writeCharacters(variantToTextValue(value, this->typeNs(), this->type()));
+        }
     }
 }
 
 void KDSoapValue::writeChildren(KDSoapNamespacePrefixes &namespacePrefixes, QXmlStreamWriter &writer, KDSoapValue::Use use, const QString &messageNamespace, bool forceQualified) const
 {
-    const KDSoapValueList &args = childValues();
+    const KDSoapValueList &args = d->constChildValues();
     Q_FOREACH (const KDSoapValue &attr, args.attributes()) {
         //Q_ASSERT(!attr.value().isNull());
 
@@ -375,6 +545,16 @@ KDSoapValue KDSoapValueList::child(const QString &name) const
     return KDSoapValue();
 }
 
+QHash<QString, KDSoapValue> KDSoapValueList::childrenByName() const
+{
+    QHash<QString, KDSoapValue> children;
+    children.reserve(count());
+    for (int i = count() - 1; i >= 0; --i) {
+        children.insert(at(i).name(), at(i)); // the first match wins
+    }
+    return children;
+}
+
 void KDSoapValueList::setArrayType(const QString &nameSpace, const QString &type)
 {
     m_arrayType = qMakePair(nameSpace, type);
@@ -390,6 +570,11 @@ QString KDSoapValueList::arrayType() const
     return m_arrayType.second;
 }
 
+void KDSoapValueList::reserveAttributes(int attributes)
+{
+    m_attributes.reserve(attributes);
+}
+
 void KDSoapValueList::addArgument(const QString &argumentName, const QVariant &argumentValue, const QString &typeNameSpace, const QString &typeName)
 {
     append(KDSoapValue(argumentName, argumentValue, typeNameSpace, typeName));
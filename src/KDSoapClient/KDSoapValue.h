@@ -26,6 +26,7 @@
 #include <QtCore/QString>
 #include <QtCore/QVariant>
 #include <QtCore/QList>
+#include <QtCore/QHash>
 #include <QtCore/QPair>
 #include <QtCore/QSet>
 #include <QtCore/QVector>
@@ -242,11 +243,15 @@ private:
     KDSoapValue(QString, QString, QString);
 
     friend class KDSoapMessageWriter;
+    friend class KDSoapElementWriter;
+    friend class KDSoapValueArena;
+    static QString variantToTextValue(const QVariant &value, const QString &typeNs, const QString &type);
     void writeElement(KDSoapNamespacePrefixes &namespacePrefixes, QXmlStreamWriter &writer, KDSoapValue::Use use, const QString &messageNamespace, bool forceQualified) const;
     void writeElementContents(KDSoapNamespacePrefixes &namespacePrefixes, QXmlStreamWriter &writer, KDSoapValue::Use use, const QString &messageNamespace) const;
     void writeChildren(KDSoapNamespacePrefixes &namespacePrefixes, QXmlStreamWriter &writer, KDSoapValue::Use use, const QString &messageNamespace, bool forceQualified) const;
 
     class Private;
+    explicit KDSoapValue(Private *dd);
     QSharedDataPointer<Private> d;
 };
 
@@ -301,10 +306,22 @@ public:
      * If multiple arguments have the same name, the first match is returned.
      * This method mostly makes sense for the case where only one argument uses \p name.
      *
+     * This goes through the list, use childrenByName() to look up many children of a large list.
+     *
      * If no such argument can be found, returns a null KDSoapValue.
      */
     KDSoapValue child(const QString &name) const;
 
+    /**
+     * Returns the children by name, with the first match for names used by several children,
+     * like child() does. Building it takes one pass over the list, then each lookup takes
+     * constant time, so use it instead of child() to read many fields of a large structure.
+     *
+     * The returned hash is a snapshot: it doesn't follow later changes to the list.
+     * \since 1.7
+     */
+    QHash<QString, KDSoapValue> childrenByName() const;
+
     /**
      * Sets the type of the elements in this array.
      *
@@ -323,6 +340,13 @@ public:
      */
     QString arrayType() const;
 
+    /**
+     * Reserves space for \p attributes attributes, to avoid reallocations when appending many of them.
+     * Use reserve() for the child elements, e.g. for large arrays.
+     * \since 1.7
+     */
+    void reserveAttributes(int attributes);
+
     /**
      * Returns the list of attributes. Just like the QList which is KDSoapValueList contains
      * the child elements for a parent XML element; the attributes QList is the attributes
@@ -0,0 +1,73 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPVALUEARENA_P_H
+#define KDSOAPVALUEARENA_P_H
+
+#include "KDSoapValue.h"
+#include <QtCore/QAtomicInt>
+
+/**
+ * \internal
+ * Monotonic allocator for the KDSoapValues of a parsed message.
+ *
+ * The values are allocated one after the other in large blocks, and freeing a value
+ * only decrements a counter. The blocks are released all at once when the last value
+ * allocated from them is destroyed, which can be long after the message itself.
+ *
+ * Allocating is not thread-safe, it is meant to be used by a single KDSoapMessageReader;
+ * the values can then be destroyed from any thread.
+ */
+class KDSoapValueArena
+{
+public:
+    KDSoapValueArena();
+
+    /**
+     * Creates a value in the arena.
+     */
+    KDSoapValue createValue(const QString &name);
+
+    /**
+     * Releases the reference held by the creator of the arena.
+     */
+    void release();
+
+    /**
+     * Allocates \p size bytes, for KDSoapValue's private data.
+     * The memory is never freed individually, call release() for each allocation instead.
+     */
+    void *allocate(size_t size);
+
+private:
+    ~KDSoapValueArena();
+
+    struct Block;
+    Block *m_blocks;
+    char *m_current;
+    size_t m_available;
+    QAtomicInt m_ref;
+
+    Q_DISABLE_COPY(KDSoapValueArena)
+};
+
+#endif // KDSOAPVALUEARENA_P_H
@@ -29,11 +29,13 @@
 class KDSoapDelayedResponseHandleData : public QSharedData
 {
 public:
-    KDSoapDelayedResponseHandleData(KDSoapServerSocket *s)
-        : socket(s)
+    KDSoapDelayedResponseHandleData(KDSoapServerSocket *s, int id = 0)
+        : socket(s), responseId(id)
     {}
     // QPointer in case the client disconnects during a delayed response
     QPointer<KDSoapServerSocket> socket;
+    // In case the delayed response timed out, and the socket moved on to another call
+    int responseId;
 };
 
 KDSoapDelayedResponseHandle::KDSoapDelayedResponseHandle() : data(new KDSoapDelayedResponseHandleData(0))
@@ -59,10 +61,14 @@ KDSoapDelayedResponseHandle::~KDSoapDelayedResponseHandle()
 KDSoapDelayedResponseHandle::KDSoapDelayedResponseHandle(KDSoapServerSocket *socket)
     : data(new KDSoapDelayedResponseHandleData(socket))
 {
-    socket->setResponseDelayed();
+    data->responseId = socket->setResponseDelayed();
 }
 
 KDSoapServerSocket *KDSoapDelayedResponseHandle::serverSocket() const
 {
-    return data->socket;
+    KDSoapServerSocket *socket = data->socket;
+    if (socket && !socket->isWaitingForDelayedResponse(data->responseId)) {
+        return 0; // expired, see KDSoapServer::setDelayedResponseTimeout
+    }
+    return socket;
 }
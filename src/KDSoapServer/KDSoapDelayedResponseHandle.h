@@ -50,7 +50,7 @@ public:
 private:
     friend class KDSoapServerObjectInterface;
     explicit KDSoapDelayedResponseHandle(KDSoapServerSocket *socket);
-    KDSoapServerSocket *serverSocket() const;
+    KDSoapServerSocket *serverSocket() const; // 0 if the socket is gone or the response expired
     QSharedDataPointer<KDSoapDelayedResponseHandleData> data;
 };
 
@@ -23,8 +23,9 @@
 #include "KDSoapServer.h"
 #include "KDSoapThreadPool.h"
 #include "KDSoapSocketList_p.h"
+#include "KDSoapServerLogger_p.h"
+#include "KDSoapServerMetrics_p.h"
 #include <QMutex>
-#include <QFile>
 #ifdef Q_OS_UNIX
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -39,9 +40,12 @@ public:
         : m_threadPool(0),
           m_mainThreadSocketList(0),
           m_use(KDSoapMessage::LiteralUse),
-          m_logLevel(KDSoapServer::LogNothing),
+          m_logLevel(int(KDSoapServer::LogNothing)),
+          m_logFormat(int(KDSoapServer::LogPlainText)),
           m_path(QString::fromLatin1("/")),
           m_maxConnections(-1),
+          m_delayedResponseTimeout(0),
+          m_delayedResponseTimeoutCount(0),
           m_portBeforeSuspend(0)
     {
     }
@@ -56,16 +60,23 @@ public:
     KDSoapMessage::Use m_use;
     KDSoapServer::Features m_features;
 
-    QMutex m_logMutex;
-    KDSoapServer::LogLevel m_logLevel;
-    QString m_logFileName;
-    QFile m_logFile;
+    QAtomicInt m_logLevel; // KDSoapServer::LogLevel, read without locking on every call
+    QAtomicInt m_logFormat; // KDSoapServer::LogFormat
+    KDSoapServerLogger m_logger;
 
     QMutex m_serverDataMutex;
     QString m_wsdlFile;
     QString m_wsdlPathInUrl;
     QString m_path;
+    QString m_metricsPath;
     int m_maxConnections;
+    int m_delayedResponseTimeout;
+    QAtomicInt m_delayedResponseTimeoutCount;
+
+    // One per thread handling connections for this server, see KDSoapSocketList.
+    // Shared with the socket lists, which outlive the server when using a thread pool.
+    mutable QMutex m_threadMetricsMutex;
+    QList<QSharedPointer<KDSoapServerMetrics> > m_threadMetrics;
 
     QHostAddress m_addressBeforeSuspend;
     quint16 m_portBeforeSuspend;
@@ -178,58 +189,81 @@ KDSoapMessage::Use KDSoapServer::use() const
 
 void KDSoapServer::setLogLevel(KDSoapServer::LogLevel level)
 {
-    QMutexLocker lock(&d->m_logMutex);
-    d->m_logLevel = level;
+    d->m_logLevel.fetchAndStoreOrdered(level);
+    if (level != KDSoapServer::LogNothing) {
+        d->m_logger.startLogging();
+    }
 }
 
 KDSoapServer::LogLevel KDSoapServer::logLevel() const
 {
-    QMutexLocker lock(&d->m_logMutex);
-    return d->m_logLevel;
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+    return static_cast<KDSoapServer::LogLevel>(d->m_logLevel.loadAcquire());
+#else
+    return static_cast<KDSoapServer::LogLevel>(int(d->m_logLevel));
+#endif
+}
+
+void KDSoapServer::setLogFormat(KDSoapServer::LogFormat format)
+{
+    d->m_logFormat.fetchAndStoreOrdered(format);
+}
+
+KDSoapServer::LogFormat KDSoapServer::logFormat() const
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+    return static_cast<KDSoapServer::LogFormat>(d->m_logFormat.loadAcquire());
+#else
+    return static_cast<KDSoapServer::LogFormat>(int(d->m_logFormat));
+#endif
 }
 
 void KDSoapServer::setLogFileName(const QString &fileName)
 {
-    QMutexLocker lock(&d->m_logMutex);
-    d->m_logFileName = fileName;
+    d->m_logger.setFileName(fileName);
 }
 
 QString KDSoapServer::logFileName() const
 {
-    QMutexLocker lock(&d->m_logMutex);
-    return d->m_logFileName;
+    return d->m_logger.fileName();
+}
+
+void KDSoapServer::setMaxLogQueueSize(int bytes)
+{
+    d->m_logger.setMaxQueuedBytes(bytes);
+}
+
+int KDSoapServer::maxLogQueueSize() const
+{
+    return d->m_logger.maxQueuedBytes();
+}
+
+int KDSoapServer::droppedLogEntryCount() const
+{
+    return d->m_logger.droppedCount();
+}
+
+void KDSoapServer::resetDroppedLogEntryCount()
+{
+    d->m_logger.resetDroppedCount();
 }
 
 void KDSoapServer::log(const QByteArray &text)
 {
-    if (d->m_logLevel == KDSoapServer::LogNothing) {
+    if (logLevel() == KDSoapServer::LogNothing) {
         return;
     }
-
-    QMutexLocker lock(&d->m_logMutex);
-    if (!d->m_logFile.isOpen() && !d->m_logFileName.isEmpty()) {
-        d->m_logFile.setFileName(d->m_logFileName);
-        if (!d->m_logFile.open(QIODevice::Append)) {
-            qCritical("Could not open log file for writing: %s", qPrintable(d->m_logFileName));
-            d->m_logFileName.clear(); // don't retry every time log() is called
-            return;
-        }
-    }
-    d->m_logFile.write(text);
+    d->m_logger.log(text);
 }
 
 void KDSoapServer::flushLogFile()
 {
-    if (d->m_logFile.isOpen()) {
-        d->m_logFile.flush();
-    }
+    d->m_logger.flush();
 }
 
 void KDSoapServer::closeLogFile()
 {
-    if (d->m_logFile.isOpen()) {
-        d->m_logFile.close();
-    }
+    d->m_logger.close();
 }
 
 bool KDSoapServer::setExpectedSocketCount(int sockets)
@@ -339,6 +373,79 @@ QString KDSoapServer::path() const
     return d->m_path;
 }
 
+void KDSoapServer::setDelayedResponseTimeout(int msecs)
+{
+    QMutexLocker lock(&d->m_serverDataMutex);
+    d->m_delayedResponseTimeout = msecs;
+}
+
+int KDSoapServer::delayedResponseTimeout() const
+{
+    QMutexLocker lock(&d->m_serverDataMutex);
+    return d->m_delayedResponseTimeout;
+}
+
+int KDSoapServer::delayedResponseTimeoutCount() const
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+    return d->m_delayedResponseTimeoutCount.loadAcquire();
+#else
+    return d->m_delayedResponseTimeoutCount;
+#endif
+}
+
+void KDSoapServer::resetDelayedResponseTimeoutCount()
+{
+    d->m_delayedResponseTimeoutCount.fetchAndStoreOrdered(0);
+}
+
+void KDSoapServer::delayedResponseTimedOut()
+{
+    d->m_delayedResponseTimeoutCount.ref();
+}
+
+void KDSoapServer::setMetricsPath(const QString &path)
+{
+    QMutexLocker lock(&d->m_serverDataMutex);
+    d->m_metricsPath = path;
+}
+
+QString KDSoapServer::metricsPath() const
+{
+    QMutexLocker lock(&d->m_serverDataMutex);
+    return d->m_metricsPath;
+}
+
+QSharedPointer<KDSoapServerMetrics> KDSoapServer::createThreadMetrics()
+{
+    QSharedPointer<KDSoapServerMetrics> metrics(new KDSoapServerMetrics);
+    QMutexLocker lock(&d->m_threadMetricsMutex);
+    d->m_threadMetrics.append(metrics);
+    return metrics;
+}
+
+QByteArray KDSoapServer::metrics() const
+{
+    KDSoapServerMetrics::Data total;
+    int threadCount = 0;
+    int busyThreadCount = 0;
+    {
+        QMutexLocker lock(&d->m_threadMetricsMutex);
+        Q_FOREACH (const QSharedPointer<KDSoapServerMetrics> &threadMetrics, d->m_threadMetrics) {
+            const KDSoapServerMetrics::Data data = threadMetrics->snapshot();
+            if (data.connectedSockets > 0) {
+                ++threadCount;
+            }
+            if (data.activeRequests > data.delayedResponses) {
+                ++busyThreadCount;
+            }
+            total.add(data);
+        }
+    }
+    const int maxThreadCount = d->m_threadPool ? d->m_threadPool->maxThreadCount() : 0;
+    return KDSoapServerMetrics::toPrometheusText(total, threadCount, busyThreadCount, maxThreadCount);
+}
+
 void KDSoapServer::setMaxConnections(int sockets)
 {
     QMutexLocker lock(&d->m_serverDataMutex);
@@ -27,8 +27,10 @@
 #include <KDSoapClient/KDSoapMessage.h>
 #include <QtNetwork/QTcpServer>
 #include <QtNetwork/QSslConfiguration>
+#include <QtCore/QSharedPointer>
 
 class KDSoapThreadPool;
+class KDSoapServerMetrics;
 
 /**
  * HTTP soap server.
@@ -142,9 +144,10 @@ public:
      *  <li>LogEveryCall: log every call, successful or not.</li>
      * </ul>
      *
-     * Warning: enabling logging reduces performance severely. Not only
-     * because of the time spent logging, but also because the threads can
-     * only write one at a time to the file, to avoid mixed output.
+     * Log lines are queued without locking and written to the file in batches
+     * by a background thread, so logging doesn't serialize the worker threads.
+     * If the writer can't keep up, lines are dropped once the queue exceeds
+     * maxLogQueueSize(), see droppedLogEntryCount().
      */
     void setLogLevel(LogLevel level);
     /**
@@ -152,6 +155,26 @@ public:
      */
     LogLevel logLevel() const;
 
+    enum LogFormat { LogPlainText, LogJsonLines };
+    /**
+     * Sets the format of the log lines:
+     * <ul>
+     *  <li>LogPlainText: "CALL method" or "FAULT method -- fault string" (the default).</li>
+     *  <li>LogJsonLines: one JSON object per line, with the peer address, method, soapAction,
+     *      request and response sizes (in bytes), the fault string if any, and the time spent
+     *      (in microseconds) parsing the HTTP headers ("headers"), parsing the XML ("parse"),
+     *      in processRequest ("dispatch"), serializing the response ("serialize"), writing it to
+     *      the socket ("write"), and in total since the first byte of the request was received ("total").</li>
+     * </ul>
+     * \since 1.7
+     */
+    void setLogFormat(LogFormat format);
+    /**
+     * Returns the format of the log lines set by setLogFormat.
+     * \since 1.7
+     */
+    LogFormat logFormat() const;
+
     /**
      * Sets the name of the file where logging should go.
      * The server always appends to this file, you should delete it
@@ -165,12 +188,39 @@ public:
     QString logFileName() const;
 
     /**
-     * Force flushing the log file to disk.
+     * Sets the maximum amount of log data, in bytes, that can be waiting to be
+     * written to the log file. Log lines arriving while the queue is full are dropped.
+     * The default is 16 MB.
+     * \since 1.7
+     */
+    void setMaxLogQueueSize(int bytes);
+
+    /**
+     * Returns the value given to setMaxLogQueueSize().
+     * \since 1.7
+     */
+    int maxLogQueueSize() const;
+
+    /**
+     * Returns the number of log lines that were dropped because the log queue
+     * was full, since the last call to resetDroppedLogEntryCount().
+     * \since 1.7
+     */
+    int droppedLogEntryCount() const;
+
+    /**
+     * Resets droppedLogEntryCount to 0.
+     * \since 1.7
+     */
+    void resetDroppedLogEntryCount();
+
+    /**
+     * Force writing out all pending log lines, and flushing the log file to disk.
      */
     void flushLogFile();
 
     /**
-     * Close the log file. This can be used to then rename it, in order to
+     * Write out all pending log lines, and close the log file. This can be used to then rename it, in order to
      * implement log file rotation.
      */
     void closeLogFile();
@@ -241,6 +291,66 @@ public:
      */
     QString wsdlPathInUrl() const;
 
+    /**
+     * Sets the maximum time, in milliseconds, that the server waits for a delayed
+     * response (see KDSoapServerObjectInterface::prepareDelayedResponse).
+     * When it expires, the client receives a "Server.Timeout" fault, the socket
+     * can be used for new requests again, and any later call to sendDelayedResponse()
+     * for that request is ignored.
+     *
+     * The default value, 0, means no timeout: the socket stays blocked until
+     * the delayed response is sent or the client disconnects.
+     * \since 1.7
+     */
+    void setDelayedResponseTimeout(int msecs);
+
+    /**
+     * \returns the timeout set by setDelayedResponseTimeout
+     * \since 1.7
+     */
+    int delayedResponseTimeout() const;
+
+    /**
+     * Returns the number of delayed responses that timed out since the
+     * last call to resetDelayedResponseTimeoutCount().
+     * \since 1.7
+     */
+    int delayedResponseTimeoutCount() const;
+
+    /**
+     * Resets delayedResponseTimeoutCount to 0.
+     * \since 1.7
+     */
+    void resetDelayedResponseTimeoutCount();
+
+    /**
+     * Sets the path under which the server publishes its metrics, for instance "/metrics".
+     * A GET request on this path returns the metrics in the Prometheus text format, see metrics().
+     * By default the path is empty, i.e. metrics are not published.
+     * \since 1.7
+     */
+    void setMetricsPath(const QString &path);
+
+    /**
+     * \returns the path given to setMetricsPath
+     * \since 1.7
+     */
+    QString metricsPath() const;
+
+    /**
+     * Returns statistics about the calls handled by this server, in the Prometheus text format:
+     * number of requests and faults per operation, a latency histogram per operation,
+     * bytes received and sent, active requests, delayed responses, connected sockets and
+     * thread usage.
+     * Since the operation names come from the requests, only the first 100 get their own
+     * metrics; the requests for the other ones are counted together as method="#other".
+     *
+     * The counters are kept per thread and only merged here, so collecting them has no
+     * impact on the threads handling requests.
+     * \since 1.7
+     */
+    QByteArray metrics() const;
+
 #ifndef QT_NO_OPENSSL
     /**
      * \returns the ssl configuration for this server
@@ -282,7 +392,10 @@ protected:
 
 private:
     friend class KDSoapServerSocket;
+    friend class KDSoapSocketList;
     void log(const QByteArray &text);
+    QSharedPointer<KDSoapServerMetrics> createThreadMetrics();
+    void delayedResponseTimedOut();
     class Private;
     Private *const d;
 };
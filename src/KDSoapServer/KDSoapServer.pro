@@ -26,8 +26,12 @@ HEADERS = $$INSTALLHEADERS \
     KDSoapServerSocket_p.h \
     KDSoapServerThread_p.h \
     KDSoapSocketList_p.h \
+    KDSoapServerLogger_p.h \
+    KDSoapServerMetrics_p.h \
 
 SOURCES = KDSoapServer.cpp \
+    KDSoapServerLogger.cpp \
+    KDSoapServerMetrics.cpp \
     KDSoapThreadPool.cpp \
     KDSoapServerSocket.cpp \
     KDSoapServerThread.cpp \
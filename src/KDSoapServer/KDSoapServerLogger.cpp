@@ -0,0 +1,220 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapServerLogger_p.h"
+
+// How often the writer thread looks at the queue, in milliseconds
+static const unsigned long s_writeInterval = 100;
+// Size of the chunks handed to QFile::write
+static const int s_batchSize = 64 * 1024;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+template <typename T> static inline T *loadAcquire(const QAtomicPointer<T> &ptr)
+{
+    return ptr.loadAcquire();
+}
+template <typename T> static inline void storeRelease(QAtomicPointer<T> &ptr, T *value)
+{
+    ptr.storeRelease(value);
+}
+static inline int loadAcquire(const QAtomicInt &value)
+{
+    return value.loadAcquire();
+}
+#else
+template <typename T> static inline T *loadAcquire(const QAtomicPointer<T> &ptr)
+{
+    return ptr;
+}
+template <typename T> static inline void storeRelease(QAtomicPointer<T> &ptr, T *value)
+{
+    ptr = value;
+}
+static inline int loadAcquire(const QAtomicInt &value)
+{
+    return value;
+}
+#endif
+
+KDSoapServerLogger::KDSoapServerLogger()
+    : QThread(),
+      m_tail(new Node), // stub node, m_head and m_tail are never null
+      m_queuedBytes(0),
+      m_maxQueuedBytes(16 * 1024 * 1024),
+      m_droppedCount(0),
+      m_quit(false)
+{
+    m_head.fetchAndStoreOrdered(m_tail);
+}
+
+KDSoapServerLogger::~KDSoapServerLogger()
+{
+    stopLogging();
+    close();
+    delete m_tail;
+}
+
+// This is the classic intrusive MPSC queue: producers atomically swap themselves
+// in as the new head, then link the previous head to them. Until that link is made
+// the consumer simply sees the queue as ending there, and picks up the rest later.
+void KDSoapServerLogger::log(const QByteArray &text)
+{
+    const int size = text.size();
+    const int max = loadAcquire(m_maxQueuedBytes);
+    if (m_queuedBytes.fetchAndAddOrdered(size) + size > max) {
+        m_queuedBytes.fetchAndAddOrdered(-size);
+        m_droppedCount.ref();
+        return;
+    }
+    Node *node = new Node;
+    node->text = text;
+    Node *prev = m_head.fetchAndStoreOrdered(node);
+    storeRelease(prev->next, node);
+}
+
+bool KDSoapServerLogger::dequeue(QByteArray &text)
+{
+    Node *tail = m_tail;
+    Node *next = loadAcquire(tail->next);
+    if (!next) {
+        return false;
+    }
+    // next becomes the new stub node
+    m_tail = next;
+    text.swap(next->text);
+    delete tail;
+    m_queuedBytes.fetchAndAddOrdered(-text.size());
+    return true;
+}
+
+void KDSoapServerLogger::writeQueued()
+{
+    if (!m_file.isOpen() && !m_fileName.isEmpty()) {
+        m_file.setFileName(m_fileName);
+        if (!m_file.open(QIODevice::Append)) {
+            qCritical("Could not open log file for writing: %s", qPrintable(m_fileName));
+            m_fileName.clear(); // don't retry every time
+        }
+    }
+    const bool canWrite = m_file.isOpen();
+
+    QByteArray batch;
+    QByteArray text;
+    while (dequeue(text)) {
+        if (!canWrite) {
+            continue;
+        }
+        batch += text;
+        if (batch.size() >= s_batchSize) {
+            m_file.write(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty()) {
+        m_file.write(batch);
+    }
+}
+
+void KDSoapServerLogger::setFileName(const QString &fileName)
+{
+    QMutexLocker lock(&m_fileMutex);
+    m_fileName = fileName;
+}
+
+QString KDSoapServerLogger::fileName() const
+{
+    QMutexLocker lock(&m_fileMutex);
+    return m_fileName;
+}
+
+void KDSoapServerLogger::setMaxQueuedBytes(int bytes)
+{
+    m_maxQueuedBytes.fetchAndStoreOrdered(bytes);
+}
+
+int KDSoapServerLogger::maxQueuedBytes() const
+{
+    return loadAcquire(m_maxQueuedBytes);
+}
+
+int KDSoapServerLogger::droppedCount() const
+{
+    return loadAcquire(m_droppedCount);
+}
+
+void KDSoapServerLogger::resetDroppedCount()
+{
+    m_droppedCount.fetchAndStoreOrdered(0);
+}
+
+void KDSoapServerLogger::flush()
+{
+    QMutexLocker lock(&m_fileMutex);
+    writeQueued();
+    if (m_file.isOpen()) {
+        m_file.flush();
+    }
+}
+
+void KDSoapServerLogger::close()
+{
+    QMutexLocker lock(&m_fileMutex);
+    writeQueued();
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+void KDSoapServerLogger::startLogging()
+{
+    QMutexLocker lock(&m_wakeMutex);
+    if (!isRunning()) {
+        m_quit = false;
+        start(QThread::LowPriority);
+    }
+}
+
+void KDSoapServerLogger::stopLogging()
+{
+    {
+        QMutexLocker lock(&m_wakeMutex);
+        m_quit = true;
+        m_wakeCondition.wakeOne();
+    }
+    wait();
+}
+
+void KDSoapServerLogger::run()
+{
+    QMutexLocker lock(&m_wakeMutex);
+    while (!m_quit) {
+        m_wakeCondition.wait(&m_wakeMutex, s_writeInterval);
+        lock.unlock();
+        {
+            QMutexLocker fileLock(&m_fileMutex);
+            writeQueued();
+        }
+        lock.relock();
+    }
+}
+
+#include "moc_KDSoapServerLogger_p.cpp"
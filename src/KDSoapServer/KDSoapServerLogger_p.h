@@ -0,0 +1,95 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPSERVERLOGGER_P_H
+#define KDSOAPSERVERLOGGER_P_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+
+/**
+ * Background writer for the KDSoapServer log file.
+ *
+ * Worker threads hand log lines to log(), which only appends them to a lock-free
+ * multi-producer queue. The logger thread wakes up regularly and writes everything
+ * queued so far to the file in one batch. The amount of queued data is bounded:
+ * when the writer can't keep up, new lines are dropped and counted instead.
+ */
+class KDSoapServerLogger : public QThread
+{
+    Q_OBJECT
+public:
+    KDSoapServerLogger();
+    ~KDSoapServerLogger();
+
+    // Thread-safe, lock-free
+    void log(const QByteArray &text);
+
+    void setFileName(const QString &fileName);
+    QString fileName() const;
+
+    void setMaxQueuedBytes(int bytes);
+    int maxQueuedBytes() const;
+    int droppedCount() const;
+    void resetDroppedCount();
+
+    // Write out everything queued so far, then flush the file to disk
+    void flush();
+    // Write out everything queued so far, then close the file
+    void close();
+
+    void startLogging(); // starts the writer thread, if not running already
+    void stopLogging();  // stops the writer thread, after writing out the queue
+
+protected:
+    virtual void run();
+
+private:
+    struct Node {
+        QAtomicPointer<Node> next;
+        QByteArray text;
+    };
+    bool dequeue(QByteArray &text); // consumer side, m_fileMutex must be locked
+    void writeQueued(); // m_fileMutex must be locked
+
+    // Producers only touch m_head and the atomic counters
+    QAtomicPointer<Node> m_head;
+    Node *m_tail;
+    QAtomicInt m_queuedBytes;
+    QAtomicInt m_maxQueuedBytes;
+    QAtomicInt m_droppedCount;
+
+    // Consumer side: the writer thread, or flush()/close() from any thread
+    mutable QMutex m_fileMutex;
+    QString m_fileName;
+    QFile m_file;
+
+    QMutex m_wakeMutex;
+    QWaitCondition m_wakeCondition;
+    bool m_quit;
+};
+
+#endif // KDSOAPSERVERLOGGER_P_H
@@ -0,0 +1,254 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#include "KDSoapServerMetrics_p.h"
+#include <QByteArray>
+#include <QStringList>
+
+const qint64 KDSoapServerMetrics::s_bucketBounds[KDSoapServerMetrics::BucketCount] = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000
+};
+
+QString KDSoapServerMetrics::otherOperations()
+{
+    // Not a valid XML name, so no actual operation can have it
+    return QString::fromLatin1("#other");
+}
+
+KDSoapServerMetrics::OperationData::OperationData()
+    : requests(0), faults(0), latencySum(0), infBucket(0)
+{
+    for (int i = 0; i < BucketCount; ++i) {
+        buckets[i] = 0;
+    }
+}
+
+KDSoapServerMetrics::Data::Data()
+    : receivedBytes(0), sentBytes(0), connections(0),
+      connectedSockets(0), activeRequests(0), delayedResponses(0)
+{
+}
+
+void KDSoapServerMetrics::Data::add(const Data &other)
+{
+    QHash<QString, OperationData>::const_iterator it = other.operations.constBegin();
+    for (; it != other.operations.constEnd(); ++it) {
+        OperationData &op = operation(it.key());
+        const OperationData &otherOp = it.value();
+        op.requests += otherOp.requests;
+        op.faults += otherOp.faults;
+        op.latencySum += otherOp.latencySum;
+        for (int i = 0; i < BucketCount; ++i) {
+            op.buckets[i] += otherOp.buckets[i];
+        }
+        op.infBucket += otherOp.infBucket;
+    }
+    receivedBytes += other.receivedBytes;
+    sentBytes += other.sentBytes;
+    connections += other.connections;
+    connectedSockets += other.connectedSockets;
+    activeRequests += other.activeRequests;
+    delayedResponses += other.delayedResponses;
+}
+
+KDSoapServerMetrics::OperationData &KDSoapServerMetrics::Data::operation(const QString &method)
+{
+    QHash<QString, OperationData>::iterator it = operations.find(method);
+    if (it != operations.end()) {
+        return it.value();
+    }
+    // Keep room for the other operations
+    if (operations.count() >= MaxOperations - 1) {
+        return operations[otherOperations()];
+    }
+    return operations[method];
+}
+
+KDSoapServerMetrics::KDSoapServerMetrics()
+{
+}
+
+void KDSoapServerMetrics::socketConnected()
+{
+    QMutexLocker lock(&m_mutex);
+    ++m_data.connectedSockets;
+}
+
+void KDSoapServerMetrics::socketUsed()
+{
+    QMutexLocker lock(&m_mutex);
+    ++m_data.connections;
+}
+
+void KDSoapServerMetrics::socketDisconnected()
+{
+    QMutexLocker lock(&m_mutex);
+    --m_data.connectedSockets;
+}
+
+void KDSoapServerMetrics::callStarted()
+{
+    QMutexLocker lock(&m_mutex);
+    ++m_data.activeRequests;
+}
+
+void KDSoapServerMetrics::callDelayed()
+{
+    QMutexLocker lock(&m_mutex);
+    ++m_data.delayedResponses;
+}
+
+void KDSoapServerMetrics::delayedCallFinished()
+{
+    QMutexLocker lock(&m_mutex);
+    --m_data.delayedResponses;
+}
+
+void KDSoapServerMetrics::callAborted(bool delayed)
+{
+    QMutexLocker lock(&m_mutex);
+    --m_data.activeRequests;
+    if (delayed) {
+        --m_data.delayedResponses;
+    }
+}
+
+void KDSoapServerMetrics::callFinished(const QString &method, bool isFault, qint64 latency, qint64 receivedBytes, qint64 sentBytes)
+{
+    QMutexLocker lock(&m_mutex);
+    --m_data.activeRequests;
+    m_data.receivedBytes += receivedBytes;
+    m_data.sentBytes += sentBytes;
+    OperationData &op = m_data.operation(method);
+    ++op.requests;
+    if (isFault) {
+        ++op.faults;
+    }
+    op.latencySum += latency;
+    for (int i = 0; i < BucketCount; ++i) {
+        if (latency <= s_bucketBounds[i]) {
+            ++op.buckets[i];
+            return;
+        }
+    }
+    ++op.infBucket;
+}
+
+KDSoapServerMetrics::Data KDSoapServerMetrics::snapshot() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_data;
+}
+
+static QByteArray labelValue(const QString &value)
+{
+    QByteArray result = value.toUtf8();
+    result.replace('\\', "\\\\");
+    result.replace('"', "\\\"");
+    result.replace('\n', "\\n");
+    return result;
+}
+
+static QByteArray seconds(qint64 microSeconds)
+{
+    return QByteArray::number(double(microSeconds) / 1000000.0, 'g', 10);
+}
+
+static void addHeader(QByteArray &text, const char *name, const char *type, const char *help)
+{
+    text += "# HELP ";
+    text += name;
+    text += ' ';
+    text += help;
+    text += "\n# TYPE ";
+    text += name;
+    text += ' ';
+    text += type;
+    text += '\n';
+}
+
+static void addValue(QByteArray &text, const char *name, qint64 value)
+{
+    text += name;
+    text += ' ';
+    text += QByteArray::number(value);
+    text += '\n';
+}
+
+QByteArray KDSoapServerMetrics::toPrometheusText(const Data &data, int threadCount, int busyThreadCount, int maxThreadCount)
+{
+    QByteArray text;
+    text.reserve(1024 + data.operations.count() * 1024);
+
+    // Sort operations by name, for a stable output
+    QStringList methods = data.operations.keys();
+    methods.sort();
+    QList<QByteArray> methodLabels;
+    Q_FOREACH (const QString &method, methods) {
+        methodLabels.append("method=\"" + labelValue(method) + '"');
+    }
+
+    addHeader(text, "kdsoap_requests_total", "counter", "Number of SOAP requests handled, per operation. "
+              "Past 100 operations, the other ones are counted as method=\"#other\".");
+    for (int i = 0; i < methods.count(); ++i) {
+        text += "kdsoap_requests_total{" + methodLabels.at(i) + "} " + QByteArray::number(data.operations.value(methods.at(i)).requests) + '\n';
+    }
+    addHeader(text, "kdsoap_faults_total", "counter", "Number of SOAP requests that resulted in a fault, per operation.");
+    for (int i = 0; i < methods.count(); ++i) {
+        text += "kdsoap_faults_total{" + methodLabels.at(i) + "} " + QByteArray::number(data.operations.value(methods.at(i)).faults) + '\n';
+    }
+    addHeader(text, "kdsoap_request_duration_seconds", "histogram", "Time from receiving the request to sending the response, per operation.");
+    for (int i = 0; i < methods.count(); ++i) {
+        const OperationData op = data.operations.value(methods.at(i));
+        const QByteArray &label = methodLabels.at(i);
+        qint64 cumulative = 0;
+        for (int b = 0; b < BucketCount; ++b) {
+            cumulative += op.buckets[b];
+            text += "kdsoap_request_duration_seconds_bucket{" + label + ",le=\"" + seconds(s_bucketBounds[b]) + "\"} " + QByteArray::number(cumulative) + '\n';
+        }
+        cumulative += op.infBucket;
+        text += "kdsoap_request_duration_seconds_bucket{" + label + ",le=\"+Inf\"} " + QByteArray::number(cumulative) + '\n';
+        text += "kdsoap_request_duration_seconds_sum{" + label + "} " + seconds(op.latencySum) + '\n';
+        text += "kdsoap_request_duration_seconds_count{" + label + "} " + QByteArray::number(op.requests) + '\n';
+    }
+
+    addHeader(text, "kdsoap_received_bytes_total", "counter", "Size of the SOAP request bodies received.");
+    addValue(text, "kdsoap_received_bytes_total", data.receivedBytes);
+    addHeader(text, "kdsoap_sent_bytes_total", "counter", "Size of the SOAP response bodies sent.");
+    addValue(text, "kdsoap_sent_bytes_total", data.sentBytes);
+    addHeader(text, "kdsoap_active_requests", "gauge", "Number of requests being processed, including delayed responses.");
+    addValue(text, "kdsoap_active_requests", data.activeRequests);
+    addHeader(text, "kdsoap_delayed_responses", "gauge", "Number of delayed responses not sent yet.");
+    addValue(text, "kdsoap_delayed_responses", data.delayedResponses);
+    addHeader(text, "kdsoap_connected_sockets", "gauge", "Number of connected sockets.");
+    addValue(text, "kdsoap_connected_sockets", data.connectedSockets);
+    addHeader(text, "kdsoap_connections_total", "counter", "Number of sockets that sent requests to the server.");
+    addValue(text, "kdsoap_connections_total", data.connections);
+    addHeader(text, "kdsoap_threads", "gauge", "Number of threads with connected sockets for this server.");
+    addValue(text, "kdsoap_threads", threadCount);
+    addHeader(text, "kdsoap_busy_threads", "gauge", "Number of threads currently processing a request for this server.");
+    addValue(text, "kdsoap_busy_threads", busyThreadCount);
+    addHeader(text, "kdsoap_max_threads", "gauge", "Maximum number of threads in the thread pool, 0 when not using a thread pool.");
+    addValue(text, "kdsoap_max_threads", maxThreadCount);
+    return text;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+#ifndef KDSOAPSERVERMETRICS_P_H
+#define KDSOAPSERVERMETRICS_P_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Counters for the calls handled by one server in one thread.
+ *
+ * Each KDSoapSocketList (i.e. each thread serving a given KDSoapServer) updates
+ * its own instance, so the mutex is only ever contended when the metrics are
+ * being collected by KDSoapServer::metrics().
+ */
+class KDSoapServerMetrics
+{
+public:
+    // Upper bounds of the latency histogram buckets, in microseconds
+    enum { BucketCount = 13 };
+    static const qint64 s_bucketBounds[BucketCount];
+
+    // The operation names come from the requests: past this many, any client could
+    // make the metrics grow without limit, so the other ones are counted together.
+    enum { MaxOperations = 100 };
+    static QString otherOperations();
+
+    struct OperationData {
+        OperationData();
+        qint64 requests;
+        qint64 faults;
+        qint64 latencySum; // microseconds
+        qint64 buckets[BucketCount]; // not cumulative
+        qint64 infBucket; // above the last bound
+    };
+
+    struct Data {
+        Data();
+        void add(const Data &other);
+        OperationData &operation(const QString &method);
+
+        QHash<QString, OperationData> operations;
+        qint64 receivedBytes;
+        qint64 sentBytes;
+        qint64 connections;
+        int connectedSockets;
+        int activeRequests;
+        int delayedResponses;
+    };
+
+    KDSoapServerMetrics();
+
+    void socketConnected();
+    void socketUsed(); // first data received on a socket
+    void socketDisconnected();
+    void callStarted();
+    void callDelayed();
+    void delayedCallFinished();
+    void callAborted(bool delayed); // socket deleted before the reply was sent
+    void callFinished(const QString &method, bool isFault, qint64 latency, qint64 receivedBytes, qint64 sentBytes);
+
+    Data snapshot() const;
+
+    static QByteArray toPrometheusText(const Data &data, int threadCount, int busyThreadCount, int maxThreadCount);
+
+private:
+    mutable QMutex m_mutex;
+    Data m_data;
+};
+
+#endif // KDSOAPSERVERMETRICS_P_H
@@ -22,6 +22,7 @@
 **********************************************************************/
 #include "KDSoapServerSocket_p.h"
 #include "KDSoapSocketList_p.h"
+#include "KDSoapServerMetrics_p.h"
 #include "KDSoapServerObjectInterface.h"
 #include "KDSoapServerAuthInterface.h"
 #include "KDSoapServerRawXMLInterface.h"
@@ -31,6 +32,7 @@
 #include <KDSoapClient/KDSoapNamespaceManager.h>
 #include <KDSoapClient/KDSoapMessageReader_p.h>
 #include <KDSoapClient/KDSoapMessageWriter_p.h>
+#include <KDSoapClient/KDSoapMtomPackage_p.h>
 #include <QBuffer>
 #include <QThread>
 #include <QMetaMethod>
@@ -38,6 +40,8 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QVarLengthArray>
+#include <QDateTime>
+#include <QTimer>
 
 KDSoapServerSocket::KDSoapServerSocket(KDSoapSocketList *owner, QObject *serverObject)
 #ifndef QT_NO_OPENSSL
@@ -48,11 +52,22 @@ KDSoapServerSocket::KDSoapServerSocket(KDSoapSocketList *owner, QObject *serverO
       m_owner(owner),
       m_serverObject(serverObject),
       m_delayedResponse(false),
+      m_delayedResponseId(0),
+      m_delayedResponseTimer(0),
+      m_callInProgress(false),
       m_socketEnabled(true),
       m_receivedData(false),
       m_useRawXML(false),
       m_bytesReceived(0),
-      m_chunkStart(0)
+      m_chunkStart(0),
+      m_mtom(false),
+      m_soap12(false),
+      m_requestSize(0),
+      m_headerParseTime(0),
+      m_xmlParseTime(0),
+      m_dispatchTime(0),
+      m_serializeTime(0),
+      m_writeTime(0)
 {
     connect(this, SIGNAL(readyRead()),
             this, SLOT(slotReadyRead()));
@@ -145,6 +160,52 @@ static QByteArray httpResponseHeaders(bool fault, const QByteArray &contentType,
     return httpResponse;
 }
 
+static qint64 elapsedMicroSeconds(const QElapsedTimer &timer)
+{
+#if QT_VERSION >= 0x040800
+    return timer.nsecsElapsed() / 1000;
+#else
+    return timer.elapsed() * 1000;
+#endif
+}
+
+static QByteArray jsonString(const QString &str)
+{
+    const QByteArray utf8 = str.toUtf8();
+    QByteArray result;
+    result.reserve(utf8.size() + 2);
+    result += '"';
+    for (int i = 0; i < utf8.size(); ++i) {
+        const char ch = utf8.at(i);
+        switch (ch) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (uchar(ch) < 0x20) {
+                result += "\\u00";
+                result += QByteArray::number(uchar(ch), 16).rightJustified(2, '0');
+            } else {
+                result += ch;
+            }
+        }
+    }
+    result += '"';
+    return result;
+}
+
 void KDSoapServerSocket::slotReadyRead()
 {
     if (!m_socketEnabled) {
@@ -160,6 +221,22 @@ void KDSoapServerSocket::slotReadyRead()
 
     //qDebug() << this << QThread::currentThread() << "slotReadyRead!";
 
+    if (m_httpHeaders.isEmpty() && m_requestBuffer.isEmpty()) {
+        // Start of a new request. Forget the previous one on this (keep-alive) connection,
+        // so that requests failing before being parsed aren't logged with its details.
+        m_requestTimer.start();
+        m_method.clear();
+        m_soapAction.clear();
+        m_mtom = false;
+        m_soap12 = false;
+        m_requestSize = 0;
+        m_headerParseTime = 0;
+        m_xmlParseTime = 0;
+        m_dispatchTime = 0;
+        m_serializeTime = 0;
+        m_writeTime = 0;
+    }
+
     QByteArray buf(2048, ' ');
     qint64 nread = -1;
     while (nread != 0) {
@@ -176,6 +253,8 @@ void KDSoapServerSocket::slotReadyRead()
 
     if (m_httpHeaders.isEmpty()) {
         // New request: see if we can parse headers
+        QElapsedTimer headerParseTimer;
+        headerParseTimer.start();
         QByteArray receivedHttpHeaders, receivedData;
         const bool splitOK = splitHeadersAndData(m_requestBuffer, receivedHttpHeaders, receivedData);
         if (!splitOK) {
@@ -184,6 +263,7 @@ void KDSoapServerSocket::slotReadyRead()
             return;
         }
         m_httpHeaders = parseHeaders(receivedHttpHeaders);
+        m_headerParseTime = elapsedMicroSeconds(headerParseTimer);
         // Leave only the actual data in the buffer
         m_requestBuffer = receivedData;
         m_bytesReceived = receivedData.size();
@@ -314,6 +394,9 @@ void KDSoapServerSocket::handleRequest(const QMap<QByteArray, QByteArray> &httpH
     if (requestType == "GET") {
         if (path == server->wsdlPathInUrl() && handleWsdlDownload()) {
             return;
+        } else if (!server->metricsPath().isEmpty() && path == server->metricsPath()) {
+            handleMetricsRequest();
+            return;
         } else if (handleFileDownload(serverObjectInterface, path)) {
             return;
         }
@@ -327,10 +410,21 @@ void KDSoapServerSocket::handleRequest(const QMap<QByteArray, QByteArray> &httpH
     }
 
     //parse message
+    QElapsedTimer timer;
+    timer.start();
+    m_requestSize = receivedData.size();
     KDSoapMessage requestMsg;
     KDSoapHeaders requestHeaders;
     KDSoapMessageReader reader;
-    KDSoapMessageReader::XmlError err = reader.xmlToMessage(receivedData, &requestMsg, &m_messageNamespace, &requestHeaders);
+    QByteArray contentType = httpHeaders.value("content-type");
+    KDSoapMtomPackage mtomPackage;
+    m_mtom = mtomPackage.parse(contentType, receivedData);
+    if (m_mtom) {
+        reader.setMtomPackage(&mtomPackage);
+        contentType = mtomPackage.soapContentType(); // for the SOAP version and action, below
+    }
+    KDSoapMessageReader::XmlError err = reader.xmlToMessage(m_mtom ? mtomPackage.rootPart() : receivedData, &requestMsg, &m_messageNamespace, &requestHeaders);
+    m_xmlParseTime = elapsedMicroSeconds(timer);
     if (err == KDSoapMessageReader::PrematureEndOfDocumentError) {
         //qDebug() << "Incomplete SOAP message, wait for more data";
         // This should never happen, since we check for content-size above.
@@ -339,7 +433,6 @@ void KDSoapServerSocket::handleRequest(const QMap<QByteArray, QByteArray> &httpH
 
     // check soap version and extract soapAction header
     QByteArray soapAction;
-    const QByteArray contentType = httpHeaders.value("content-type");
     if (contentType.startsWith("text/xml")) { //krazy:exclude=strings
         // SOAP 1.1
         soapAction = httpHeaders.value("soapaction");
@@ -348,6 +441,7 @@ void KDSoapServerSocket::handleRequest(const QMap<QByteArray, QByteArray> &httpH
 
     } else if (contentType.startsWith("application/soap+xml")) { //krazy:exclude=strings
         // SOAP 1.2
+        m_soap12 = true;
         // Example: application/soap+xml;charset=utf-8;action=ActionHex
         const QList<QByteArray> parts = contentType.split(';');
         Q_FOREACH (const QByteArray &part, parts) {
@@ -358,14 +452,29 @@ void KDSoapServerSocket::handleRequest(const QMap<QByteArray, QByteArray> &httpH
     }
 
     m_method = requestMsg.name();
+    m_soapAction = soapAction;
 
+    timer.start();
+    m_callInProgress = true;
+    m_owner->metrics()->callStarted();
     if (!replyMsg.isFault()) {
         makeCall(serverObjectInterface, requestMsg, replyMsg, requestHeaders, soapAction, path);
     }
+    m_dispatchTime = elapsedMicroSeconds(timer);
 
     if (serverObjectInterface && m_delayedResponse) {
         // Delayed response. Disable the socket to make sure we don't handle another call at the same time.
+        m_owner->metrics()->callDelayed();
         setSocketEnabled(false);
+        const int timeout = server->delayedResponseTimeout();
+        if (timeout > 0) {
+            if (!m_delayedResponseTimer) {
+                m_delayedResponseTimer = new QTimer(this);
+                m_delayedResponseTimer->setSingleShot(true);
+                connect(m_delayedResponseTimer, SIGNAL(timeout()), this, SLOT(slotDelayedResponseTimeout()));
+            }
+            m_delayedResponseTimer->start(timeout);
+        }
     } else {
         sendReply(serverObjectInterface, replyMsg);
     }
@@ -387,6 +496,14 @@ bool KDSoapServerSocket::handleWsdlDownload()
     return false;
 }
 
+void KDSoapServerSocket::handleMetricsRequest()
+{
+    const QByteArray responseText = m_owner->server()->metrics();
+    const QByteArray response = httpResponseHeaders(false, "text/plain; version=0.0.4", responseText.size());
+    write(response);
+    write(responseText);
+}
+
 bool KDSoapServerSocket::handleFileDownload(KDSoapServerObjectInterface *serverObjectInterface, const QString &path)
 {
     QByteArray contentType;
@@ -435,14 +552,19 @@ bool KDSoapServerSocket::handleFileDownload(KDSoapServerObjectInterface *serverO
 
 void KDSoapServerSocket::writeXML(const QByteArray &xmlResponse, bool isFault)
 {
-    const QByteArray httpHeaders = httpResponseHeaders(isFault, "text/xml", xmlResponse.size()); // TODO return application/soap+xml;charset=utf-8 instead for SOAP 1.2
+    writeResponse("text/xml", xmlResponse, isFault); // TODO return application/soap+xml;charset=utf-8 instead for SOAP 1.2
+}
+
+void KDSoapServerSocket::writeResponse(const QByteArray &contentType, const QByteArray &response, bool isFault)
+{
+    const QByteArray httpHeaders = httpResponseHeaders(isFault, contentType, response.size());
     if (m_doDebug) {
-        qDebug() << "KDSoapServerSocket: writing" << httpHeaders << xmlResponse;
+        qDebug() << "KDSoapServerSocket: writing" << httpHeaders << response;
     }
     qint64 written = write(httpHeaders);
     Q_ASSERT(written == httpHeaders.size()); // Please report a bug if you hit this.
-    written = write(xmlResponse);
-    Q_ASSERT(written == xmlResponse.size()); // Please report a bug if you hit this.
+    written = write(response);
+    Q_ASSERT(written == response.size()); // Please report a bug if you hit this.
     Q_UNUSED(written);
     // flush() ?
 }
@@ -451,9 +573,17 @@ void KDSoapServerSocket::sendReply(KDSoapServerObjectInterface *serverObjectInte
 {
     const bool isFault = replyMsg.isFault();
 
+    QElapsedTimer timer;
+    timer.start();
     QByteArray xmlResponse;
+    KDSoapMtomPackage mtomPackage;
     if (!replyMsg.isNull()) {
         KDSoapMessageWriter msgWriter;
+        if (m_mtom) {
+            msgWriter.setMtomPackage(&mtomPackage);
+            // The root part says which SOAP version it uses, so it must match the envelope
+            msgWriter.setVersion(m_soap12 ? KDSoapClientInterface::SOAP1_2 : KDSoapClientInterface::SOAP1_1);
+        }
         // Note that the kdsoap client parsing code doesn't care for the name (except if it's fault), even in
         // Document mode. Other implementations do, though.
         QString responseName = isFault ? QString::fromLatin1("Fault") : replyMsg.name();
@@ -472,16 +602,33 @@ void KDSoapServerSocket::sendReply(KDSoapServerObjectInterface *serverObjectInte
         xmlResponse = msgWriter.messageToXml(replyMsg, responseName, responseHeaders, QMap<QString, KDSoapMessage>());
     }
 
-    writeXML(xmlResponse, isFault);
+    m_serializeTime = elapsedMicroSeconds(timer);
+
+    timer.start();
+    if (m_mtom && !xmlResponse.isEmpty()) {
+        const QByteArray soapContentType = m_soap12 ? "application/soap+xml" : "text/xml";
+        xmlResponse = mtomPackage.toMultipart(xmlResponse, soapContentType);
+        writeResponse(mtomPackage.contentType(soapContentType), xmlResponse, isFault);
+    } else {
+        writeXML(xmlResponse, isFault);
+    }
+    m_writeTime = elapsedMicroSeconds(timer);
+
+    if (m_callInProgress) {
+        m_callInProgress = false;
+        m_owner->metrics()->callFinished(m_method, isFault, elapsedMicroSeconds(m_requestTimer), m_requestSize, xmlResponse.size());
+    }
 
     // All done, check if we should log this
     KDSoapServer *server = m_owner->server();
-    const KDSoapServer::LogLevel logLevel = server->logLevel(); // we do this here in order to support dynamic settings changes (at the price of a mutex)
+    const KDSoapServer::LogLevel logLevel = server->logLevel(); // we do this here in order to support dynamic settings changes
     if (logLevel != KDSoapServer::LogNothing) {
         if (logLevel == KDSoapServer::LogEveryCall ||
                 (logLevel == KDSoapServer::LogFaults && isFault)) {
 
-            if (isFault) {
+            if (server->logFormat() == KDSoapServer::LogJsonLines) {
+                server->log(accessLogLine(isFault, isFault ? replyMsg.faultAsString() : QString(), xmlResponse.size()));
+            } else if (isFault) {
                 server->log("FAULT " + m_method.toLatin1() + " -- " + replyMsg.faultAsString().toUtf8() + '\n');
             } else {
                 server->log("CALL " + m_method.toLatin1() + '\n');
@@ -490,16 +637,78 @@ void KDSoapServerSocket::sendReply(KDSoapServerObjectInterface *serverObjectInte
     }
 }
 
+QByteArray KDSoapServerSocket::accessLogLine(bool isFault, const QString &faultString, int responseSize) const
+{
+    QByteArray line;
+    line.reserve(400);
+    line += "{\"time\":";
+    line += jsonString(QDateTime::currentDateTime().toUTC().toString(QString::fromLatin1("yyyy-MM-ddThh:mm:ss.zzzZ")));
+    line += ",\"peer\":";
+    line += jsonString(peerAddress().toString());
+    line += ",\"method\":";
+    line += jsonString(m_method);
+    line += ",\"soapAction\":";
+    line += jsonString(QString::fromUtf8(m_soapAction.constData(), m_soapAction.size()));
+    line += ",\"requestBytes\":";
+    line += QByteArray::number(m_requestSize);
+    line += ",\"responseBytes\":";
+    line += QByteArray::number(responseSize);
+    if (isFault) {
+        line += ",\"fault\":";
+        line += jsonString(faultString);
+    }
+    line += ",\"us\":{\"headers\":";
+    line += QByteArray::number(m_headerParseTime);
+    line += ",\"parse\":";
+    line += QByteArray::number(m_xmlParseTime);
+    line += ",\"dispatch\":";
+    line += QByteArray::number(m_dispatchTime);
+    line += ",\"serialize\":";
+    line += QByteArray::number(m_serializeTime);
+    line += ",\"write\":";
+    line += QByteArray::number(m_writeTime);
+    line += ",\"total\":";
+    line += QByteArray::number(m_requestTimer.isValid() ? elapsedMicroSeconds(m_requestTimer) : 0);
+    line += "}}\n";
+    return line;
+}
+
 void KDSoapServerSocket::sendDelayedReply(KDSoapServerObjectInterface *serverObjectInterface, const KDSoapMessage &replyMsg)
 {
+    if (m_delayedResponse) {
+        m_owner->metrics()->delayedCallFinished();
+    }
+    if (m_delayedResponseTimer) {
+        m_delayedResponseTimer->stop();
+    }
     sendReply(serverObjectInterface, replyMsg);
     m_delayedResponse = false;
     setSocketEnabled(true);
 }
 
-void KDSoapServerSocket::setResponseDelayed()
+void KDSoapServerSocket::slotDelayedResponseTimeout()
+{
+    if (!m_delayedResponse) {
+        return;
+    }
+    KDSoapServer *server = m_owner->server();
+    server->delayedResponseTimedOut();
+    KDSoapMessage replyMsg;
+    replyMsg.setUse(server->use());
+    handleError(replyMsg, "Server.Timeout", QString::fromLatin1("No response for %1 after %2 ms").arg(m_method).arg(server->delayedResponseTimeout()));
+    // Any later sendDelayedResponse() for this call will be ignored, see isWaitingForDelayedResponse
+    sendDelayedReply(0, replyMsg);
+}
+
+int KDSoapServerSocket::setResponseDelayed()
 {
     m_delayedResponse = true;
+    return ++m_delayedResponseId;
+}
+
+bool KDSoapServerSocket::isWaitingForDelayedResponse(int responseId) const
+{
+    return m_delayedResponse && responseId == m_delayedResponseId;
 }
 
 void KDSoapServerSocket::handleError(KDSoapMessage &replyMsg, const char *errorCode, const QString &error)
@@ -32,8 +32,10 @@
 #endif
 
 #include <QMap>
+#include <QElapsedTimer>
 QT_BEGIN_NAMESPACE
 class QObject;
+class QTimer;
 QT_END_NAMESPACE
 class KDSoapSocketList;
 class KDSoapServerObjectInterface;
@@ -52,18 +54,31 @@ public:
     KDSoapServerSocket(KDSoapSocketList *owner, QObject *serverObject);
     ~KDSoapServerSocket();
 
-    void setResponseDelayed();
+    int setResponseDelayed(); // returns an id for the delayed response
+    bool isWaitingForDelayedResponse(int responseId) const;
     void sendDelayedReply(KDSoapServerObjectInterface *serverObjectInterface, const KDSoapMessage &replyMsg);
     void sendReply(KDSoapServerObjectInterface *serverObjectInterface, const KDSoapMessage &replyMsg);
+
+    bool isCallInProgress() const
+    {
+        return m_callInProgress;
+    }
+    bool isResponseDelayed() const
+    {
+        return m_delayedResponse;
+    }
+
 Q_SIGNALS:
     void socketDeleted(KDSoapServerSocket *);
 
 private Q_SLOTS:
     void slotReadyRead();
+    void slotDelayedResponseTimeout();
 
 private:
     void handleRequest(const QMap<QByteArray, QByteArray> &headers, const QByteArray &receivedData);
     bool handleWsdlDownload();
+    void handleMetricsRequest();
     bool handleFileDownload(KDSoapServerObjectInterface *serverObjectInterface, const QString &path);
     void makeCall(KDSoapServerObjectInterface *serverObjectInterface,
                   const KDSoapMessage &requestMsg, KDSoapMessage &replyMsg,
@@ -72,11 +87,16 @@ private:
     void handleError(KDSoapMessage &replyMsg, const char *errorCode, const QString &error);
     void setSocketEnabled(bool enabled);
     void writeXML(const QByteArray &xmlResponse, bool isFault);
+    void writeResponse(const QByteArray &contentType, const QByteArray &response, bool isFault);
+    QByteArray accessLogLine(bool isFault, const QString &faultString, int responseSize) const;
     friend class KDSoapServerObjectInterface;
 
     KDSoapSocketList *m_owner;
     QObject *m_serverObject;
     bool m_delayedResponse;
+    int m_delayedResponseId;
+    QTimer *m_delayedResponseTimer; // created on demand
+    bool m_callInProgress; // between processRequest and sending the reply, for the metrics
     bool m_doDebug;
     bool m_socketEnabled;
     bool m_receivedData;
@@ -92,6 +112,18 @@ private:
     // Data for the current call (stored here for delayed replies)
     QString m_messageNamespace;
     QString m_method;
+    QByteArray m_soapAction;
+    bool m_mtom; // the request was sent with MTOM, so is the reply
+    bool m_soap12; // the request used SOAP 1.2
+
+    // Statistics for the current call, for the access log. Times are in microseconds.
+    QElapsedTimer m_requestTimer;
+    int m_requestSize;
+    qint64 m_headerParseTime;
+    qint64 m_xmlParseTime;
+    qint64 m_dispatchTime;
+    qint64 m_serializeTime;
+    qint64 m_writeTime;
 };
 
 #endif // KDSOAPSERVERSOCKET_P_H
@@ -26,6 +26,13 @@
 #include "KDSoapServer.h"
 
 #include <QMetaType>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#endif
 
 KDSoapServerThread::KDSoapServerThread(QObject *parent)
     : QThread(parent), d(0)
@@ -40,6 +47,9 @@ KDSoapServerThread::~KDSoapServerThread()
 
 void KDSoapServerThread::run()
 {
+    // Pin the thread before creating anything, so that the memory for the
+    // socket lists and server objects is allocated on the local NUMA node.
+    applyCpuSet();
     KDSoapServerThreadImpl impl;
     d = &impl;
     m_semaphore.release();
@@ -85,6 +95,32 @@ void KDSoapServerThread::disconnectSocketsForServer(KDSoapServer *server, QSemap
     }
 }
 
+void KDSoapServerThread::setCpuSet(const QList<int> &cpus)
+{
+    m_cpuSet = cpus;
+}
+
+// Called in the thread itself
+void KDSoapServerThread::applyCpuSet()
+{
+    if (m_cpuSet.isEmpty()) {
+        return;
+    }
+#ifdef Q_OS_LINUX
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    Q_FOREACH (int cpu, m_cpuSet) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (err != 0) {
+        qWarning() << "KDSoapServerThread: could not set CPU affinity to" << m_cpuSet << ":" << strerror(err);
+    }
+#endif
+}
+
 void KDSoapServerThread::startThread()
 {
     QThread::start();
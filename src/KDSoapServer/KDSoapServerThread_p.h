@@ -27,6 +27,7 @@
 #include <QSemaphore>
 #include <QMutex>
 #include <QHash>
+#include <QList>
 class KDSoapServer;
 class KDSoapSocketList;
 
@@ -65,6 +66,7 @@ public:
     explicit KDSoapServerThread(QObject *parent = 0);
     ~KDSoapServerThread();
 
+    void setCpuSet(const QList<int> &cpus); // call before startThread
     void startThread();
     void quitThread();
 
@@ -82,7 +84,9 @@ protected:
 private:
     void start(); // use startThread instead
     void quit(); // use quitThread instead
+    void applyCpuSet();
     KDSoapServerThreadImpl *d;
+    QList<int> m_cpuSet;
     QSemaphore m_semaphore;
 };
 
@@ -23,10 +23,11 @@
 #include "KDSoapSocketList_p.h"
 #include "KDSoapServerSocket_p.h"
 #include "KDSoapServer.h"
+#include "KDSoapServerMetrics_p.h"
 #include <QDebug>
 
 KDSoapSocketList::KDSoapSocketList(KDSoapServer *server)
-    : m_server(server), m_serverObject(server->createServerObject()), m_totalConnectionCount(0)
+    : m_server(server), m_serverObject(server->createServerObject()), m_metrics(server->createThreadMetrics()), m_totalConnectionCount(0)
 {
     Q_ASSERT(m_server);
     Q_ASSERT(m_serverObject);
@@ -56,6 +57,7 @@ KDSoapServerSocket *KDSoapSocketList::handleIncomingConnection(int socketDescrip
     QObject::connect(socket, SIGNAL(disconnected()),
                      socket, SLOT(deleteLater()));
     m_sockets.insert(socket);
+    m_metrics->socketConnected();
     connect(socket, SIGNAL(socketDeleted(KDSoapServerSocket*)), this, SLOT(socketDeleted(KDSoapServerSocket*)));
     return socket;
 }
@@ -64,6 +66,11 @@ void KDSoapSocketList::socketDeleted(KDSoapServerSocket *socket)
 {
     //qDebug() << Q_FUNC_INFO;
     m_sockets.remove(socket);
+    m_metrics->socketDisconnected();
+    // Called from the socket destructor, it's still safe to ask the socket about its state
+    if (socket->isCallInProgress()) {
+        m_metrics->callAborted(socket->isResponseDelayed());
+    }
 }
 
 int KDSoapSocketList::socketCount() const
@@ -90,6 +97,7 @@ int KDSoapSocketList::totalConnectionCount() const
 void KDSoapSocketList::increaseConnectionCount()
 {
     m_totalConnectionCount.ref();
+    m_metrics->socketUsed();
     //qDebug() << m_totalConnectionCount << "sockets connected in" << QThread::currentThread();
 }
 
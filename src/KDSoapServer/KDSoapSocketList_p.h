@@ -25,12 +25,14 @@
 
 #include <QSet>
 #include <QObject>
+#include <QSharedPointer>
 QT_BEGIN_NAMESPACE
 class QTcpSocket;
 class QObject;
 QT_END_NAMESPACE
 class KDSoapServer;
 class KDSoapServerSocket;
+class KDSoapServerMetrics;
 
 class KDSoapSocketList : public QObject
 {
@@ -53,12 +55,19 @@ public:
         return m_server;
     }
 
+    // Shared with the server, which reads it; updated from this thread only
+    KDSoapServerMetrics *metrics() const
+    {
+        return m_metrics.data();
+    }
+
 public Q_SLOTS:
     void socketDeleted(KDSoapServerSocket *socket);
 
 private:
     KDSoapServer *m_server;
     QObject *m_serverObject;
+    QSharedPointer<KDSoapServerMetrics> m_metrics; // still used by sockets deleted after the server
     QSet<KDSoapServerSocket *> m_sockets;
     QAtomicInt m_totalConnectionCount;
 };
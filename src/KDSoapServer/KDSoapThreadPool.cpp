@@ -35,6 +35,7 @@ public:
     KDSoapServerThread *chooseNextThread();
 
     int m_maxThreadCount;
+    QList<QList<int> > m_cpuSets;
     typedef QList<KDSoapServerThread *> ThreadCollection;
     ThreadCollection m_threads;
 };
@@ -69,6 +70,16 @@ int KDSoapThreadPool::maxThreadCount() const
     return d->m_maxThreadCount;
 }
 
+void KDSoapThreadPool::setThreadCpuSets(const QList<QList<int> > &cpuSets)
+{
+    d->m_cpuSets = cpuSets;
+}
+
+QList<QList<int> > KDSoapThreadPool::threadCpuSets() const
+{
+    return d->m_cpuSets;
+}
+
 KDSoapServerThread *KDSoapThreadPool::Private::chooseNextThread()
 {
     KDSoapServerThread *chosenThread = 0;
@@ -105,6 +116,9 @@ KDSoapServerThread *KDSoapThreadPool::Private::chooseNextThread()
     if (!chosenThread) {
         chosenThread = new KDSoapServerThread(0);
         //qDebug() << "Creating KDSoapServerThread" << chosenThread;
+        if (!m_cpuSets.isEmpty()) {
+            chosenThread->setCpuSet(m_cpuSets.at(m_threads.count() % m_cpuSets.count()));
+        }
         m_threads.append(chosenThread);
         chosenThread->startThread();
     }
@@ -25,6 +25,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QHash>
+#include <QtCore/QList>
 #include "KDSoapServerGlobal.h"
 class KDSoapServer;
 
@@ -63,6 +64,30 @@ public:
      */
     int maxThreadCount() const;
 
+    /**
+     * Sets the CPU sets that worker threads should be pinned to.
+     *
+     * The n-th thread created by the pool is pinned to the CPUs listed in
+     * \p cpuSets[n % cpuSets.count()]. Since the per-thread socket lists and
+     * server objects are created from within the worker thread, after pinning,
+     * the usual "first touch" memory policy places them on the NUMA node of
+     * those CPUs.
+     *
+     * This only affects threads created after this call, so it should be called
+     * before the pool handles its first connection. An empty list (the default)
+     * lets the operating system schedule the threads freely.
+     *
+     * CPU affinity is currently only implemented on Linux, this is a no-op on other platforms.
+     * \since 1.7
+     */
+    void setThreadCpuSets(const QList<QList<int> > &cpuSets);
+
+    /**
+     * Returns the CPU sets given to setThreadCpuSets().
+     * \since 1.7
+     */
+    QList<QList<int> > threadCpuSets() const;
+
     /**
      * Returns the number of connected sockets for a given server
      */
@@ -23,6 +23,7 @@
 
 #include "KDSoapValue.h"
 #include "KDDateTime.h"
+#include "KDSoapBinaryCodec.h"
 #include <QtTest/QtTest>
 
 class Basic : public QObject
@@ -51,6 +52,87 @@ private Q_SLOTS:
 #endif
     }
 
+    void testValueListReserve()
+    {
+        KDSoapValueList list;
+        list.setArrayType(QString::fromLatin1("http://www.w3.org/2001/XMLSchema"), QString::fromLatin1("int"));
+        list.reserve(1000);
+        list.reserveAttributes(2);
+        for (int i = 0; i < 1000; ++i) {
+            list.addArgument(QString::fromLatin1("item"), i);
+        }
+        list.attributes().append(KDSoapValue(QString::fromLatin1("attr"), QString::fromLatin1("value")));
+        QCOMPARE(list.count(), 1000);
+        QCOMPARE(list.at(999).value().toInt(), 999);
+        QCOMPARE(list.attributes().count(), 1);
+        QCOMPARE(list.arrayType(), QString::fromLatin1("int"));
+    }
+
+    void testChildLookup()
+    {
+        KDSoapValueList list;
+        for (int i = 0; i < 100; ++i) {
+            list.addArgument(QString::fromLatin1("field%1").arg(i), i);
+        }
+        list.addArgument(QString::fromLatin1("field10"), -1);
+        QCOMPARE(list.child(QLatin1String("field10")).value().toInt(), 10); // first match
+        QCOMPARE(list.child(QLatin1String("field99")).value().toInt(), 99);
+        QVERIFY(list.child(QLatin1String("missing")).isNull());
+
+        // Changes to the list, including renaming or replacing values in place
+        list.removeFirst();
+        QVERIFY(list.child(QLatin1String("field0")).isNull());
+        list.prepend(KDSoapValue(QString::fromLatin1("field99"), 1000));
+        QCOMPARE(list.child(QLatin1String("field99")).value().toInt(), 1000);
+        list[1].setName(QString::fromLatin1("renamed"));
+        QCOMPARE(list.child(QLatin1String("renamed")).value().toInt(), 1);
+        QCOMPARE(list.child(QLatin1String("field10")).value().toInt(), 10);
+        QCOMPARE(list.child(QLatin1String("field50")).value().toInt(), 50);
+        list[2].setName(QString::fromLatin1("field50")); // an earlier value gets a name already in use
+        QCOMPARE(list.child(QLatin1String("field50")).value().toInt(), 2);
+        list[3] = KDSoapValue(QString::fromLatin1("field60"), -60); // same, by assignment
+        QCOMPARE(list.child(QLatin1String("field60")).value().toInt(), -60);
+
+        // Copies are independent
+        KDSoapValueList copy = list;
+        copy.removeAt(10);
+        QCOMPARE(copy.child(QLatin1String("field10")).value().toInt(), -1);
+        QCOMPARE(list.child(QLatin1String("field10")).value().toInt(), 10);
+
+        // Same results through the hash, which doesn't follow later changes
+        const QHash<QString, KDSoapValue> children = list.childrenByName();
+        QCOMPARE(children.value(QLatin1String("field10")).value().toInt(), 10);
+        QCOMPARE(children.value(QLatin1String("field50")).value().toInt(), 2);
+        QCOMPARE(children.value(QLatin1String("field60")).value().toInt(), -60);
+        QCOMPARE(children.value(QLatin1String("renamed")).value().toInt(), 1);
+        QVERIFY(!children.contains(QLatin1String("missing")));
+        list[0].setName(QString::fromLatin1("other"));
+        QCOMPARE(children.value(QLatin1String("field99")).value().toInt(), 1000);
+    }
+
+    void testChildValues()
+    {
+        KDSoapValue leaf(QString::fromLatin1("id"), 42);
+        QVERIFY(!leaf.isNil());
+        QVERIFY(leaf.childValues().isEmpty());
+        QVERIFY(KDSoapValue(QString::fromLatin1("empty"), QVariant()).isNil());
+
+        KDSoapValue parent(QString::fromLatin1("parent"), QVariant());
+        QVERIFY(parent.isNil());
+        parent.childValues().append(leaf);
+        parent.childValues().attributes().append(KDSoapValue(QString::fromLatin1("attr"), QString::fromLatin1("value")));
+        QVERIFY(!parent.isNil());
+
+        // Detaching copies the children
+        KDSoapValue copy = parent;
+        copy.setValue(QString::fromLatin1("text"));
+        copy.childValues().append(leaf);
+        QCOMPARE(copy.childValues().count(), 2);
+        QCOMPARE(parent.childValues().count(), 1);
+        QCOMPARE(copy.childValues().attributes().count(), 1);
+        QCOMPARE(parent.childValues().first().value().toInt(), 42);
+    }
+
     void testDateTime()
     {
         QDateTime qdt(QDate(2010, 12, 31));
@@ -65,6 +147,143 @@ private Q_SLOTS:
         kdt.setTimeZone(QString::fromLatin1("+01:00"));
         QCOMPARE(kdt.toDateString(), QString::fromLatin1("2011-03-15T23:59:59.999+01:00"));
     }
+
+    void testDateTimeParsing_data()
+    {
+        QTest::addColumn<QString>("input");
+        QTest::addColumn<QDateTime>("expectedDateTime");
+        QTest::addColumn<QString>("expectedTimeZone");
+        QTest::addColumn<int>("expectedOffset");
+        QTest::addColumn<QString>("expectedString");
+
+        const QDate date(2011, 2, 3);
+        QTest::newRow("local") << "2011-02-03T04:05:06" << QDateTime(date, QTime(4, 5, 6)) << QString() << 0 << "2011-02-03T04:05:06";
+        QTest::newRow("utc") << "2011-02-03T04:05:06Z" << QDateTime(date, QTime(4, 5, 6), Qt::UTC) << "Z" << 0 << "2011-02-03T04:05:06Z";
+        QTest::newRow("msecs") << "2011-02-03T04:05:06.789+01:00" << QDateTime(date, QTime(4, 5, 6, 789)) << "+01:00" << 3600 << "2011-02-03T04:05:06.789+01:00";
+        QTest::newRow("offset") << "2011-02-03T04:05:06-03:30" << QDateTime(date, QTime(4, 5, 6)) << "-03:30" << -12600 << "2011-02-03T04:05:06-03:30";
+        QTest::newRow("short_fraction") << "2011-02-03T04:05:06.5Z" << QDateTime(date, QTime(4, 5, 6, 500), Qt::UTC) << "Z" << 0 << "2011-02-03T04:05:06.500Z";
+        QTest::newRow("long_fraction") << "2011-02-03T04:05:06.1235678Z" << QDateTime(date, QTime(4, 5, 6, 124), Qt::UTC) << "Z" << 0 << "2011-02-03T04:05:06.124Z";
+        QTest::newRow("rounded_fraction") << "2011-02-03T04:05:06.9996Z" << QDateTime(date, QTime(4, 5, 6, 999), Qt::UTC) << "Z" << 0 << "2011-02-03T04:05:06.999Z";
+        QTest::newRow("invalid") << "2011-02-30T04:05:06" << QDateTime() << QString() << 0 << QString();
+    }
+
+    void testDateTimeParsing()
+    {
+        QFETCH(QString, input);
+        QFETCH(QDateTime, expectedDateTime);
+        QFETCH(QString, expectedTimeZone);
+        QFETCH(int, expectedOffset);
+        QFETCH(QString, expectedString);
+
+        const KDDateTime kdt = KDDateTime::fromDateString(input);
+        QCOMPARE(kdt.isValid(), expectedDateTime.isValid());
+        if (!kdt.isValid()) {
+            return;
+        }
+        QCOMPARE(kdt.date(), expectedDateTime.date());
+        QCOMPARE(kdt.time(), expectedDateTime.time());
+        QCOMPARE(kdt.timeZone(), expectedTimeZone);
+        if (expectedOffset) {
+#if QT_VERSION >= 0x050200
+            QCOMPARE(kdt.offsetFromUtc(), expectedOffset);
+#else
+            QCOMPARE(kdt.utcOffset(), expectedOffset);
+#endif
+        }
+        QCOMPARE(kdt.toDateString(), expectedString);
+    }
+
+    void benchmarkDateTimeParsing_data()
+    {
+        QTest::addColumn<bool>("useQDateTime");
+        QTest::newRow("QDateTime::fromString") << true;
+        QTest::newRow("KDDateTime::fromDateString") << false;
+    }
+
+    // Compares with what KDDateTime::fromDateString used to do: QDateTime::fromString and setTimeZone
+    void benchmarkDateTimeParsing()
+    {
+        QFETCH(bool, useQDateTime);
+        const QString input = QString::fromLatin1("2011-02-03T04:05:06.789+01:00");
+        QBENCHMARK {
+            if (useQDateTime) {
+                QString baseString = input;
+                const QString tz = input.right(6);
+                baseString.chop(6);
+                KDDateTime kdt = QDateTime::fromString(baseString, Qt::ISODate);
+                kdt.setTimeZone(tz);
+            } else {
+                KDDateTime::fromDateString(input);
+            }
+        }
+    }
+
+    void benchmarkDateTimeFormatting_data()
+    {
+        benchmarkDateTimeParsing_data();
+    }
+
+    void benchmarkDateTimeFormatting()
+    {
+        QFETCH(bool, useQDateTime);
+        KDDateTime kdt = QDateTime(QDate(2011, 2, 3), QTime(4, 5, 6, 789));
+        kdt.setTimeZone(QString::fromLatin1("+01:00"));
+        QBENCHMARK {
+            if (useQDateTime) {
+                kdt.toString(QLatin1String("yyyy-MM-ddThh:mm:ss.zzz")) + kdt.timeZone();
+            } else {
+                kdt.toDateString();
+            }
+        }
+    }
+
+    void testBinaryCodec()
+    {
+        // Same results as QByteArray, for all the padding cases
+        QByteArray data;
+        for (int i = 0; i < 300; ++i) {
+            QCOMPARE(KDSoapBinaryCodec::toBase64(data), QString::fromLatin1(data.toBase64()));
+            QCOMPARE(KDSoapBinaryCodec::toHex(data), QString::fromLatin1(data.toHex()));
+            QCOMPARE(KDSoapBinaryCodec::fromBase64(QString::fromLatin1(data.toBase64())), data);
+            QCOMPARE(KDSoapBinaryCodec::fromHex(QString::fromLatin1(data.toHex())), data);
+            data += char(i * 7);
+        }
+        // Invalid characters are skipped, like QByteArray does
+        const QString wrapped = QString::fromLatin1("SGVs\nbG8g\r\nd29y bGQ=\n");
+        QCOMPARE(KDSoapBinaryCodec::fromBase64(wrapped), QByteArray::fromBase64(wrapped.toLatin1()));
+        QCOMPARE(KDSoapBinaryCodec::fromBase64(wrapped), QByteArray("Hello world"));
+        QCOMPARE(KDSoapBinaryCodec::fromBase64(QString::fromLatin1("SGVsbG8=!")), QByteArray("Hello"));
+        QCOMPARE(KDSoapBinaryCodec::fromHex(QString::fromLatin1("abc")), QByteArray::fromHex("abc"));
+        QCOMPARE(KDSoapBinaryCodec::fromHex(QString::fromLatin1("0A:ff z1")), QByteArray::fromHex("0A:ff z1"));
+        QCOMPARE(KDSoapBinaryCodec::fromBase64(QString(QChar(0x263a))), QByteArray());
+    }
+
+    void benchmarkBase64_data()
+    {
+        QTest::addColumn<bool>("useQByteArray");
+        QTest::newRow("QByteArray") << true;
+        QTest::newRow("KDSoapBinaryCodec") << false;
+    }
+
+    // Compares with the conversions done before: toBase64() and fromLatin1(), toLatin1() and fromBase64()
+    void benchmarkBase64()
+    {
+        QFETCH(bool, useQByteArray);
+        QByteArray data;
+        data.resize(10 * 1024 * 1024);
+        for (int i = 0; i < data.size(); ++i) {
+            data[i] = char(i * 31);
+        }
+        QBENCHMARK {
+            if (useQByteArray) {
+                const QString text = QString::fromLatin1(data.toBase64());
+                QCOMPARE(QByteArray::fromBase64(text.toLatin1()).size(), data.size());
+            } else {
+                const QString text = KDSoapBinaryCodec::toBase64(data);
+                QCOMPARE(KDSoapBinaryCodec::fromBase64(text).size(), data.size());
+            }
+        }
+    }
 };
 
 QTEST_MAIN(Basic)
@@ -0,0 +1,319 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+
+#include <QtTest/QtTest>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+
+// Runs kdwsdl2cpp itself, to test its command-line options.
+// KDWSDL2CPP and SRCDIR are defined by the build system.
+class TestKDWsdl2CppOptions : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testJobs_data()
+    {
+        QTest::addColumn<QStringList>("options");
+        QTest::newRow("client") << QStringList();
+        QTest::newRow("server") << (QStringList() << QString::fromLatin1("-server"));
+        QTest::newRow("split") << (QStringList() << QString::fromLatin1("-split") << QString::fromLatin1("3"));
+    }
+
+    void testJobs()
+    {
+        // A WSDL with many types, so that they are really converted and printed in parallel
+        QFETCH(QStringList, options);
+        const QString wsdl = QString::fromLatin1(SRCDIR "../msexchange_wsdl/Services.wsdl");
+        const QString sequential = QString::fromLatin1("jobs_1_") + QString::fromLatin1(QTest::currentDataTag());
+        const QString parallel = QString::fromLatin1("jobs_8_") + QString::fromLatin1(QTest::currentDataTag());
+        QVERIFY(generate(sequential, wsdl, QStringList() << QString::fromLatin1("-jobs") << QString::fromLatin1("1") << options));
+        QVERIFY(generate(parallel, wsdl, QStringList() << QString::fromLatin1("-jobs") << QString::fromLatin1("8") << options));
+
+        const QStringList files = QDir(sequential).entryList(QStringList() << QString::fromLatin1("wsdl_*"), QDir::Files, QDir::Name);
+        QCOMPARE(files, QDir(parallel).entryList(QStringList() << QString::fromLatin1("wsdl_*"), QDir::Files, QDir::Name));
+        QVERIFY(files.count() >= 2);
+        Q_FOREACH (const QString &file, files) {
+            const QByteArray expected = readFile(sequential + QLatin1Char('/') + file);
+            QVERIFY(!expected.isEmpty());
+            QVERIFY2(readFile(parallel + QLatin1Char('/') + file) == expected, qPrintable(file));
+        }
+    }
+
+    void testIncremental()
+    {
+        // A WSDL importing another WSDL and a schema, copied so that the test can modify them
+        const QString directory = QString::fromLatin1("incremental");
+        QVERIFY(cleanDirectory(directory));
+        const QStringList inputs = QStringList() << QString::fromLatin1("import_definition.wsdl")
+                                   << QString::fromLatin1("import_definition_wsdl.wsdl") << QString::fromLatin1("import_definition_schema.xsd");
+        Q_FOREACH (const QString &input, inputs) {
+            QVERIFY(QFile::copy(QString::fromLatin1(SRCDIR "../import_definition/") + input, directory + QLatin1Char('/') + input));
+        }
+        const QStringList arguments = QStringList() << QString::fromLatin1("-incremental") << inputs.first()
+                                      << QString::fromLatin1("-o") << QString::fromLatin1("wsdl_import.h");
+        const QString header = directory + QString::fromLatin1("/wsdl_import.h");
+        const QString stamp = header + QString::fromLatin1(".stamp");
+        const QByteArray upToDate = "wsdl_import.h is up to date";
+
+        // First run: generates the header, and the stamp listing all the inputs
+        QByteArray output;
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY(!output.contains(upToDate));
+        const QByteArray generated = readFile(header);
+        QVERIFY(generated.contains("class"));
+        const QByteArray stampData = readFile(stamp);
+        Q_FOREACH (const QString &input, inputs) {
+            QVERIFY2(stampData.contains(input.toLatin1()), stampData.constData());
+        }
+        const QDateTime headerDate = QFileInfo(header).lastModified();
+
+        // Nothing changed: skipped, but the stamp gets a new date so that the build rule is satisfied
+        const QDateTime stampDate = QFileInfo(stamp).lastModified();
+        QTest::qSleep(1100); // the dates may only have a precision of one second
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY(output.contains(upToDate));
+        QVERIFY(QFileInfo(stamp).lastModified() > stampDate);
+        QCOMPARE(readFile(stamp), stampData);
+        QCOMPARE(QFileInfo(header).lastModified(), headerDate);
+
+        // An imported file changed: regenerated, and the header keeps its date since its content is the same
+        QFile schema(directory + QString::fromLatin1("/import_definition_schema.xsd"));
+        QVERIFY(schema.open(QIODevice::Append));
+        schema.write("<!-- changed -->\n");
+        schema.close();
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY(!output.contains(upToDate));
+        QVERIFY(readFile(stamp) != stampData);
+        QCOMPARE(readFile(header), generated);
+        QCOMPARE(QFileInfo(header).lastModified(), headerDate);
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY(output.contains(upToDate));
+
+        // Other options, or a missing output file: regenerated
+        QCOMPARE(runKDWsdl2Cpp(directory, QStringList() << QString::fromLatin1("-keep-unused-types") << arguments, &output), 0);
+        QVERIFY(!output.contains(upToDate));
+        QVERIFY(QFile::remove(header));
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY(!output.contains(upToDate));
+        QCOMPARE(readFile(header), generated);
+    }
+
+    void testOffline_data()
+    {
+        QTest::addColumn<QString>("mode");
+        QTest::newRow("catalog uri") << QString::fromLatin1("uri");
+        QTest::newRow("catalog rewriteURI") << QString::fromLatin1("rewriteURI");
+        QTest::newRow("cache") << QString::fromLatin1("cache");
+    }
+
+    void testOffline()
+    {
+        // The imports of the WSDL are remote: -offline must get them from the catalog or the cache
+        QFETCH(QString, mode);
+        const QString directory = QString::fromLatin1("offline_") + mode;
+        QVERIFY(cleanDirectory(directory));
+        QVERIFY(cleanDirectory(directory + QString::fromLatin1("/local")));
+        const QString remote = QString::fromLatin1("http://www.example.com/kdsoap/");
+        const QString schema = QString::fromLatin1("import_definition_schema.xsd");
+        const QString importedWsdl = QString::fromLatin1("import_definition_wsdl.wsdl");
+        QByteArray wsdl = readFile(QString::fromLatin1(SRCDIR "../import_definition/import_definition.wsdl"));
+        wsdl.replace("\"" + schema.toLatin1() + '"', "\"" + (remote + schema).toLatin1() + '"');
+        wsdl.replace("\"" + importedWsdl.toLatin1() + '"', "\"" + (remote + importedWsdl).toLatin1() + '"');
+        QVERIFY(writeFile(directory + QString::fromLatin1("/service.wsdl"), wsdl));
+        Q_FOREACH (const QString &file, QStringList() << schema << importedWsdl) {
+            QVERIFY(QFile::copy(QString::fromLatin1(SRCDIR "../import_definition/") + file, directory + QString::fromLatin1("/local/") + file));
+        }
+
+        QStringList arguments;
+        arguments << QString::fromLatin1("-offline");
+        if (mode == QLatin1String("cache")) {
+            // Filled like a previous run downloading the imports would have done
+            Q_FOREACH (const QString &file, QStringList() << schema << importedWsdl) {
+                const QByteArray data = readFile(directory + QString::fromLatin1("/local/") + file);
+                const QByteArray contentHash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+                const QByteArray urlHash = QCryptographicHash::hash((remote + file).toLatin1(), QCryptographicHash::Sha1).toHex();
+                QVERIFY(QDir().mkpath(directory + QString::fromLatin1("/cache/data")));
+                QVERIFY(QDir().mkpath(directory + QString::fromLatin1("/cache/urls")));
+                QVERIFY(writeFile(directory + QString::fromLatin1("/cache/data/") + QString::fromLatin1(contentHash), data));
+                QVERIFY(writeFile(directory + QString::fromLatin1("/cache/urls/") + QString::fromLatin1(urlHash), contentHash));
+            }
+            arguments << QString::fromLatin1("-cache-dir") << QString::fromLatin1("cache");
+        } else {
+            // Relative locations in the catalog are relative to the catalog itself
+            QByteArray catalog = "<?xml version=\"1.0\"?>\n"
+                                 "<catalog xmlns=\"urn:oasis:names:tc:entity:xmlns:xml:catalog\">\n";
+            if (mode == QLatin1String("uri")) {
+                Q_FOREACH (const QString &file, QStringList() << schema << importedWsdl) {
+                    catalog += "  <uri name=\"" + (remote + file).toLatin1() + "\" uri=\"local/" + file.toLatin1() + "\"/>\n";
+                }
+            } else {
+                catalog += "  <rewriteURI uriStartString=\"" + remote.toLatin1() + "\" rewritePrefix=\"local/\"/>\n";
+            }
+            catalog += "</catalog>\n";
+            QVERIFY(writeFile(directory + QString::fromLatin1("/catalog.xml"), catalog));
+            arguments << QString::fromLatin1("-catalog") << QString::fromLatin1("catalog.xml");
+        }
+        arguments << QString::fromLatin1("service.wsdl") << QString::fromLatin1("-o") << QString::fromLatin1("wsdl_service.h");
+
+        QByteArray output;
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY2(!output.contains("Not downloading"), output.constData());
+        QVERIFY2(!output.contains("Downloading"), output.constData());
+        // The types of the imported schema are generated
+        const QByteArray header = readFile(directory + QString::fromLatin1("/wsdl_service.h"));
+        QVERIFY(header.contains("phrase"));
+        QVERIFY(header.contains("MyAuthenticate"));
+
+        // Without the catalog or the cache, nothing is downloaded either
+        QVERIFY(QFile::remove(directory + QString::fromLatin1("/wsdl_service.h")));
+        runKDWsdl2Cpp(directory, QStringList() << QString::fromLatin1("-offline") << arguments.mid(3), &output);
+        QVERIFY2(output.contains("Not downloading '" + remote.toLatin1()), output.constData());
+    }
+
+    void testLateSyntaxError()
+    {
+        // The document is parsed while it is read, so the error comes after the first definitions
+        const QString directory = QString::fromLatin1("late_syntax_error");
+        QVERIFY(cleanDirectory(directory));
+        const QByteArray wsdl =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<definitions name=\"Late\" targetNamespace=\"http://www.example.com/late\" xmlns=\"http://schemas.xmlsoap.org/wsdl/\"\n"
+            "    xmlns:tns=\"http://www.example.com/late\" xmlns:soap=\"http://schemas.xmlsoap.org/wsdl/soap/\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\">\n"
+            "  <types>\n"
+            "    <xsd:schema targetNamespace=\"http://www.example.com/late\">\n"
+            "      <xsd:include/>\n"
+            "      <xsd:element name=\"value\" type=\"xsd:string\"/>\n"
+            "    </xsd:schema>\n"
+            "  </types>\n"
+            "  <message name=\"request\">\n"
+            "    <part name=\"parameters\" element=\"tns:value\"/>\n"
+            "  </message>\n"
+            "  <portType name=\"LatePortType\">\n"
+            "    <operation name=\"send\">\n"
+            "      <input message=\"tns:request\"/>\n"
+            "    </operation>\n"
+            "  </portType>\n"
+            "  <binding name=\"LateBinding\" type=\"tns:LatePortType\">\n"
+            "    <soap:binding style=\"document\" transport=\"http://schemas.xmlsoap.org/soap/http\"/>\n"
+            "    <operation name=\"send\">\n"
+            "      <soap:operation soapAction=\"send\"/>\n"
+            "      <input><soap:body use=\"literal\"/></input>\n"
+            "    </operation>\n"
+            "  </binding>\n"
+            "  <service name=\"LateService\">\n"
+            "    <port name=\"LatePort\" binding=\"tns:LateBinding\">\n"
+            "      <soap:address location=\"http://www.example.com/late\"/>\n"
+            "    </port>\n"
+            "  </service>\n"
+            "</definitions>\n";
+        const QStringList arguments = QStringList() << QString::fromLatin1("late.wsdl") << QString::fromLatin1("-o") << QString::fromLatin1("wsdl_late.h");
+
+        // Valid: the elements built while reading have no position, the reader gives it
+        QVERIFY(writeFile(directory + QString::fromLatin1("/late.wsdl"), wsdl));
+        QByteArray output;
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 0);
+        QVERIFY2(output.contains("include tag found at (6, "), output.constData());
+        QVERIFY(readFile(directory + QString::fromLatin1("/wsdl_late.h")).contains("LateService"));
+
+        // A mismatched end tag in the middle of the document
+        QByteArray broken = wsdl;
+        broken.replace("  </portType>", "  </porttype>");
+        QVERIFY(writeFile(directory + QString::fromLatin1("/late.wsdl"), broken));
+        QVERIFY(QFile::remove(directory + QString::fromLatin1("/wsdl_late.h")));
+        QCOMPARE(runKDWsdl2Cpp(directory, arguments, &output), 2);
+        QVERIFY2(output.contains(" at (17,"), output.constData());
+        QVERIFY(!QFile::exists(directory + QString::fromLatin1("/wsdl_late.h")));
+    }
+
+private:
+    // Returns the exit code of kdwsdl2cpp; its output goes to the test output, or into *output
+    static int runKDWsdl2Cpp(const QString &workingDirectory, const QStringList &arguments, QByteArray *output = 0)
+    {
+        QProcess process;
+        process.setWorkingDirectory(workingDirectory);
+        process.setProcessChannelMode(output ? QProcess::MergedChannels : QProcess::ForwardedChannels);
+        // Same QHash order in every run, so that only the options under test can change the output
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert(QString::fromLatin1("QT_HASH_SEED"), QString::fromLatin1("0"));
+        process.setProcessEnvironment(environment);
+        process.start(QString::fromLatin1(KDWSDL2CPP), arguments);
+        if (!process.waitForFinished(10 * 60 * 1000)) {
+            qWarning("kdwsdl2cpp didn't finish: %s", qPrintable(process.errorString()));
+            return -1;
+        }
+        if (output) {
+            *output = process.readAll();
+        }
+        return process.exitStatus() == QProcess::NormalExit ? process.exitCode() : -1;
+    }
+
+    // Generates wsdl_services.h and wsdl_services.cpp into directory, like KDSOAP_GENERATE_WSDL does
+    static bool generate(const QString &directory, const QString &wsdl, const QStringList &options)
+    {
+        if (!cleanDirectory(directory)) {
+            return false;
+        }
+        const QString header = QString::fromLatin1("wsdl_services.h");
+        const QString impl = QString::fromLatin1("wsdl_services.cpp");
+        return runKDWsdl2Cpp(directory, QStringList() << options << wsdl << QString::fromLatin1("-o") << header) == 0 &&
+               runKDWsdl2Cpp(directory, QStringList() << options << QString::fromLatin1("-impl") << header << wsdl << QString::fromLatin1("-o") << impl) == 0;
+    }
+
+    // Creates directory, or removes the files left in it by a previous run
+    static bool cleanDirectory(const QString &directory)
+    {
+        QDir dir(directory);
+        if (!dir.exists()) {
+            return QDir().mkpath(directory);
+        }
+        Q_FOREACH (const QString &file, dir.entryList(QDir::Files)) {
+            if (!dir.remove(file)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool writeFile(const QString &fileName, const QByteArray &data)
+    {
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+    }
+
+    static QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+};
+
+QTEST_MAIN(TestKDWsdl2CppOptions)
+
+#include "kdwsdl2cpp_options.moc"
@@ -0,0 +1,9 @@
+include( $${TOP_SOURCE_DIR}/unittests/unittests.pri )
+SOURCES = kdwsdl2cpp_options.cpp
+test.target = test
+test.commands = ./$(TARGET)
+test.depends = first
+QMAKE_EXTRA_TARGETS += test
+
+# The test runs kdwsdl2cpp on WSDL files of the source tree
+DEFINES += KDWSDL2CPP=\\\"$${TOP_BUILD_DIR}/bin/kdwsdl2cpp\\\" SRCDIR=\\\"$$PWD/\\\"
@@ -22,9 +22,122 @@
 **********************************************************************/
 
 #include "KDSoapMessage.h"
+#include "KDSoapNamespaceManager.h"
 #include "KDSoapMessageReader_p.h"
+#include "KDSoapMessageWriter_p.h"
+#include "KDSoapMtomPackage_p.h"
+#include "KDSoapElementReader.h"
+#include "KDDateTime.h"
+#include "KDSoapBinaryElementHandler.h"
 #include <QtTest/QtTest>
 
+#if defined(Q_OS_LINUX) && defined(Q_COMPILER_NOEXCEPT)
+#include <cstdlib>
+#include <new>
+#define COUNT_ALLOCATIONS
+
+// Counts the heap allocations made while an AllocationCounter exists, to measure the memory footprint
+// of values. Replacing the global operator new in the test executable also covers the libraries.
+static bool s_countAllocations = false;
+static int s_allocationCount = 0;
+static qint64 s_allocatedBytes = 0;
+static size_t s_largestAllocation = 0;
+
+void *operator new(size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocationCount;
+        s_allocatedBytes += size;
+        s_largestAllocation = qMax(s_largestAllocation, size);
+    }
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+class AllocationCounter
+{
+public:
+    AllocationCounter()
+    {
+        s_allocationCount = 0;
+        s_allocatedBytes = 0;
+        s_largestAllocation = 0;
+        s_countAllocations = true;
+    }
+    ~AllocationCounter()
+    {
+        s_countAllocations = false;
+    }
+    int count() const
+    {
+        return s_allocationCount;
+    }
+    qint64 bytes() const
+    {
+        return s_allocatedBytes;
+    }
+    qint64 largest() const
+    {
+        return qint64(s_largestAllocation);
+    }
+};
+#endif
+
+// Only keeps the SHA-1 of what is written, so that the test itself doesn't hold the data
+class HashingDevice : public QIODevice
+{
+public:
+    HashingDevice()
+        : m_hash(QCryptographicHash::Sha1)
+    {
+        open(QIODevice::WriteOnly);
+    }
+    QByteArray result() const
+    {
+        return m_hash.result();
+    }
+
+protected:
+    virtual qint64 readData(char *, qint64)
+    {
+        return -1;
+    }
+    virtual qint64 writeData(const char *data, qint64 size)
+    {
+        m_hash.addData(data, int(size));
+        return size;
+    }
+
+private:
+    QCryptographicHash m_hash;
+};
+
+class SkippingElementReader : public KDSoapElementReader
+{
+public:
+    virtual void readElement(QXmlStreamReader &reader)
+    {
+        skipElement(reader);
+    }
+};
+
+class HashingHandler : public KDSoapBinaryElementHandler
+{
+public:
+    virtual QIODevice *createDevice(const QString &nameSpace, const QString &name, const QString &typeNameSpace, const QString &type)
+    {
+        return handlesElement(nameSpace, name, typeNameSpace, type) ? new HashingDevice : 0;
+    }
+};
+
 class TestMessageReader : public QObject
 {
     Q_OBJECT
@@ -77,6 +190,422 @@ private Q_SLOTS:
             qDebug() << msg2;
         }
     }
+
+    void testTypedValues()
+    {
+        const QByteArray xml =
+            "<soapenv:Envelope xmlns:soapenv=\"http://schemas.xmlsoap.org/soap/envelope/\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">"
+            "<soapenv:Body>"
+            "<getValuesResponse>"
+            "<count xsi:type=\"xsd:int\">42</count>"
+            "<big xsi:type=\"xsd:unsignedInt\">4000000000</big>"
+            "<flag xsi:type=\"xsd:boolean\">true</flag>"
+            "<other xsi:type=\"xsd:boolean\">0</other>"
+            "<ratio xsi:type=\"xsd:double\">0.25</ratio>"
+            "<day xsi:type=\"xsd:date\">2011-02-03</day>"
+            "<when xsi:type=\"xsd:dateTime\">2011-02-03T04:05:06Z</when>"
+            "<bad xsi:type=\"xsd:int\">abc</bad>"
+            "<untyped>42</untyped>"
+            "</getValuesResponse>"
+            "</soapenv:Body>"
+            "</soapenv:Envelope>";
+        const KDSoapMessageReader reader;
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QCOMPARE(reader.xmlToMessage(xml, &msg, 0, &headers), KDSoapMessageReader::NoError);
+        const KDSoapValueList &args = msg.childValues();
+        QCOMPARE(args.child(QLatin1String("count")).value().userType(), int(QVariant::Int));
+        QCOMPARE(args.child(QLatin1String("count")).value().toInt(), 42);
+        QCOMPARE(args.child(QLatin1String("big")).value().toULongLong(), Q_UINT64_C(4000000000));
+        QCOMPARE(args.child(QLatin1String("flag")).value().userType(), int(QVariant::Bool));
+        QCOMPARE(args.child(QLatin1String("flag")).value().toBool(), true);
+        QCOMPARE(args.child(QLatin1String("other")).value().toBool(), false);
+        QCOMPARE(args.child(QLatin1String("ratio")).value().userType(), int(QVariant::Double));
+        QCOMPARE(args.child(QLatin1String("ratio")).value().toDouble(), 0.25);
+        QCOMPARE(args.child(QLatin1String("day")).value().toDate(), QDate(2011, 2, 3));
+        // dateTime stays a string, applications call toString() on it
+        QCOMPARE(args.child(QLatin1String("when")).value().toString(), QString::fromLatin1("2011-02-03T04:05:06Z"));
+        QCOMPARE(args.child(QLatin1String("bad")).value().toString(), QString::fromLatin1("abc"));
+        QCOMPARE(args.child(QLatin1String("untyped")).value().userType(), int(QVariant::String));
+
+        // With a type hint, the text is parsed straight from the stream
+        QXmlStreamReader xmlReader(QByteArray("<a><b>17</b><c>2011-02-03T04:05:06Z</c><d></d></a>"));
+        QVERIFY(xmlReader.readNextStartElement());
+        QVERIFY(xmlReader.readNextStartElement());
+        const QVariant b = KDSoapElementReader::readText(xmlReader, QVariant::LongLong);
+        QCOMPARE(b.userType(), int(QVariant::LongLong));
+        QCOMPARE(b.toLongLong(), Q_INT64_C(17));
+        QVERIFY(xmlReader.readNextStartElement());
+        const QVariant c = KDSoapElementReader::readText(xmlReader, qMetaTypeId<KDDateTime>());
+        QCOMPARE(c.userType(), qMetaTypeId<KDDateTime>());
+        QCOMPARE(c.value<KDDateTime>().timeZone(), QString::fromLatin1("Z"));
+        QVERIFY(xmlReader.readNextStartElement());
+        QVERIFY(!KDSoapElementReader::readText(xmlReader, QVariant::Int).isValid());
+    }
+
+    void testBinaryElementHandler()
+    {
+        QByteArray content;
+        for (int i = 0; i < 200000; ++i) {
+            content += char(i % 251);
+        }
+        const QByteArray base64 = content.toBase64();
+        const QByteArray xml =
+            "<soapenv:Envelope xmlns:soapenv=\"http://schemas.xmlsoap.org/soap/envelope/\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+            "<soapenv:Body>"
+            "<n1:getDocumentResponse>"
+            "<n1:content>" + base64.left(1000) + "\n" + base64.mid(1000) + "</n1:content>"
+            "<n1:thumbnail xsi:type=\"xsd:base64Binary\">" + base64.left(400) + "</n1:thumbnail>"
+            "<n1:name>doc.pdf</n1:name>"
+            "</n1:getDocumentResponse>"
+            "</soapenv:Body>"
+            "</soapenv:Envelope>";
+
+        KDSoapBinaryElementHandler handler;
+        handler.addElement(QString::fromLatin1("http://www.kdab.com/xml/MyWsdl/"), QString::fromLatin1("content"));
+        handler.setHandleBase64Type(true);
+        KDSoapMessageReader reader;
+        reader.setBinaryElementHandler(&handler);
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QCOMPARE(reader.xmlToMessage(xml, &msg, 0, &headers), KDSoapMessageReader::NoError);
+
+        const QSharedPointer<QIODevice> device = KDSoapBinaryElementHandler::device(msg.childValues().child(QLatin1String("content")));
+        QVERIFY(device);
+        QVERIFY(device->reset());
+        QCOMPARE(device->readAll(), content);
+        const QSharedPointer<QIODevice> thumbnail = KDSoapBinaryElementHandler::device(msg.childValues().child(QLatin1String("thumbnail")));
+        QVERIFY(thumbnail);
+        QVERIFY(thumbnail->reset());
+        QCOMPARE(thumbnail->readAll(), content.left(300));
+        QCOMPARE(msg.childValues().child(QLatin1String("name")).value().toString(), QString::fromLatin1("doc.pdf"));
+        QVERIFY(!KDSoapBinaryElementHandler::device(msg.childValues().child(QLatin1String("name"))));
+    }
+
+    void testLargeBinaryElement_data()
+    {
+        QTest::addColumn<int>("size");
+        QTest::addColumn<QString>("handledElement");
+        QTest::addColumn<QByteArray>("namePrefix");
+
+        const QString content = QString::fromLatin1("content");
+        // Read from QXmlStreamReader, or decoded from the message bytes
+        QTest::newRow("small") << 1000 << content << QByteArray("");
+        QTest::newRow("large") << 300000 << content << QByteArray("");
+        // Large, but not handled: its value is the text, as usual
+        QTest::newRow("large_not_handled") << 300000 << QString::fromLatin1("title") << QByteArray("");
+        // The invalid character reference is removed from the message, which is then parsed again
+        QTest::newRow("large_not_well_formed") << 300000 << content << QByteArray("&#x13;");
+    }
+
+    void testLargeBinaryElement()
+    {
+        QFETCH(int, size);
+        QFETCH(QString, handledElement);
+        QFETCH(QByteArray, namePrefix);
+        const QByteArray content = binaryContent(size);
+        QByteArray xml = binaryEnvelope(content, "title");
+        xml.replace("<n1:name>doc.pdf", "<n1:name>" + namePrefix + "doc.pdf");
+
+        HashingHandler handler;
+        handler.addElement(QString::fromLatin1("http://www.kdab.com/xml/MyWsdl/"), handledElement);
+        KDSoapMessageReader reader;
+        reader.setBinaryElementHandler(&handler);
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QCOMPARE(reader.xmlToMessage(xml, &msg, 0, &headers), KDSoapMessageReader::NoError);
+
+        const KDSoapValue contentValue = msg.childValues().child(QLatin1String("content"));
+        const QSharedPointer<QIODevice> device = KDSoapBinaryElementHandler::device(contentValue);
+        if (handledElement == QLatin1String("content")) {
+            QVERIFY(device);
+            QCOMPARE(static_cast<HashingDevice *>(device.data())->result(), QCryptographicHash::hash(content, QCryptographicHash::Sha1));
+        } else {
+            QVERIFY(!device);
+            QCOMPARE(QByteArray::fromBase64(contentValue.value().toString().toLatin1()), content);
+        }
+        const QString expectedName = namePrefix.isEmpty() ? QString::fromLatin1("doc.pdf") : QString::fromLatin1("?doc.pdf");
+        QCOMPARE(msg.childValues().child(QLatin1String("name")).value().toString(), expectedName);
+    }
+
+    void testBinaryElementMemory()
+    {
+        // 8 MB of data, 11 MB of text: parsing it must not allocate anything of that size
+        const QByteArray content = binaryContent(8 * 1024 * 1024);
+        const QByteArray xml = binaryEnvelope(content, "title");
+
+        HashingHandler handler;
+        handler.addElement(QString::fromLatin1("http://www.kdab.com/xml/MyWsdl/"), QString::fromLatin1("content"));
+        KDSoapMessageReader reader;
+        reader.setBinaryElementHandler(&handler);
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        {
+#ifdef COUNT_ALLOCATIONS
+            AllocationCounter counter;
+#endif
+            QCOMPARE(reader.xmlToMessage(xml, &msg, 0, &headers), KDSoapMessageReader::NoError);
+#ifdef COUNT_ALLOCATIONS
+            qDebug("Decoding %d bytes: largest allocation %lld bytes", content.size(), counter.largest());
+            QVERIFY(counter.largest() < 1024 * 1024);
+#endif
+        }
+
+        const QSharedPointer<QIODevice> device = KDSoapBinaryElementHandler::device(msg.childValues().child(QLatin1String("content")));
+        QVERIFY(device);
+        QCOMPARE(static_cast<HashingDevice *>(device.data())->result(), QCryptographicHash::hash(content, QCryptographicHash::Sha1));
+    }
+
+    void testBinaryElementHandlerWithBodyReader()
+    {
+        // The body reader would read the binary elements itself, and the handler wouldn't get them
+        const QByteArray xml = binaryEnvelope(binaryContent(1000), "title");
+        KDSoapBinaryElementHandler handler;
+        handler.addElement(QString::fromLatin1("http://www.kdab.com/xml/MyWsdl/"), QString::fromLatin1("content"));
+        KDSoapMessageReader reader;
+        reader.setBinaryElementHandler(&handler);
+        SkippingElementReader bodyReader;
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QTest::ignoreMessage(QtWarningMsg, "ERROR: A binary element handler can't be used with the stream deserializers of the generated code");
+        QCOMPARE(reader.xmlToMessage(xml, &msg, 0, &headers, &bodyReader), KDSoapMessageReader::ParseError);
+        QVERIFY(msg.isFault());
+        QVERIFY(msg.faultAsString().contains(QLatin1String("binary element handler")));
+    }
+
+    void testMtom()
+    {
+        QByteArray content;
+        for (int i = 0; i < 100000; ++i) {
+            content += char(i % 251);
+        }
+        KDSoapMessage request;
+        request.addArgument(QString::fromLatin1("content"), content);
+        request.addArgument(QString::fromLatin1("hex"), QByteArray("KD"), KDSoapNamespaceManager::xmlSchema2001(), QString::fromLatin1("hexBinary"));
+        request.addArgument(QString::fromLatin1("name"), QString::fromLatin1("doc.pdf"));
+        KDSoapMtomPackage package;
+        KDSoapMessageWriter writer;
+        writer.setMessageNamespace(QString::fromLatin1("http://www.kdab.com/xml/MyWsdl/"));
+        writer.setMtomPackage(&package);
+        const QByteArray envelope = writer.messageToXml(request, QString::fromLatin1("upload"), KDSoapHeaders(), QMap<QString, KDSoapMessage>());
+        QVERIFY(envelope.contains("<xop:Include href=\"cid:1."));
+        QVERIFY(envelope.contains("<hex>4b44</hex>"));
+        QVERIFY(!envelope.contains(content.toBase64().left(100)));
+        const QByteArray soapContentType = "application/soap+xml;charset=utf-8;action=urn:upload";
+        const QByteArray contentType = package.contentType(soapContentType);
+        QVERIFY(KDSoapMtomPackage::isMultipart(contentType));
+        const QByteArray body = package.toMultipart(envelope, soapContentType);
+        QVERIFY(body.contains(content));
+
+        KDSoapMtomPackage received;
+        QVERIFY(received.parse(contentType, body));
+        QCOMPARE(received.rootPart(), envelope);
+        QCOMPARE(received.soapContentType(), QByteArray("application/soap+xml;action=\"urn:upload\""));
+
+        // Without a handler, the value is the base64 text, as if it had been sent without MTOM
+        KDSoapMessageReader reader;
+        reader.setMtomPackage(&received);
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QCOMPARE(reader.xmlToMessage(received.rootPart(), &msg, 0, &headers), KDSoapMessageReader::NoError);
+        QCOMPARE(msg.childValues().child(QLatin1String("content")).value().toString(), QString::fromLatin1(content.toBase64()));
+        QCOMPARE(msg.childValues().child(QLatin1String("hex")).value().toString(), QString::fromLatin1("4b44"));
+        QCOMPARE(msg.childValues().child(QLatin1String("name")).value().toString(), QString::fromLatin1("doc.pdf"));
+
+        // The element readers get the same text
+        KDSoapMessage reconstituted;
+        QCOMPARE(KDSoapMessageReader().xmlToMessage(received.reconstitutedRootPart(), &reconstituted, 0, &headers), KDSoapMessageReader::NoError);
+        QCOMPARE(reconstituted.childValues().child(QLatin1String("content")).value().toString(), QString::fromLatin1(content.toBase64()));
+
+        // With a handler, the attachment is copied into the device
+        KDSoapBinaryElementHandler handler;
+        handler.addElement(QString(), QString::fromLatin1("content"));
+        reader.setBinaryElementHandler(&handler);
+        QCOMPARE(reader.xmlToMessage(received.rootPart(), &msg, 0, &headers), KDSoapMessageReader::NoError);
+        const QSharedPointer<QIODevice> device = KDSoapBinaryElementHandler::device(msg.childValues().child(QLatin1String("content")));
+        QVERIFY(device);
+        QVERIFY(device->reset());
+        QCOMPARE(device->readAll(), content);
+    }
+
+    void testMtomFromOtherImplementation()
+    {
+        // Preamble, root part after the attachment, URL-encoded Content-ID, SOAP 1.1
+        const QByteArray contentType = "Multipart/Related; boundary=\"uuid:0ca0e16e\"; type=\"application/xop+xml\"; start=\"<root.message@cxf.apache.org>\"; start-info=\"text/xml\"";
+        const QByteArray body =
+            "This is a multi-part message in MIME format\r\n"
+            "--uuid:0ca0e16e\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            "Content-Transfer-Encoding: binary\r\n"
+            "Content-ID: <a1@example.org>\r\n"
+            "\r\n"
+            "\x01\x02\r\n--uuid\r\n"
+            "--uuid:0ca0e16e\r\n"
+            "Content-Type: application/xop+xml; charset=UTF-8; type=\"text/xml\"\r\n"
+            "Content-ID: <root.message@cxf.apache.org>\r\n"
+            "\r\n"
+            "<soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\"><soap:Body>"
+            "<ns2:getDocumentResponse xmlns:ns2=\"http://www.kdab.com/xml/MyWsdl/\">"
+            "<content><xop:Include xmlns:xop=\"http://www.w3.org/2004/08/xop/include\" href=\"cid:a1%40example.org\"/></content>"
+            "</ns2:getDocumentResponse></soap:Body></soap:Envelope>\r\n"
+            "--uuid:0ca0e16e--\r\n";
+        KDSoapMtomPackage package;
+        QVERIFY(package.parse(contentType, body));
+        QCOMPARE(package.soapContentType(), QByteArray("text/xml"));
+        KDSoapMessageReader reader;
+        reader.setMtomPackage(&package);
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QCOMPARE(reader.xmlToMessage(package.rootPart(), &msg, 0, &headers), KDSoapMessageReader::NoError);
+        QCOMPARE(msg.name(), QString::fromLatin1("getDocumentResponse"));
+        QCOMPARE(msg.childValues().child(QLatin1String("content")).value().toString(), QString::fromLatin1(QByteArray("\x01\x02\r\n--uuid").toBase64()));
+
+        // A missing attachment is an error
+        KDSoapMessage faultMsg;
+        QCOMPARE(reader.xmlToMessage(QByteArray(package.rootPart()).replace("cid:a1", "cid:a2"), &faultMsg, 0, &headers), KDSoapMessageReader::ParseError);
+        QVERIFY(faultMsg.isFault());
+    }
+
+    void testArenaAllocation()
+    {
+        KDSoapMessageReader reader;
+        reader.setArenaAllocation(true);
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        QCOMPARE(reader.xmlToMessage(largeEnvelope(10), &msg, 0, &headers), KDSoapMessageReader::NoError);
+        QCOMPARE(msg.childValues().count(), 10);
+
+        // Values keep their memory alive after the message is gone, and can be modified
+        KDSoapValue item = msg.childValues().last();
+        msg = KDSoapMessage();
+        QCOMPARE(item.name(), QString::fromLatin1("item"));
+        QCOMPARE(item.childValues().child(QLatin1String("id")).value().toString(), QString::fromLatin1("9"));
+        KDSoapValue copy = item;
+        copy.setValue(QString::fromLatin1("changed"));
+        QCOMPARE(item.value().toString(), QString());
+        QCOMPARE(copy.value().toString(), QString::fromLatin1("changed"));
+    }
+
+    void testLeafValueFootprint()
+    {
+#ifdef COUNT_ALLOCATIONS
+        const QString name = QString::fromLatin1("id");
+        int allocations;
+        qint64 bytes;
+        {
+            AllocationCounter counter;
+            KDSoapValue leaf(name, 42);
+            allocations = counter.count();
+            bytes = counter.bytes();
+        }
+        qDebug("A leaf value with a shared name and an int value: %d allocation(s), %lld bytes", allocations, bytes);
+        // Only the private data: the name is shared, the int is stored inline, the child values aren't allocated
+        QCOMPARE(allocations, 1);
+        // It used to embed an empty KDSoapValueList, next to its name, namespace, type and value
+        QVERIFY(bytes < qint64(sizeof(KDSoapValueList) + 4 * sizeof(QString) + sizeof(QVariant)));
+        // Nothing for the arena when it isn't used: only the reference count, the flags and the child values pointer
+        QVERIFY(bytes <= qint64(4 * sizeof(QString) + sizeof(QVariant) + 3 * sizeof(void *)));
+        if (sizeof(void *) == 8) {
+            // The flags are in the padding after the reference count
+            QVERIFY(bytes <= qint64(4 * sizeof(QString) + sizeof(QVariant) + 2 * sizeof(void *)));
+        }
+#else
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+        QSKIP("allocations are only counted on Linux");
+#else
+        QSKIP("allocations are only counted on Linux", SkipSingle);
+#endif
+#endif
+    }
+
+    void testParsedMessageFootprint()
+    {
+        const int items = 1000;
+        const QByteArray xml = largeEnvelope(items);
+        KDSoapMessageReader reader;
+        KDSoapMessage msg;
+        KDSoapHeaders headers;
+        {
+#ifdef COUNT_ALLOCATIONS
+            AllocationCounter counter;
+#endif
+            QCOMPARE(reader.xmlToMessage(xml, &msg, 0, &headers), KDSoapMessageReader::NoError);
+#ifdef COUNT_ALLOCATIONS
+            qDebug("Parsing %d items of 5 values: %d allocations, %lld bytes", items, counter.count(), counter.bytes());
+#endif
+        }
+
+        // The elements with the same name share one string instead of each holding a copy
+        const KDSoapValueList &children = msg.childValues();
+        QCOMPARE(children.count(), items);
+        QVERIFY(children.at(0).name().constData() == children.at(items - 1).name().constData());
+        QVERIFY(children.at(0).childValues().at(1).name().constData() == children.at(items - 1).childValues().at(1).name().constData());
+    }
+
+    void benchmarkParseLargeMessage_data()
+    {
+        QTest::addColumn<bool>("arena");
+        QTest::newRow("heap") << false;
+        QTest::newRow("arena") << true;
+    }
+
+    void benchmarkParseLargeMessage()
+    {
+        QFETCH(bool, arena);
+        const QByteArray xml = largeEnvelope(5000);
+        KDSoapMessageReader reader;
+        reader.setArenaAllocation(arena);
+        QBENCHMARK {
+            KDSoapMessage msg;
+            KDSoapHeaders headers;
+            reader.xmlToMessage(xml, &msg, 0, &headers);
+        }
+    }
+
+private:
+    static QByteArray binaryContent(int size)
+    {
+        QByteArray content;
+        content.reserve(size);
+        for (int i = 0; i < size; ++i) {
+            content += char((i * 7) % 251);
+        }
+        return content;
+    }
+
+    // The content is sent as base64 lines ending with an encoded carriage return
+    static QByteArray binaryEnvelope(const QByteArray &content, const QByteArray &name)
+    {
+        const QByteArray base64 = content.toBase64();
+        QByteArray text;
+        for (int i = 0; i < base64.size(); i += 76) {
+            text += base64.mid(i, 76) + "&#13;\n";
+        }
+        return "<soapenv:Envelope xmlns:soapenv=\"http://schemas.xmlsoap.org/soap/envelope/\" xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+               "<soapenv:Body>"
+               "<n1:getDocumentResponse>"
+               "<n1:" + name + ">doc.pdf</n1:" + name + ">"
+               "<n1:content>" + text + "</n1:content>"
+               "<n1:name>doc.pdf</n1:name>"
+               "</n1:getDocumentResponse>"
+               "</soapenv:Body>"
+               "</soapenv:Envelope>";
+    }
+
+    static QByteArray largeEnvelope(int items)
+    {
+        QByteArray xml =
+            "<soapenv:Envelope xmlns:soapenv=\"http://schemas.xmlsoap.org/soap/envelope/\" xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+            "<soapenv:Body>"
+            "<n1:getItemsResponse>";
+        for (int i = 0; i < items; ++i) {
+            xml += "<item><id>" + QByteArray::number(i) + "</id><name>Item</name><price>4.5</price><available>true</available></item>";
+        }
+        xml += "</n1:getItemsResponse>"
+               "</soapenv:Body>"
+               "</soapenv:Envelope>";
+        return xml;
+    }
 };
 
 QTEST_MAIN(TestMessageReader)
@@ -42,6 +42,10 @@
 #ifndef QT_NO_OPENSSL
 #include <QSslConfiguration>
 #endif
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
 using namespace KDSoapUnitTestHelpers;
 
 Q_DECLARE_METATYPE(QFile::Permissions)
@@ -55,6 +59,29 @@ class CountryServerObject;
 typedef QMap<QThread *, CountryServerObject *> ServerObjectsMap;
 ServerObjectsMap s_serverObjects;
 QMutex s_serverObjectsMutex;
+QList<int> s_lastServerObjectCpus; // CPUs the thread of the last server object was allowed to run on
+
+// The CPUs this process may run on, which can be a subset in containers or CI (restricted cpuset)
+static QList<int> processCpus()
+{
+    QList<int> cpus;
+#ifdef Q_OS_LINUX
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpuSet)) {
+                cpus.append(cpu);
+            }
+        }
+    }
+#else
+    for (int cpu = 0; cpu < qMax(1, QThread::idealThreadCount()); ++cpu) {
+        cpus.append(cpu);
+    }
+#endif
+    return cpus;
+}
 
 class PublicThread : public QThread
 {
@@ -87,6 +114,18 @@ public:
         //qDebug() << "Server object created in thread" << QThread::currentThread();
         QMutexLocker locker(&s_serverObjectsMutex);
         s_serverObjects.insert(QThread::currentThread(), this);
+        s_lastServerObjectCpus.clear();
+#ifdef Q_OS_LINUX
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &cpuSet)) {
+                    s_lastServerObjectCpus.append(cpu);
+                }
+            }
+        }
+#endif
     }
     ~CountryServerObject()
     {
@@ -475,6 +514,84 @@ private Q_SLOTS:
         QCOMPARE(QString::fromLatin1(QByteArray::fromBase64(response.value().toByteArray()).constData()), QString::fromLatin1("KDSoap"));
     }
 
+    void testMtom_data()
+    {
+        QTest::addColumn<int>("soapVersion");
+        QTest::addColumn<QByteArray>("soapContentType");
+        QTest::addColumn<QByteArray>("envelopeNamespace");
+        QTest::newRow("SOAP 1.1") << int(KDSoapClientInterface::SOAP1_1) << QByteArray("text/xml") << QByteArray("http://schemas.xmlsoap.org/soap/envelope/");
+        QTest::newRow("SOAP 1.2") << int(KDSoapClientInterface::SOAP1_2) << QByteArray("application/soap+xml") << QByteArray("http://www.w3.org/2003/05/soap-envelope");
+    }
+
+    void testMtom()
+    {
+        QFETCH(int, soapVersion);
+        QFETCH(QByteArray, soapContentType);
+        QFETCH(QByteArray, envelopeNamespace);
+        CountryServerThread serverThread;
+        CountryServer *server = serverThread.startThread();
+
+        // Round-trip: the server replies with MTOM, which the client must understand
+        {
+            KDSoapClientInterface client(server->endPoint(), countryMessageNamespace());
+            client.setSoapVersion(KDSoapClientInterface::SoapVersion(soapVersion));
+            client.setMtomEnabled(true);
+            KDSoapMessage message;
+            message.addArgument(QLatin1String("a"), QByteArray("KD"), KDSoapNamespaceManager::xmlSchema2001(), QString::fromLatin1("base64Binary"));
+            message.addArgument(QLatin1String("b"), QByteArray("Soap"), KDSoapNamespaceManager::xmlSchema2001(), QString::fromLatin1("hexBinary"));
+            const KDSoapMessage response = client.call(QLatin1String("hexBinaryTest"), message, QString::fromLatin1("ActionHex"));
+            QVERIFY2(!response.isFault(), qPrintable(response.faultAsString()));
+            QCOMPARE(QString::fromLatin1(QByteArray::fromBase64(response.value().toByteArray()).constData()), QString::fromLatin1("KDSoap"));
+        }
+
+        // The reply declares the media type of the SOAP version of the request
+        ClientSocket socket(server);
+        QVERIFY(socket.waitForConnected());
+        const QByteArray envelope = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><soap:Envelope xmlns:soap=\"" + envelopeNamespace + "\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">"
+                                    "<soap:Body><n1:hexBinaryTest xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+                                    "<a xsi:type=\"xsd:base64Binary\"><xop:Include xmlns:xop=\"http://www.w3.org/2004/08/xop/include\" href=\"cid:a\"/></a>"
+                                    "<b xsi:type=\"xsd:hexBinary\">536f6170</b>"
+                                    "</n1:hexBinaryTest></soap:Body></soap:Envelope>";
+        const QByteArray body = "--MIME\r\n"
+                                "Content-Type: application/xop+xml;charset=utf-8;type=\"" + soapContentType + "\"\r\n"
+                                "Content-ID: <root>\r\n"
+                                "\r\n" + envelope + "\r\n"
+                                "--MIME\r\n"
+                                "Content-Type: application/octet-stream\r\n"
+                                "Content-ID: <a>\r\n"
+                                "\r\n"
+                                "KD\r\n"
+                                "--MIME--\r\n";
+        socket.write("POST / HTTP/1.1\r\n"
+                     "SoapAction: ActionHex\r\n" // SOAP 1.1
+                     "Content-Type: multipart/related;type=\"application/xop+xml\";start=\"<root>\";start-info=\"" + soapContentType + "\";action=\"ActionHex\";boundary=\"MIME\"\r\n"
+                     "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                     "Host: 127.0.0.1:12345\r\n" // ignored
+                     "\r\n" + body);
+        QVERIFY(socket.waitForBytesWritten());
+        QByteArray response;
+        while (!response.endsWith("--\r\n") && socket.waitForReadyRead()) {
+            response += socket.readAll();
+        }
+        QVERIFY2(response.startsWith("HTTP/1.1 200 OK\r\n"), response.constData());
+        QVERIFY2(response.contains("\r\nContent-Type: multipart/related;type=\"application/xop+xml\";"), response.constData());
+        QVERIFY2(response.contains(";start-info=\"" + soapContentType + "\";"), response.constData());
+        QVERIFY2(response.contains("Content-Type: application/xop+xml;charset=utf-8;type=\"" + soapContentType + "\"\r\n"), response.constData());
+        QVERIFY2(response.contains("\"" + envelopeNamespace + "\""), response.constData());
+
+        // Same connection: a request which fails before being parsed gets a plain reply
+        socket.write("GET /not/a/file HTTP/1.1\r\n"
+                     "Host: 127.0.0.1:12345\r\n"
+                     "\r\n");
+        QVERIFY(socket.waitForBytesWritten());
+        response.clear();
+        while (!response.contains("</soap:Envelope>") && socket.waitForReadyRead()) {
+            response += socket.readAll();
+        }
+        QVERIFY2(response.contains("\r\nContent-Type: text/xml"), response.constData());
+        QVERIFY(!response.contains("multipart/related"));
+    }
+
     void testMethodNotFound()
     {
         CountryServerThread serverThread;
@@ -522,6 +639,72 @@ private Q_SLOTS:
         QCOMPARE(s_serverObjects.count(), 0);
     }
 
+    void testThreadPoolCpuSets()
+    {
+        const QList<int> cpus = processCpus();
+        if (cpus.isEmpty()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+            QSKIP("can't determine the CPUs this process may run on");
+#else
+            QSKIP("can't determine the CPUs this process may run on", SkipSingle);
+#endif
+        }
+        // Not the first allowed CPU if possible, so that the test doesn't pass by chance
+        const int cpu = cpus.last();
+        {
+            KDSoapThreadPool threadPool;
+            QList<QList<int> > cpuSets;
+            cpuSets << (QList<int>() << cpu);
+            threadPool.setThreadCpuSets(cpuSets);
+            QCOMPARE(threadPool.threadCpuSets(), cpuSets);
+            CountryServerThread serverThread(&threadPool);
+            CountryServer *server = serverThread.startThread();
+
+            makeSimpleCall(server->endPoint());
+            QCOMPARE(s_serverObjects.count(), 1);
+#ifdef Q_OS_LINUX
+            QCOMPARE(s_lastServerObjectCpus, QList<int>() << cpu);
+#endif
+        }
+        QCOMPARE(s_serverObjects.count(), 0);
+    }
+
+    void benchmarkThreadPoolCpuSets_data()
+    {
+        QTest::addColumn<bool>("pinned");
+
+        QTest::newRow("unpinned") << false;
+        QTest::newRow("pinned") << true;
+    }
+
+    // Compare e.g. with: ./servertest benchmarkThreadPoolCpuSets -iterations 1000
+    void benchmarkThreadPoolCpuSets()
+    {
+        QFETCH(bool, pinned);
+        const int numThreads = 4;
+        KDSoapThreadPool threadPool;
+        threadPool.setMaxThreadCount(numThreads);
+        if (pinned) {
+            // One thread per CPU, round-robin over the available CPUs
+            const QList<int> cpus = processCpus();
+            QList<QList<int> > cpuSets;
+            for (int i = 0; i < numThreads && !cpus.isEmpty(); ++i) {
+                cpuSets << (QList<int>() << cpus.at(i % cpus.count()));
+            }
+            threadPool.setThreadCpuSets(cpuSets);
+        }
+        CountryServerThread serverThread(&threadPool);
+        CountryServer *server = serverThread.startThread();
+        KDSoapClientInterface client(server->endPoint(), countryMessageNamespace());
+        QBENCHMARK {
+            m_returnMessages.clear();
+            m_expectedMessages = numThreads;
+            makeAsyncCalls(client, numThreads);
+            m_eventLoop.exec();
+        }
+        QCOMPARE(m_returnMessages.count(), numThreads);
+    }
+
     void testMultipleThreads_data()
     {
         QTest::addColumn<int>("maxThreads");
@@ -867,6 +1050,204 @@ private Q_SLOTS:
         QFile::remove(fileName);
     }
 
+    void testJsonLogging()
+    {
+        CountryServerThread serverThread;
+        CountryServer *server = serverThread.startThread();
+
+        const QString fileName = QString::fromLatin1("output_json.log");
+        QFile::remove(fileName);
+        server->setLogFileName(fileName);
+        server->setLogLevel(KDSoapServer::LogEveryCall);
+        QCOMPARE(server->logFormat(), KDSoapServer::LogPlainText);
+        server->setLogFormat(KDSoapServer::LogJsonLines);
+        QCOMPARE(server->logFormat(), KDSoapServer::LogJsonLines);
+
+        makeSimpleCall(server->endPoint());
+        makeFaultyCall(server->endPoint());
+        server->flushLogFile();
+
+        const QList<QByteArray> lines = readLines(fileName);
+        QCOMPARE(lines.count(), 2);
+        Q_FOREACH (const QByteArray &line, lines) {
+            QVERIFY(line.startsWith("{\"time\":\""));
+            QVERIFY(line.endsWith("}}\n"));
+            // 127.0.0.1, IPv4-mapped when the server listens on both IPv4 and IPv6
+            QVERIFY(line.contains(",\"peer\":\"127.0.0.1\",") || line.contains(",\"peer\":\"::ffff:127.0.0.1\","));
+            QVERIFY(line.contains(",\"method\":\"getEmployeeCountry\""));
+            QVERIFY(line.contains(",\"soapAction\":\"http://www.kdab.com/xml/MyWsdl/getEmployeeCountry\""));
+            QVERIFY(line.contains(",\"requestBytes\":"));
+            QVERIFY(line.contains(",\"responseBytes\":"));
+            QVERIFY(line.contains(",\"us\":{\"headers\":"));
+            QVERIFY(line.contains(",\"parse\":"));
+            QVERIFY(line.contains(",\"dispatch\":"));
+            QVERIFY(line.contains(",\"serialize\":"));
+            QVERIFY(line.contains(",\"write\":"));
+            QVERIFY(line.contains(",\"total\":"));
+        }
+        QVERIFY(!lines.at(0).contains("\"fault\""));
+        QVERIFY(lines.at(1).contains(",\"fault\":\"Fault code Client.Data: Empty employee name (CountryServerObject)\""));
+
+        server->closeLogFile();
+        QFile::remove(fileName);
+    }
+
+    void testJsonLoggingKeepAlive()
+    {
+        CountryServerThread serverThread;
+        CountryServer *server = serverThread.startThread();
+
+        const QString fileName = QString::fromLatin1("output_json_keepalive.log");
+        QFile::remove(fileName);
+        server->setLogFileName(fileName);
+        server->setLogLevel(KDSoapServer::LogEveryCall);
+        server->setLogFormat(KDSoapServer::LogJsonLines);
+
+        ClientSocket socket(server);
+        QVERIFY(socket.waitForConnected());
+        const QByteArray message = rawCountryMessage();
+        socket.write("POST / HTTP/1.1\r\n"
+                     "SoapAction: http://www.kdab.com/xml/MyWsdl/getEmployeeCountry\r\n"
+                     "Content-Type: text/xml;charset=utf-8\r\n"
+                     "Content-Length: " + QByteArray::number(message.size()) + "\r\n"
+                     "Host: 127.0.0.1:12345\r\n" // ignored
+                     "\r\n" + message);
+        QVERIFY(socket.waitForBytesWritten());
+        verifySocketResponse(socket, "David Ä Faure");
+
+        // Same connection: a request which fails before any SOAP message is parsed
+        socket.write("GET /not/a/file HTTP/1.1\r\n"
+                     "Host: 127.0.0.1:12345\r\n"
+                     "\r\n");
+        QVERIFY(socket.waitForBytesWritten());
+        QByteArray response;
+        while (!response.contains("</soap:Envelope>") && socket.waitForReadyRead()) {
+            response += socket.readAll();
+        }
+        QVERIFY(response.contains("Support for GET requests not implemented yet."));
+        server->flushLogFile();
+
+        const QList<QByteArray> lines = readLines(fileName);
+        QCOMPARE(lines.count(), 2);
+        QVERIFY(lines.at(0).contains(",\"method\":\"getEmployeeCountry\",\"soapAction\":\"http://www.kdab.com/xml/MyWsdl/getEmployeeCountry\",\"requestBytes\":" + QByteArray::number(message.size()) + ","));
+        // Nothing left over from the first request
+        QVERIFY(lines.at(1).contains(",\"method\":\"\",\"soapAction\":\"\",\"requestBytes\":0,"));
+        QVERIFY(lines.at(1).contains(",\"fault\":\"Fault code Client.Data: Support for GET requests not implemented yet.\""));
+        QVERIFY(lines.at(1).contains(",\"parse\":0,\"dispatch\":0,"));
+
+        server->closeLogFile();
+        QFile::remove(fileName);
+    }
+
+    void testLoggingQueueFull()
+    {
+        CountryServerThread serverThread;
+        CountryServer *server = serverThread.startThread();
+
+        const QString fileName = QString::fromLatin1("output_dropped.log");
+        QFile::remove(fileName);
+        server->setLogFileName(fileName);
+        server->setLogLevel(KDSoapServer::LogEveryCall);
+        QCOMPARE(server->droppedLogEntryCount(), 0);
+
+        // Nothing fits in the queue: every line is dropped and counted
+        server->setMaxLogQueueSize(0);
+        QCOMPARE(server->maxLogQueueSize(), 0);
+        makeSimpleCall(server->endPoint());
+        makeFaultyCall(server->endPoint());
+        server->flushLogFile();
+        QCOMPARE(server->droppedLogEntryCount(), 2);
+        QVERIFY(!QFile::exists(fileName) || QFileInfo(fileName).size() == 0);
+
+        server->resetDroppedLogEntryCount();
+        QCOMPARE(server->droppedLogEntryCount(), 0);
+        server->setMaxLogQueueSize(1024 * 1024);
+        makeSimpleCall(server->endPoint());
+        server->flushLogFile();
+        QCOMPARE(server->droppedLogEntryCount(), 0);
+        QList<QByteArray> expected;
+        expected << "CALL getEmployeeCountry";
+        compareLines(expected, fileName);
+
+        server->closeLogFile();
+        QFile::remove(fileName);
+    }
+
+    void testMetrics()
+    {
+        KDSoapThreadPool threadPool;
+        threadPool.setMaxThreadCount(3);
+        CountryServerThread serverThread(&threadPool);
+        CountryServer *server = serverThread.startThread();
+        QCOMPARE(server->metricsPath(), QString());
+        const QString pathInUrl = QString::fromLatin1("/metrics");
+        server->setMetricsPath(pathInUrl);
+        QCOMPARE(server->metricsPath(), pathInUrl);
+
+        makeSimpleCall(server->endPoint());
+        makeSimpleCall(server->endPoint());
+        makeFaultyCall(server->endPoint());
+
+        const QByteArray metrics = server->metrics();
+        QVERIFY(metrics.contains("# TYPE kdsoap_requests_total counter\n"));
+        QVERIFY(metrics.contains("\nkdsoap_requests_total{method=\"getEmployeeCountry\"} 3\n"));
+        QVERIFY(metrics.contains("\nkdsoap_faults_total{method=\"getEmployeeCountry\"} 1\n"));
+        QVERIFY(metrics.contains("# TYPE kdsoap_request_duration_seconds histogram\n"));
+        QVERIFY(metrics.contains("\nkdsoap_request_duration_seconds_bucket{method=\"getEmployeeCountry\",le=\"+Inf\"} 3\n"));
+        QVERIFY(metrics.contains("\nkdsoap_request_duration_seconds_count{method=\"getEmployeeCountry\"} 3\n"));
+        QVERIFY(metrics.contains("\nkdsoap_active_requests 0\n"));
+        QVERIFY(metrics.contains("\nkdsoap_delayed_responses 0\n"));
+        QVERIFY(metrics.contains("\nkdsoap_connections_total 3\n"));
+        QVERIFY(metrics.contains("\nkdsoap_max_threads 3\n"));
+        QVERIFY(!metrics.contains("\nkdsoap_received_bytes_total 0\n"));
+        QVERIFY(!metrics.contains("\nkdsoap_sent_bytes_total 0\n"));
+
+        // Same thing over HTTP
+        QString url = server->endPoint();
+        url.chop(1) /*trailing slash*/;
+        url += pathInUrl;
+        QNetworkAccessManager manager;
+        QNetworkRequest request(url);
+        QNetworkReply *reply = manager.get(request);
+        QEventLoop loop;
+        connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
+        loop.exec();
+
+        QCOMPARE((int)reply->error(), (int)QNetworkReply::NoError);
+        QVERIFY(reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith(QLatin1String("text/plain")));
+        const QByteArray received = reply->readAll();
+        QVERIFY(received.contains("\nkdsoap_requests_total{method=\"getEmployeeCountry\"} 3\n"));
+        delete reply;
+    }
+
+    void testDeleteServerWithLiveConnections()
+    {
+        KDSoapThreadPool threadPool;
+        QScopedPointer<ClientSocket> socket;
+        {
+            CountryServerThread serverThread(&threadPool);
+            CountryServer *server = serverThread.startThread();
+            socket.reset(new ClientSocket(server));
+            QVERIFY(socket->waitForConnected());
+            const QByteArray message = rawCountryMessage();
+            socket->write("POST / HTTP/1.1\r\n"
+                          "SoapAction: http://www.kdab.com/xml/MyWsdl/getEmployeeCountry\r\n"
+                          "Content-Type: text/xml;charset=utf-8\r\n"
+                          "Content-Length: " + QByteArray::number(message.size()) + "\r\n"
+                          "Host: 127.0.0.1:12345\r\n" // ignored
+                          "\r\n" + message);
+            QVERIFY(socket->waitForBytesWritten());
+            verifySocketResponse(*socket, "David Ä Faure");
+        } // the server is deleted, its connection is still handled by the pool thread
+
+        // The server-side socket is now deleted, updating the metrics the server had
+        socket->disconnectFromHost();
+        if (socket->state() != QAbstractSocket::UnconnectedState) {
+            QVERIFY(socket->waitForDisconnected());
+        }
+        QTest::qWait(100);
+    }
+
     void testWsdlFile()
     {
         CountryServerThread serverThread;
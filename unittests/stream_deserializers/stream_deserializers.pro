@@ -0,0 +1,12 @@
+#this is the option given to KDWSDL2CPP when generating cpp from wsdl
+KDWSDL_OPTIONS = -stream-deserializers
+
+include( $${TOP_SOURCE_DIR}/unittests/unittests.pri )
+QT += network xml
+SOURCES = test_stream_deserializers.cpp
+test.target = test
+test.commands = ./$(TARGET)
+test.depends = $(TARGET)
+QMAKE_EXTRA_TARGETS += test
+
+KDWSDL = ../wsdl_document/mywsdl_document.wsdl ../wsdl_document/thomas-bayer.wsdl
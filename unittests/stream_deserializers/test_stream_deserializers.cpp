@@ -0,0 +1,129 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+
+#include "wsdl_mywsdl_document.h"
+#include "wsdl_thomas-bayer.h"
+#include "httpserver_p.h"
+#include <QtTest/QtTest>
+#include <QDebug>
+
+using namespace KDSoapUnitTestHelpers;
+
+// Same calls as in wsdl_document, with the result read by the generated readXml() methods
+class StreamDeserializersTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testEnums()
+    {
+        // Attributes, lists of simple types, and an unknown element which must be skipped
+        QByteArray responseData = QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+                                  "<kdab:getEmployeeTypeResponse xmlns:kdab=\"http://www.kdab.com/xml/MyWsdl/\" kdab:type=\"Developer\" xsi:type=\"kdab:EmployeeType\">"
+                                  "<kdab:unknown><kdab:team>Nested</kdab:team></kdab:unknown>"
+                                  "<kdab:team>Minitel</kdab:team>"
+                                  "<kdab:otherRoles>TeamLeader</kdab:otherRoles>"
+                                  "<kdab:otherRoles>Developer</kdab:otherRoles>"
+                                  "</kdab:getEmployeeTypeResponse>"
+                                  "</soap:Body>" + xmlEnvEnd();
+        HttpServerThread server(responseData, HttpServerThread::Public);
+        MyWsdlDocument service;
+        service.setEndPoint(server.endPoint());
+
+        KDAB__EmployeeNameParams params;
+        params.setEmployeeName(KDAB__EmployeeName(QLatin1String("Joe")));
+        const KDAB__EmployeeType employeeType = service.getEmployeeType(params);
+        QCOMPARE(service.lastError(), QString());
+        QCOMPARE(employeeType.team().count(), 1);
+        QCOMPARE(employeeType.team().first().value().value(), QLatin1String("Minitel"));
+        QCOMPARE(employeeType.otherRoles().count(), 2);
+        QCOMPARE(employeeType.otherRoles().at(0).type(), KDAB__EmployeeTypeEnum::TeamLeader);
+        QCOMPARE(employeeType.otherRoles().at(1).type(), KDAB__EmployeeTypeEnum::Developer);
+        QCOMPARE((int)employeeType.type().type(), (int)KDAB__EmployeeTypeEnum::Developer);
+    }
+
+    void testSequenceInResponse()
+    {
+        QByteArray responseData = QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+                                  "<getCountriesResponse><country>Great Britain</country><country>Ireland</country></getCountriesResponse>"
+                                  " </soap:Body>" + xmlEnvEnd();
+        HttpServerThread server(responseData, HttpServerThread::Public);
+
+        NamesServiceService serv;
+        serv.setEndPoint(server.endPoint());
+        const QStringList countries = serv.getCountries().country();
+        QCOMPARE(countries.count(), 2);
+        QCOMPARE(countries[0], QString::fromLatin1("Great Britain"));
+        QCOMPARE(countries[1], QString::fromLatin1("Ireland"));
+    }
+
+    void testAnyType()
+    {
+        // xsd:anyType elements are still read into KDSoapValues
+        QByteArray responseData = QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+                                  "<kdab:AnyTypeResponse xmlns:kdab=\"http://www.kdab.com/xml/MyWsdl/\">"
+                                  "<xsd:schema><xsd:test>response</xsd:test></xsd:schema>"
+                                  "<kdab:return xsi:type=\"xsd:int\">42</kdab:return>"
+                                  "<kdab:return xsi:type=\"kdab:EmployeeAchievement\">"
+                                  "<kdab:type>Project</kdab:type>"
+                                  "<kdab:label>Management</kdab:label>"
+                                  "</kdab:return>"
+                                  "</kdab:AnyTypeResponse>"
+                                  "</soap:Body>" + xmlEnvEnd();
+        HttpServerThread server(responseData, HttpServerThread::Public);
+        MyWsdlDocument service;
+        service.setEndPoint(server.endPoint());
+
+        const KDAB__AnyTypeResponse response = service.testAnyType(KDAB__AnyType());
+        QCOMPARE(service.lastError(), QString());
+        const QList<KDSoapValue> values = response.return_();
+        QCOMPARE(values.count(), 2);
+        QCOMPARE(values.at(0).value().toInt(), 42);
+        const QList<KDSoapValue> achievements = values.at(1).childValues();
+        QCOMPARE(achievements.count(), 2);
+        QCOMPARE(achievements.at(0).value().toString(), QString::fromLatin1("Project"));
+        QCOMPARE(achievements.at(1).value().toString(), QString::fromLatin1("Management"));
+        QCOMPARE(response.schema().name(), QString::fromLatin1("schema"));
+    }
+
+    void testFault()
+    {
+        QByteArray responseData = QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+                                  "<soap:Fault>"
+                                  "<faultcode>soap:Server</faultcode>"
+                                  "<faultstring>Employee not found</faultstring>"
+                                  "</soap:Fault>"
+                                  "</soap:Body>" + xmlEnvEnd();
+        HttpServerThread server(responseData, HttpServerThread::Public);
+        MyWsdlDocument service;
+        service.setEndPoint(server.endPoint());
+
+        const KDAB__EmployeeType employeeType = service.getEmployeeType(KDAB__EmployeeNameParams());
+        QVERIFY(service.lastError().contains(QLatin1String("Employee not found")));
+        QVERIFY(employeeType.team().isEmpty());
+    }
+};
+
+QTEST_MAIN(StreamDeserializersTest)
+
+#include "test_stream_deserializers.moc"
@@ -0,0 +1,204 @@
+/****************************************************************************
+** Copyright (C) 2010-2017 Klaralvdalens Datakonsult AB, a KDAB Group company, info@kdab.com.
+** All rights reserved.
+**
+** This file is part of the KD Soap library.
+**
+** Licensees holding valid commercial KD Soap licenses may use this file in
+** accordance with the KD Soap Commercial License Agreement provided with
+** the Software.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU Lesser General Public License version 2.1 and version 3 as published by the
+** Free Software Foundation and appearing in the file LICENSE.LGPL.txt included.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** Contact info@kdab.com if any conditions of this licensing are not
+** clear to you.
+**
+**********************************************************************/
+
+#include "wsdl_mywsdl_document.h"
+#include "wsdl_thomas-bayer.h"
+#include "httpserver_p.h"
+#include <KDSoapClient/KDSoapClientInterface.h>
+#include <KDSoapClient/KDSoapElementWriter.h>
+#include <KDSoapClient/KDSoapNamespaceManager.h>
+#include <QtTest/QtTest>
+#include <QDebug>
+
+using namespace KDSoapUnitTestHelpers;
+
+class EmployeeNameWriter : public KDSoapElementWriter
+{
+public:
+    virtual void writeElementContents(QXmlStreamWriter &writer, const QString &messageNamespace) const
+    {
+        writer.writeTextElement(messageNamespace, QString::fromLatin1("employeeName"), QString::fromUtf8("David Ä Faure"));
+    }
+};
+
+// Same calls as in wsdl_document, with the request written by the generated writeXml() methods
+class StreamSerializersTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QByteArray addEmployeeResponse()
+    {
+        return QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+               "<kdab:addEmployeeResponse xmlns:kdab=\"http://www.kdab.com/xml/MyWsdl/\">466F6F</kdab:addEmployeeResponse>"
+               " </soap:Body>" + xmlEnvEnd();
+    }
+
+private Q_SLOTS:
+    void testAddEmployee()
+    {
+        // Attributes, lists, nested complex types and simple types
+        HttpServerThread server(addEmployeeResponse(), HttpServerThread::Public);
+        MyWsdlDocument service;
+        service.setEndPoint(server.endPoint());
+
+        KDAB__LoginElement login;
+        login.setUser(QLatin1String("foo"));
+        login.setPass(QLatin1String("bar"));
+        service.setLoginHeader(login);
+
+        KDAB__EmployeeAchievement achievement;
+        achievement.setType(QByteArray("Project"));
+        achievement.setLabel(QString::fromLatin1("Management"));
+        achievement.setTime(QDate(2011, 06, 27));
+        KDAB__EmployeeAchievements achievements;
+        achievements.setItems(QList<KDAB__EmployeeAchievement>() << achievement);
+        KDAB__EmployeeType employeeType;
+        employeeType.setType(KDAB__EmployeeTypeEnum::Developer);
+        employeeType.setOtherRoles(QList<KDAB__EmployeeTypeEnum>() << KDAB__EmployeeTypeEnum::TeamLeader);
+        employeeType.setTeam(QList<KDAB__TeamName>() << QString::fromLatin1("Minitel"));
+        KDAB__AddEmployee addEmployeeParams;
+        addEmployeeParams.setEmployeeType(employeeType);
+        addEmployeeParams.setEmployeeName(QString::fromUtf8("Hervé"));
+        addEmployeeParams.setEmployeeCountry(QString::fromLatin1("France"));
+        addEmployeeParams.setEmployeeAchievements(achievements);
+        KDAB__EmployeeId id;
+        id.setId(5);
+        addEmployeeParams.setEmployeeId(id);
+
+        const QByteArray ret = service.addEmployee(addEmployeeParams);
+        QCOMPARE(service.lastError(), QString());
+        QCOMPARE(ret, QByteArray("Foo"));
+
+        const QByteArray expectedRequestXml =
+            QByteArray(xmlEnvBegin11()) +
+            " xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+            "<soap:Header>"
+            "<n1:LoginElement>"
+            "<n1:user>foo</n1:user>"
+            "<n1:pass>bar</n1:pass>"
+            "</n1:LoginElement>"
+            "</soap:Header>"
+            "<soap:Body>"
+            "<n1:addEmployee>"
+            "<n1:employeeType n1:type=\"Developer\">"
+            "<n1:otherRoles>TeamLeader</n1:otherRoles>"
+            "<n1:team>Minitel</n1:team>"
+            "</n1:employeeType>"
+            "<n1:employeeName>Hervé</n1:employeeName>"
+            "<n1:employeeCountry>France</n1:employeeCountry>"
+            "<n1:employeeAchievements>"
+            "<n1:item>"
+            "<n1:type>50726f6a656374</n1:type>"
+            "<n1:label>Management</n1:label>"
+            "<n1:time>2011-06-27</n1:time>"
+            "</n1:item>"
+            "</n1:employeeAchievements>"
+            "<n1:employeeId>"
+            "<n1:id>5</n1:id>"
+            "</n1:employeeId>"
+            "</n1:addEmployee>"
+            "</soap:Body>" + xmlEnvEnd()
+            + '\n';
+        QVERIFY(xmlBufferCompare(server.receivedData(), expectedRequestXml));
+        QCOMPARE(QString::fromUtf8(server.receivedData().constData()), QString::fromUtf8(expectedRequestXml.constData()));
+    }
+
+    void testEmptyRequest()
+    {
+        QByteArray responseData = QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+                                  "<getCountriesResponse><country>Ireland</country></getCountriesResponse>"
+                                  " </soap:Body>" + xmlEnvEnd();
+        HttpServerThread server(responseData, HttpServerThread::Public);
+
+        NamesServiceService serv;
+        serv.setEndPoint(server.endPoint());
+        QCOMPARE(serv.getCountries().country(), QStringList() << QString::fromLatin1("Ireland"));
+
+        const QByteArray expectedRequestXml =
+            QByteArray(xmlEnvBegin11()) + ">"
+            "<soap:Body>"
+            "<n1:getCountries xmlns:n1=\"http://namesservice.thomas_bayer.com/\"/>"
+            "</soap:Body>" + xmlEnvEnd();
+        QVERIFY(xmlBufferCompare(server.receivedData(), expectedRequestXml));
+    }
+
+    void testAnyType()
+    {
+        // xsd:any members go through a KDSoapValue
+        QByteArray responseData = QByteArray(xmlEnvBegin11()) + "><soap:Body>"
+                                  "<kdab:AnyTypeResponse xmlns:kdab=\"http://www.kdab.com/xml/MyWsdl/\"/>"
+                                  "</soap:Body>" + xmlEnvEnd();
+        HttpServerThread server(responseData, HttpServerThread::Public);
+        MyWsdlDocument service;
+        service.setEndPoint(server.endPoint());
+
+        KDAB__AnyType anyType;
+        anyType.setInput(KDSoapValue(QString::fromLatin1("foo"), QString::fromLatin1("Value"), KDSoapNamespaceManager::xmlSchema2001(), QString::fromLatin1("string")));
+        KDSoapValueList schemaChildValues;
+        KDSoapValue testVal(QLatin1String("test"), QString::fromLatin1("input"));
+        testVal.setNamespaceUri(KDSoapNamespaceManager::xmlSchema2001());
+        schemaChildValues.append(testVal);
+        KDSoapValue inputSchema(QLatin1String("schema"), schemaChildValues);
+        inputSchema.setNamespaceUri(KDSoapNamespaceManager::xmlSchema2001());
+        anyType.setSchema(inputSchema);
+        service.testAnyType(anyType);
+        QCOMPARE(service.lastError(), QString());
+
+        const QByteArray expectedRequestXml =
+            QByteArray(xmlEnvBegin11()) + ">"
+            "<soap:Body>"
+            "<n1:AnyType xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+            "<xsd:schema><xsd:test>input</xsd:test></xsd:schema>"
+            "<foo>Value</foo>"
+            "</n1:AnyType>"
+            "</soap:Body>" + xmlEnvEnd();
+        QVERIFY(xmlBufferCompare(server.receivedData(), expectedRequestXml));
+    }
+
+    void testElementWriterWithEncodedUse()
+    {
+        // The generated code only uses element writers for literal messages,
+        // but an encoded message with one mustn't be sent with an empty body
+        HttpServerThread server(addEmployeeResponse(), HttpServerThread::Public);
+        KDSoapClientInterface client(server.endPoint(), QString::fromLatin1("http://www.kdab.com/xml/MyWsdl/"));
+        KDSoapMessage message;
+        message.setUse(KDSoapMessage::EncodedUse);
+        message.setElementWriter(new EmployeeNameWriter);
+        QTest::ignoreMessage(QtWarningMsg, "ERROR: Message getEmployeeCountry has an element writer, which only supports LiteralUse: no xsi:type attributes will be written");
+        client.call(QString::fromLatin1("getEmployeeCountry"), message);
+
+        const QByteArray expectedRequestXml =
+            QByteArray(xmlEnvBegin11()) + ">"
+            "<soap:Body>"
+            "<n1:getEmployeeCountry xmlns:n1=\"http://www.kdab.com/xml/MyWsdl/\">"
+            "<n1:employeeName>David Ä Faure</n1:employeeName>"
+            "</n1:getEmployeeCountry>"
+            "</soap:Body>" + xmlEnvEnd();
+        QVERIFY(xmlBufferCompare(server.receivedData(), expectedRequestXml));
+    }
+};
+
+QTEST_MAIN(StreamSerializersTest)
+
+#include "test_stream_serializers.moc"
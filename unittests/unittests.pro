@@ -40,7 +40,10 @@ SUBDIRS = \
   date_example \
   dv_terminalauth \
   test_calc \
-  ws_addressing_support
+  ws_addressing_support \
+  stream_deserializers \
+  stream_serializers \
+  kdwsdl2cpp_options
 
 # These need internet access
 SUBDIRS += webcalls webcalls_wsdl
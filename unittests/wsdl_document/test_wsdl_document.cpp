@@ -34,6 +34,7 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <utility>
 #ifndef QT_NO_OPENSSL
 #include <KDSoapSslHandler.h>
 #include <QSslSocket>
@@ -420,6 +421,47 @@ private Q_SLOTS:
         QCOMPARE(QString::fromUtf8(server.receivedData().constData()), QString::fromUtf8(expectedCountryRequest().constData()));
     }
 
+    // Generated rvalue setters, takeFoo() and move operations
+    void testMoveAndTake()
+    {
+        KDAB__EmployeeAchievements achievements = addEmployeeParameters().employeeAchievements();
+        QList<KDAB__EmployeeAchievement> items = achievements.takeItems();
+        QCOMPARE(items.count(), 2);
+        QVERIFY(achievements.items().isEmpty());
+        QCOMPARE(items.at(1).label(), QString::fromLatin1("C++"));
+
+        KDAB__EmployeeType employeeType;
+        employeeType.setTeam(QList<KDAB__TeamName>() << QString::fromLatin1("Minitel"));
+        QCOMPARE(employeeType.team().count(), 1);
+        const KDAB__EmployeeType copy = employeeType;
+        QCOMPARE(employeeType.takeTeam().count(), 1);
+        QVERIFY(employeeType.team().isEmpty());
+        QCOMPARE(copy.team().count(), 1); // not affected by takeTeam()
+
+#ifdef Q_COMPILER_RVALUE_REFS
+        achievements.setItems(std::move(items));
+        QCOMPARE(achievements.items().count(), 2);
+        KDAB__EmployeeAchievements moved(std::move(achievements));
+        QCOMPARE(moved.items().count(), 2);
+        // The moved-from object is still usable, like a default-constructed one
+        QVERIFY(achievements.items().isEmpty());
+        achievements.setItems(QList<KDAB__EmployeeAchievement>() << KDAB__EmployeeAchievement());
+        QCOMPARE(achievements.items().count(), 1);
+        // The moved-from objects share their empty value, modifying one doesn't change the others
+        KDAB__EmployeeAchievements other(achievements);
+        KDAB__EmployeeAchievements movedOther(std::move(other));
+        QCOMPARE(movedOther.items().count(), 1);
+        QVERIFY(other.items().isEmpty());
+        achievements = std::move(moved);
+        QCOMPARE(achievements.items().count(), 2);
+        QCOMPARE(achievements.items().at(0).label(), QString::fromLatin1("Management"));
+        // The one moved from by an assignment gets the previous value
+        QCOMPARE(moved.items().count(), 1);
+        moved = achievements;
+        QCOMPARE(moved.items().count(), 2);
+#endif
+    }
+
     void testEmptyResponse()
     {
         HttpServerThread server(emptyResponse(), HttpServerThread::Public);
@@ -636,6 +678,7 @@ private Q_SLOTS:
     void testSendHugeTelegram();
     void testServerDelayedCall();
     void testSyncCallAfterServerDelayedCall();
+    void testServerDelayedCallTimeout();
     void testServerTwoDelayedCalls();
     void testDisconnectDuringDelayedCall();
     void testServerDifferentPath();
@@ -1132,6 +1175,39 @@ void WsdlDocumentTest::testSyncCallAfterServerDelayedCall()
     QCOMPARE(QString::fromLatin1(ret2.constData()), QString::fromLatin1("added David Faure"));
 }
 
+void WsdlDocumentTest::testServerDelayedCallTimeout()
+{
+    TestServerThread<DocServer> serverThread;
+    DocServer *server = serverThread.startThread();
+    QCOMPARE(server->delayedResponseTimeout(), 0);
+    server->setDelayedResponseTimeout(50); // MyJob takes 200ms
+    QCOMPARE(server->delayedResponseTimeout(), 50);
+    MyWsdlDocument service;
+    service.setEndPoint(server->endPoint());
+
+    const QByteArray ret = service.delayedAddEmployee(addEmployeeParameters());
+    QVERIFY(service.lastError().contains(QLatin1String("Server.Timeout")));
+    QVERIFY(ret.isEmpty());
+    QCOMPARE(server->delayedResponseTimeoutCount(), 1);
+
+    // The late response is ignored
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QTRY_COMPARE(server->lastServerObject()->m_lastMethodCalled, QString::fromLatin1("slotDelayedResponse"));
+#else
+    do {
+        QTest::qWait(100);
+    } while (server->lastServerObject()->m_lastMethodCalled != QLatin1String("slotDelayedResponse"));
+#endif
+
+    // and the connection can be used for the next call
+    const QByteArray ret2 = service.addEmployee(addEmployeeParameters());
+    QCOMPARE(service.lastError(), QString());
+    QCOMPARE(QString::fromLatin1(ret2.constData()), QString::fromLatin1("added David Faure"));
+
+    server->resetDelayedResponseTimeoutCount();
+    QCOMPARE(server->delayedResponseTimeoutCount(), 0);
+}
+
 void WsdlDocumentTest::testServerTwoDelayedCalls()
 {
     TestServerThread<DocServer> serverThread;